@@ -0,0 +1,72 @@
+﻿// Copyright © Dream Moon Studio . Dream Moon All rights reserved
+
+#include "AsyncAction/DreamAsyncAction_ParseLyricBatch.h"
+
+#include "Async/Async.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+
+UDreamAsyncAction_ParseLyricBatch* UDreamAsyncAction_ParseLyricBatch::ParseLyricBatch(UObject* WorldContextObject, const TArray<FDreamLyricBatchRequest>& Requests, bool bValidate)
+{
+	UDreamAsyncAction_ParseLyricBatch* Action = NewObject<UDreamAsyncAction_ParseLyricBatch>();
+	Action->PendingRequests = Requests;
+	Action->bValidateResults = bValidate;
+	Action->CancelFlag = MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+
+	// 后台解析期间只持有弱引用, 必须有对象持有 Action, 否则 GC 后 OnCompleted 不会触发
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	if (World && World->GetGameInstance())
+	{
+		Action->RegisterWithGameInstance(World->GetGameInstance());
+	}
+	else
+	{
+		Action->AddToRoot();
+		Action->bRooted = true;
+	}
+
+	return Action;
+}
+
+void UDreamAsyncAction_ParseLyricBatch::Activate()
+{
+	TWeakObjectPtr<UDreamAsyncAction_ParseLyricBatch> WeakThis(this);
+
+	// 请求列表移入后台任务, 结果在游戏线程广播
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, Requests = MoveTemp(PendingRequests), bValidate = bValidateResults, Flag = CancelFlag]()
+	{
+		TArray<FDreamLyricBatchResult> Results;
+		FDreamLyricBatchStats Stats;
+		FDreamLyricBatchParser::Parse(Requests, Results, Stats, bValidate, Flag.Get());
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Results = MoveTemp(Results), Stats, Flag]()
+		{
+			UDreamAsyncAction_ParseLyricBatch* This = WeakThis.Get();
+			if (!This || Flag->load())
+			{
+				return;
+			}
+
+			This->OnCompleted.Broadcast(Results, Stats);
+			This->SetReadyToDestroy();
+		});
+	});
+}
+
+void UDreamAsyncAction_ParseLyricBatch::Cancel()
+{
+	CancelFlag->store(true);
+	Super::Cancel();
+}
+
+void UDreamAsyncAction_ParseLyricBatch::SetReadyToDestroy()
+{
+	if (bRooted)
+	{
+		RemoveFromRoot();
+		bRooted = false;
+	}
+
+	Super::SetReadyToDestroy();
+}
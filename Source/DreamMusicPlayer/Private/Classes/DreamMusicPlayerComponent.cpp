@@ -296,7 +296,8 @@ void UDreamMusicPlayerComponent::StartMusic()
 	LastSeekPosition = 0.0f;
 	MusicStartWorldTime = FPlatformTime::Seconds(); // 记录开始时间
 	bJustSeeked = false;
-	CurrentTimestamp = FDreamMusicLyricTimestamp();
+	CurrentTime = FDreamLyricTime();
+	CurrentMusicEndTime = FDreamLyricTime();
 
 	// Validate SoundWave before playing
 	if (!SoundWave || !SoundWave->IsValidLowLevel())
@@ -307,6 +308,7 @@ void UDreamMusicPlayerComponent::StartMusic()
 
 	// Play Music with improved setup
 	CurrentMusicDuration = SoundWave->Duration;
+	CurrentMusicEndTime = FDreamLyricTime::FromSeconds(CurrentMusicDuration);
 
 	AudioManager->Music_Start();
 	for (UDreamMusicPlayerExpansion* Expansion : ExpansionList)
@@ -354,6 +356,7 @@ void UDreamMusicPlayerComponent::EndMusic(bool Native)
 	// Clean up state
 	CurrentDuration = 0.0f;
 	CurrentMusicDuration = 0.0f;
+	CurrentMusicEndTime = FDreamLyricTime();
 	CurrentMusicPercent = 0.0f;
 
 	OnMusicEnd.Broadcast();
@@ -477,7 +480,7 @@ void UDreamMusicPlayerComponent::SetMusicPercent(float InPercent)
 
 	// 应用歌词偏移
 	float LyricTime = CurrentDuration;
-	CurrentTimestamp = *FDreamMusicLyricTimestamp().FromSeconds(LyricTime);
+	CurrentTime = FDreamLyricTime::FromSeconds(LyricTime);
 
 	// 停止并重新开始播放
 	if (AudioManager->IsPlaying())
@@ -517,18 +520,18 @@ void UDreamMusicPlayerComponent::MusicTick(float DeltaTime)
 	// 更新时间状态
 	CurrentDuration = AccuratePlayTime;
 	CurrentMusicPercent = FMath::Clamp(CurrentDuration / CurrentMusicDuration, 0.0f, 1.0f);
-	CurrentTimestamp = *FDreamMusicLyricTimestamp().FromSeconds(CurrentDuration);
+	CurrentTime = FDreamLyricTime::FromSeconds(CurrentDuration);
 
 	// Auto Next
-	if (CurrentTimestamp >= CurrentMusicDuration)
+	if (CurrentTime >= CurrentMusicEndTime)
 	{
 		EndMusic();
 	}
 
-	AudioManager->Tick(CurrentTimestamp, DeltaTime);
+	AudioManager->Tick(CurrentTime, DeltaTime);
 	for (UDreamMusicPlayerExpansion* Expansion : ExpansionList)
 	{
-		Expansion->Tick(CurrentTimestamp, DeltaTime);
+		Expansion->Tick(CurrentTime, DeltaTime);
 	}
 
 	OnMusicTick.Broadcast(CurrentDuration);
@@ -22,13 +22,19 @@ void UDreamMusicPlayerExpansion::BP_Initialize_Implementation(UDreamMusicPlayerC
 void UDreamMusicPlayerExpansion::Initialize(UDreamMusicPlayerComponent* InComponent)
 {
 	MusicPlayerComponent = InComponent;
+	bBlueprintTick = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UDreamMusicPlayerExpansion, BP_Tick));
 	BP_Initialize(InComponent);
 }
 
-void UDreamMusicPlayerExpansion::Tick(const FDreamMusicLyricTimestamp& InTimestamp, float InDeltaTime)
+void UDreamMusicPlayerExpansion::Tick(FDreamLyricTime InTime, float InDeltaTime)
 {
-	CurrentTimestamp = InTimestamp;
-	BP_Tick(InTimestamp, InDeltaTime);
+	CurrentTime = InTime;
+
+	// 蓝图时间戳只为蓝图实现的 On Tick 构建
+	if (bBlueprintTick)
+	{
+		BP_Tick(FDreamMusicLyricTimestamp(InTime), InDeltaTime);
+	}
 }
 
 void UDreamMusicPlayerExpansion::ChangeMusic(const FDreamMusicDataStruct& InData)
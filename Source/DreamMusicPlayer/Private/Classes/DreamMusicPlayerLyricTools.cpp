@@ -5,25 +5,26 @@
 
 FDreamMusicLyric FDreamMusicPlayerLyricTools::GetLyricAtTimestamp(FDreamMusicLyricTimestamp Timestamp, const TArray<FDreamMusicLyric>& Lyrics)
 {
-	if (Lyrics.Num() == 0)
-	{
-		return FDreamMusicLyric::EMPTY();
-	}
+	const int32 Index = GetLyricIndexAtTime(Timestamp.ToTime(), Lyrics);
+	return Lyrics.IsValidIndex(Index) ? Lyrics[Index] : FDreamMusicLyric::EMPTY();
+}
 
+int32 FDreamMusicPlayerLyricTools::GetLyricIndexAtTime(FDreamLyricTime Time, const TArray<FDreamMusicLyric>& Lyrics)
+{
 	int Low = 0;
 	int High = Lyrics.Num() - 1;
-	int ResultIndex = -1;
+	int ResultIndex = INDEX_NONE;
 
 	while (Low <= High)
 	{
 		int Mid = (Low + High) / 2;
-		const FDreamMusicLyric& Lyric = Lyrics[Mid];
+		const FDreamLyricTime StartTime = Lyrics[Mid].StartTimestamp.ToTime();
 
-		if (Lyric.StartTimestamp == Timestamp)
+		if (StartTime == Time)
 		{
-			return Lyric; // 精确匹配时间戳，返回对应的歌词
+			return Mid; // 精确匹配时间戳，返回对应的歌词
 		}
-		else if (Lyric.StartTimestamp < Timestamp)
+		else if (StartTime < Time)
 		{
 			ResultIndex = Mid; // 记录小于目标时间戳的最大时间戳位置
 			Low = Mid + 1; // 时间戳小于目标时间戳，搜索后半部分
@@ -35,12 +36,7 @@ FDreamMusicLyric FDreamMusicPlayerLyricTools::GetLyricAtTimestamp(FDreamMusicLyr
 	}
 
 	// 返回小于等于目标时间戳的最大时间戳对应的歌词
-	if (ResultIndex >= 0)
-	{
-		return Lyrics[ResultIndex];
-	}
-
-	return FDreamMusicLyric::EMPTY();
+	return ResultIndex;
 }
 
 FString FDreamMusicPlayerLyricTools::GetLyricFilePath(FString FileName)
@@ -20,7 +20,7 @@ float UDreamMusicPlayerBlueprint::ConvLyricTimestampToFloat(FDreamMusicLyricTime
 
 FDreamMusicLyricTimestamp UDreamMusicPlayerBlueprint::ConvFloatToLyricTimestamp(float InFloat)
 {
-	return *FDreamMusicLyricTimestamp().FromSeconds(InFloat);
+	return FDreamMusicLyricTimestamp(FDreamLyricTime::FromSeconds(InFloat));
 }
 
 bool UDreamMusicPlayerBlueprint::GetExpansionDataByClass(const FDreamMusicDataStruct& InMusicData, TSubclassOf<UDreamMusicPlayerExpansionData> InExpansionDataClass, UDreamMusicPlayerExpansionData*& OutExpansionData)
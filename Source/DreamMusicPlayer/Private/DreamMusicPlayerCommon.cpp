@@ -1,6 +1,7 @@
 #include "DreamMusicPlayerCommon.h"
 
 #include "Classes/DreamMusicPlayerExpansionData.h"
+#include "LyricParser/DreamLyricTimestampScanner.h"
 
 FDreamMusicLyricTimestamp::FDreamMusicLyricTimestamp(float InSeconds)
 {
@@ -34,34 +35,24 @@ bool FDreamMusicLyricTimestamp::operator<(const FDreamMusicLyricTimestamp& Targe
 
 bool FDreamMusicLyricTimestamp::IsApproximatelyEqual(const FDreamMusicLyricTimestamp& Target, int ToleranceMilliseconds) const
 {
-	int Diff = ToMilliseconds() - Target.ToMilliseconds();
-	return FMath::Abs(Diff) <= ToleranceMilliseconds;
+	return ToTime().IsApproximatelyEqual(Target.ToTime(), ToleranceMilliseconds);
 }
 
 const FDreamMusicLyricTimestamp* FDreamMusicLyricTimestamp::FromSeconds(float InSeconds)
 {
-	Seconds = FMath::FloorToInt(InSeconds);
-	Millisecond = FMath::RoundToInt((InSeconds - Seconds) * 1000);
-	Hours = Seconds / 3600;
-	Seconds %= 3600;
-	Minute = Seconds / 60;
-	Seconds = Seconds % 60;
+	*this = FDreamMusicLyricTimestamp(FDreamLyricTime::FromSeconds(InSeconds));
 	return this;
 }
 
-int FDreamMusicLyricTimestamp::ToMilliseconds() const
+FDreamMusicLyricTimestamp FDreamMusicLyricTimestamp::Parse(FStringView TimestampStr)
 {
-	return Hours * 3600000 + Minute * 60000 + Seconds * 1000 + Millisecond;
-}
-
-float FDreamMusicLyricTimestamp::ToSeconds() const
-{
-	float TotalSeconds = Hours * 3600.0f;
-	TotalSeconds += Minute * 60.0f;
-	TotalSeconds += Seconds;
-	TotalSeconds += Millisecond / 1000.0f;
+	FDreamLyricTime Time;
+	if (!FDreamLyricTimestampScanner::FindClock(TimestampStr, Time))
+	{
+		return FDreamMusicLyricTimestamp();
+	}
 
-	return TotalSeconds;
+	return FDreamMusicLyricTimestamp(Time);
 }
 
 bool FDreamMusicLyric::operator==(const FDreamMusicLyric& Target) const
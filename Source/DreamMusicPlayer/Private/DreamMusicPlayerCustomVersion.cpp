@@ -0,0 +1,7 @@
+﻿#include "DreamMusicPlayerCustomVersion.h"
+
+#include "Serialization/CustomVersion.h"
+
+const FGuid FDreamMusicPlayerCustomVersion::GUID(0x04877223, 0x5FEA4316, 0x92D84A57, 0xB2D859CA);
+
+static FCustomVersionRegistration GRegisterDreamMusicPlayerCustomVersion(FDreamMusicPlayerCustomVersion::GUID, FDreamMusicPlayerCustomVersion::LatestVersion, TEXT("DreamMusicPlayerVer"));
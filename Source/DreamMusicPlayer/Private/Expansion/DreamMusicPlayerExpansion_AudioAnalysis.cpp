@@ -97,9 +97,10 @@ void UDreamMusicPlayerExpansion_AudioAnalysis::BP_ChangeMusic_Implementation(con
 	LoadAudioNrt();
 }
 
-void UDreamMusicPlayerExpansion_AudioAnalysis::BP_Tick_Implementation(const FDreamMusicLyricTimestamp& InTimestamp, float InDeltaTime)
+void UDreamMusicPlayerExpansion_AudioAnalysis::Tick(FDreamLyricTime InTime, float InDeltaTime)
 {
 	UpdateAudioAnalysisData();
+	Super::Tick(InTime, InDeltaTime);
 }
 
 void UDreamMusicPlayerExpansion_AudioAnalysis::BP_MusicStart_Implementation()
@@ -22,7 +22,7 @@ void UDreamMusicPlayerExpansion_Event::Initialize(UDreamMusicPlayerComponent* In
 
 	if (InComponent->HasExpansion(UDreamMusicPlayerExpansion_Lyric::StaticClass()))
 	{
-		InComponent->GetExpansion<UDreamMusicPlayerExpansion_Lyric>()->OnLyricChangedNative.AddUObject(
+		InComponent->GetExpansion<UDreamMusicPlayerExpansion_Lyric>()->OnLyricIndexChangedNative.AddUObject(
 			this, &UDreamMusicPlayerExpansion_Event::OnLyricChangedHandle);
 	}
 	else
@@ -33,6 +33,8 @@ void UDreamMusicPlayerExpansion_Event::Initialize(UDreamMusicPlayerComponent* In
 
 void UDreamMusicPlayerExpansion_Event::BP_MusicStart_Implementation()
 {
+	BuildTimeEventCache();
+
 	if (CurrentMusicData.HasExpansionData(UDreamMusicPlayerExpansionData_Event::StaticClass()))
 	{
 		for (const FDreamMusicPlayerExpansionData_BaseEvent& Define : CurrentMusicData.GetExpansionData<UDreamMusicPlayerExpansionData_Event>()->MusicStartEventDefines)
@@ -61,30 +63,85 @@ void UDreamMusicPlayerExpansion_Event::BP_MusicEnd_Implementation()
 
 void UDreamMusicPlayerExpansion_Event::BP_MusicSetPercent_Implementation(float InPercent)
 {
-	IgnoreTimestamp.Empty();
+	FiredTimeEvents.Init(false, TimeEventTimes.Num());
+	UpdateNextTimeEvent(FDreamLyricTime());
 }
 
-void UDreamMusicPlayerExpansion_Event::BP_Tick_Implementation(const FDreamMusicLyricTimestamp& InTimestamp, float InDeltaTime)
+void UDreamMusicPlayerExpansion_Event::Tick(FDreamLyricTime InTime, float InDeltaTime)
 {
-	if (CurrentMusicData.HasExpansionData(UDreamMusicPlayerExpansionData_Event::StaticClass()))
+	Super::Tick(InTime, InDeltaTime);
+	FireTimeEvents();
+}
+
+void UDreamMusicPlayerExpansion_Event::FireTimeEvents()
+{
+	// 下一个事件的触发窗口之前无事可做
+	if (CurrentTime < NextTimeEventTime)
 	{
-		for (const FDreamMusicPlayerExpansionData_Event_TimeEventDefine& Define : CurrentMusicData.GetExpansionData<UDreamMusicPlayerExpansionData_Event>()->TimeEventDefines)
+		return;
+	}
+
+	for (int32 Index = 0; Index < TimeEventTimes.Num(); Index++)
+	{
+		if (!FiredTimeEvents[Index] && TimeEventTimes[Index].IsApproximatelyEqual(CurrentTime, TimeEventToleranceMilliseconds))
 		{
-			if (!IgnoreTimestamp.Contains(Define.Time) && Define.Time.IsApproximatelyEqual(InTimestamp, TimeEventToleranceMilliseconds))
+			const UDreamMusicPlayerExpansionData_Event* EventData = CurrentMusicData.GetExpansionData<UDreamMusicPlayerExpansionData_Event>();
+			if (!EventData || !EventData->TimeEventDefines.IsValidIndex(Index))
 			{
-				Define.Event.Call([this](const FDreamMusicPlayerExpansionData_BaseEvent_SingleEventDefine& Event)
-				{
-					EventDefineObject->CallEvent(Event, MusicPlayerComponent->GetExpansion<UDreamMusicPlayerExpansion_Lyric>()->CurrentLyric);
-				});
-
-				IgnoreTimestamp.Add(Define.Time);
 				return;
 			}
+
+			EventData->TimeEventDefines[Index].Event.Call([this](const FDreamMusicPlayerExpansionData_BaseEvent_SingleEventDefine& Event)
+			{
+				EventDefineObject->CallEvent(Event, MusicPlayerComponent->GetExpansion<UDreamMusicPlayerExpansion_Lyric>()->CurrentLyric);
+			});
+
+			FiredTimeEvents[Index] = true;
+			UpdateNextTimeEvent(CurrentTime);
+			return;
 		}
 	}
+
+	// 没有事件触发时, 排除已经错过的事件重新计算
+	UpdateNextTimeEvent(CurrentTime);
+}
+
+void UDreamMusicPlayerExpansion_Event::UpdateNextTimeEvent(FDreamLyricTime InTime)
+{
+	NextTimeEventTime = FDreamLyricTime(MAX_int32);
+
+	for (int32 Index = 0; Index < TimeEventTimes.Num(); Index++)
+	{
+		const FDreamLyricTime EventTime = TimeEventTimes[Index];
+		if (!FiredTimeEvents[Index] && EventTime + TimeEventToleranceMilliseconds >= InTime)
+		{
+			const FDreamLyricTime WindowBegin(EventTime.Milliseconds - TimeEventToleranceMilliseconds);
+			if (WindowBegin < NextTimeEventTime)
+			{
+				NextTimeEventTime = WindowBegin;
+			}
+		}
+	}
+}
+
+void UDreamMusicPlayerExpansion_Event::BuildTimeEventCache()
+{
+	TimeEventTimes.Reset();
+
+	if (const UDreamMusicPlayerExpansionData_Event* EventData = CurrentMusicData.GetExpansionData<UDreamMusicPlayerExpansionData_Event>())
+	{
+		TimeEventTimes.Reserve(EventData->TimeEventDefines.Num());
+		for (const FDreamMusicPlayerExpansionData_Event_TimeEventDefine& Define : EventData->TimeEventDefines)
+		{
+			TimeEventTimes.Add(Define.Time.ToTime());
+		}
+	}
+
+	FiredTimeEvents.Init(false, TimeEventTimes.Num());
+	UpdateNextTimeEvent(FDreamLyricTime());
 }
 
-void UDreamMusicPlayerExpansion_Event::OnLyricChangedHandle(FDreamMusicLyric Lyric, int Index)
+void UDreamMusicPlayerExpansion_Event::OnLyricChangedHandle(int32 Index)
 {
 	if (CurrentMusicData.HasExpansionData(UDreamMusicPlayerExpansionData_Event::StaticClass()))
 	{
@@ -93,7 +150,9 @@ void UDreamMusicPlayerExpansion_Event::OnLyricChangedHandle(FDreamMusicLyric Lyr
 		{
 			if (Define == Index)
 			{
-				Define.Event.Call([this, Lyric](const FDreamMusicPlayerExpansionData_BaseEvent_SingleEventDefine& Event)
+				// 只有命中的事件需要歌词内容, 直接读取歌词扩展的当前行
+				const FDreamMusicLyric& Lyric = MusicPlayerComponent->GetExpansion<UDreamMusicPlayerExpansion_Lyric>()->CurrentLyric;
+				Define.Event.Call([this, &Lyric](const FDreamMusicPlayerExpansionData_BaseEvent_SingleEventDefine& Event)
 				{
 					EventDefineObject->CallEvent(Event, Lyric);
 				});
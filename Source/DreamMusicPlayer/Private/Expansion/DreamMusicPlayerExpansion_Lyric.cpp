@@ -7,11 +7,83 @@
 #include "Classes/DreamMusicPlayerComponent.h"
 #include "ExpansionData/DreamMusicPlayerExpansionData_Lyric.h"
 #include "LyricParser/DreamLyricParser.h"
+#include "LyricParser/DreamLyricStreamParser.h"
+#include "LyricParser/DreamLyricTrack.h"
+#include "LyricParser/DreamLyricTrackCache.h"
 #include "LyricParser/DreamMusicPlayerLyricTools.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Async/Async.h"
+#include "Async/Future.h"
+#include "Algo/BinarySearch.h"
+#include "Misc/ScopeLock.h"
 
 using namespace FDreamMusicPlayerLyricTools;
 
+namespace
+{
+	/** 正在后台预取的轨道, 切到预取中的歌曲时等待预取结果, 不再解析第二次 */
+	struct FLyricPrefetchesInFlight
+	{
+		FCriticalSection Lock;
+		TMap<FDreamLyricTrackCacheKey, TSharedFuture<TSharedPtr<const FDreamLyricTrack>>> Futures;
+
+		static FLyricPrefetchesInFlight& Get()
+		{
+			static FLyricPrefetchesInFlight Instance;
+			return Instance;
+		}
+
+		TOptional<TSharedFuture<TSharedPtr<const FDreamLyricTrack>>> Find(const FDreamLyricTrackCacheKey& Key)
+		{
+			FScopeLock ScopeLock(&Lock);
+			const TSharedFuture<TSharedPtr<const FDreamLyricTrack>>* Future = Futures.Find(Key);
+			return Future ? TOptional<TSharedFuture<TSharedPtr<const FDreamLyricTrack>>>(*Future) : NullOpt;
+		}
+	};
+
+	/** 解析歌词文件, 文件有效 (bCacheable) 时结果加入进程内轨道缓存 */
+	TSharedPtr<const FDreamLyricTrack> ParseLyricTrack(const FDreamLyricTrackCacheKey& Key, bool bCacheable)
+	{
+		if (bCacheable)
+		{
+			if (TOptional<TSharedFuture<TSharedPtr<const FDreamLyricTrack>>> Prefetch = FLyricPrefetchesInFlight::Get().Find(Key))
+			{
+				return Prefetch->Get();
+			}
+
+			// 预取先加入缓存再移出进行中列表, 不在列表中时结果要么在缓存中, 要么从未预取
+			if (TSharedPtr<const FDreamLyricTrack> CachedTrack = FDreamLyricTrackCache::Get().Find(Key))
+			{
+				return CachedTrack;
+			}
+		}
+
+		FDreamLyricParser Parser(Key.FilePath, Key.FileType, Key.LineType, Key.LrcLyricType);
+		return bCacheable ? FDreamLyricTrackCache::Get().Add(Key, Parser.GetTrack()) : Parser.GetTrack();
+	}
+
+	/** 在当前 (后台) 线程预取并加入轨道缓存, 同一键已在预取时直接返回 */
+	void PrefetchLyricTrack(const FDreamLyricTrackCacheKey& Key)
+	{
+		FLyricPrefetchesInFlight& InFlight = FLyricPrefetchesInFlight::Get();
+		TPromise<TSharedPtr<const FDreamLyricTrack>> Promise;
+		{
+			FScopeLock ScopeLock(&InFlight.Lock);
+			if (InFlight.Futures.Contains(Key) || FDreamLyricTrackCache::Get().Find(Key).IsValid())
+			{
+				return;
+			}
+			InFlight.Futures.Add(Key, Promise.GetFuture().Share());
+		}
+
+		FDreamLyricParser Parser(Key.FilePath, Key.FileType, Key.LineType, Key.LrcLyricType);
+		Promise.SetValue(FDreamLyricTrackCache::Get().Add(Key, Parser.GetTrack()));
+
+		FScopeLock ScopeLock(&InFlight.Lock);
+		InFlight.Futures.Remove(Key);
+	}
+}
+
 void UDreamMusicPlayerExpansion_Lyric::InitializeLyricList()
 {
 	if (!CurrentMusicData.IsValid())
@@ -21,23 +93,272 @@ void UDreamMusicPlayerExpansion_Lyric::InitializeLyricList()
 	}
 	DMP_LOG_DEBUG_EXPANSION(Log, TEXT("InitializeLyricList - Begin"));
 	CurrentMusicLyricList.Empty();
+	CurrentLyricTrack.Reset();
+	CurrentLyricIndex = INDEX_NONE;
+	LyricLineCursor = INDEX_NONE;
+	CurrentLyricWordIndex = INDEX_NONE;
+	InvalidateLyricBoundary();
+	CurrentLyric = FDreamMusicLyric();
+	CurrentLyricStartTime = FDreamLyricTime();
+	CurrentLyricEndTime = FDreamLyricTime();
+	ClearLyricProgressCache();
+
+	// 使之前仍在后台解析的结果失效
+	const uint32 LoadSerial = ++LyricLoadSerial;
+	bLyricLoadPending = false;
+	if (LyricStreamCancelFlag.IsValid())
+	{
+		LyricStreamCancelFlag->store(true);
+		LyricStreamCancelFlag.Reset();
+	}
 
 	UDreamMusicPlayerExpansionData_Lyric* ExpansionData = CurrentMusicData.GetExpansionData<UDreamMusicPlayerExpansionData_Lyric>();
 
-	FDreamLyricParser Parser(GetLyricFilePath(ExpansionData->LyricFileName),
-	                         ExpansionData->LyricParseFileType,
-	                         ExpansionData->LyricParseLineType,
-	                         ExpansionData->LrcLyricType);
+	// Cook 后的资产直接使用烘焙的歌词轨道, 不再访问文件系统
+	if (TSharedPtr<const FDreamLyricTrack> BakedTrack = ExpansionData->GetBakedTrack())
+	{
+		ApplyLyricTrack(MoveTemp(BakedTrack));
+		return;
+	}
+
+	FDreamLyricTrackCacheKey CacheKey;
+	const bool bCacheable = FDreamLyricTrackCache::MakeKey(GetLyricFilePath(ExpansionData->LyricFileName), ExpansionData->LyricParseFileType,
+	                                                       ExpansionData->LyricParseLineType, ExpansionData->LrcLyricType, CacheKey);
+
+	// 循环重播、上一首以及多个播放器播放同一首歌时, 直接共享已解析的轨道
+	if (bCacheable)
+	{
+		if (TSharedPtr<const FDreamLyricTrack> CachedTrack = FDreamLyricTrackCache::Get().Find(CacheKey))
+		{
+			ApplyLyricTrack(MoveTemp(CachedTrack));
+			return;
+		}
+	}
+
+	if (!bAsyncLoadLyric)
+	{
+		ApplyLyricTrack(ParseLyricTrack(CacheKey, bCacheable));
+		return;
+	}
+
+	bLyricLoadPending = true;
+	TWeakObjectPtr<UDreamMusicPlayerExpansion_Lyric> WeakThis(this);
+
+	// 正在预取的歌曲等待预取结果, 不再流式解析一次
+	if (bStreamLyric && FDreamLyricStreamParser::SupportsFileType(CacheKey.FileType) && !(bCacheable && FLyricPrefetchesInFlight::Get().Find(CacheKey).IsSet()))
+	{
+		LyricStreamCancelFlag = MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, LoadSerial, CacheKey = MoveTemp(CacheKey), bCacheable, CancelFlag = LyricStreamCancelFlag]()
+		{
+			FDreamLyricStreamParser StreamParser(CacheKey.FilePath, CacheKey.FileType, CacheKey.LineType);
+			StreamParser.Run([WeakThis, LoadSerial, &CacheKey, bCacheable](TSharedPtr<const FDreamLyricTrack> Track, bool bFinal)
+			{
+				if (bFinal && bCacheable)
+				{
+					Track = FDreamLyricTrackCache::Get().Add(CacheKey, MoveTemp(Track));
+				}
+
+				AsyncTask(ENamedThreads::GameThread, [WeakThis, LoadSerial, Track = MoveTemp(Track), bFinal]() mutable
+				{
+					UDreamMusicPlayerExpansion_Lyric* This = WeakThis.Get();
+					if (!This || This->LyricLoadSerial != LoadSerial)
+					{
+						return;
+					}
+
+					This->ApplyLyricTrack(MoveTemp(Track), bFinal);
+				});
+			}, CancelFlag.Get());
+		});
+		return;
+	}
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, LoadSerial, CacheKey = MoveTemp(CacheKey), bCacheable]()
+	{
+		TSharedPtr<const FDreamLyricTrack> Track = ParseLyricTrack(CacheKey, bCacheable);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, LoadSerial, Track = MoveTemp(Track)]() mutable
+		{
+			UDreamMusicPlayerExpansion_Lyric* This = WeakThis.Get();
+			if (!This || This->LyricLoadSerial != LoadSerial)
+			{
+				return;
+			}
+
+			This->ApplyLyricTrack(MoveTemp(Track));
+		});
+	});
+}
+
+void UDreamMusicPlayerExpansion_Lyric::ApplyLyricTrack(TSharedPtr<const FDreamLyricTrack> InTrack, bool bFinal)
+{
+	check(IsInGameThread());
 
-	CurrentMusicLyricList = Parser.GetLyrics();
+	bLyricLoadPending = !bFinal;
+	CurrentLyricTrack = InTrack.IsValid() ? MoveTemp(InTrack) : MakeShared<const FDreamLyricTrack>();
+	LyricLineCursor = INDEX_NONE;
+	InvalidateLyricBoundary();
+
+	// 流式加载时轨道会被替换, 仅当同一行仍在原位置时保留当前行
+	if (CurrentLyricIndex != INDEX_NONE)
+	{
+		if (!CurrentLyricTrack->IsValidLine(CurrentLyricIndex) || CurrentLyricTrack->GetLineStartTime(CurrentLyricIndex) != CurrentLyricStartTime)
+		{
+			CurrentLyricIndex = INDEX_NONE;
+			CurrentLyricWordIndex = INDEX_NONE;
+		}
+		else
+		{
+			CurrentLyricEndTime = CurrentLyricTrack->GetLineEndTime(CurrentLyricIndex);
+		}
+		ClearLyricProgressCache();
+	}
+
+	CurrentMusicLyricList.Reset();
+	if (bMaterializeLyricList)
+	{
+		CurrentLyricTrack->MaterializeLines(CurrentMusicLyricList);
+	}
 
 	OnLyricListChanged.Broadcast(CurrentMusicLyricList);
-	DMP_LOG_DEBUG_EXPANSION(Log, TEXT("InitializeLyricList Count : %02d - End"), CurrentMusicLyricList.Num());
+	DMP_LOG_DEBUG_EXPANSION(Log, TEXT("InitializeLyricList Count : %02d Track Size : %llu - End"), CurrentLyricTrack->NumLines(), static_cast<uint64>(CurrentLyricTrack->GetAllocatedSize()));
+
+	// 当前歌词加载完成后再预取, 避免与当前歌曲的解析争抢后台线程
+	if (bFinal)
+	{
+		PrefetchUpcomingLyrics();
+	}
+}
+
+void UDreamMusicPlayerExpansion_Lyric::PrefetchUpcomingLyrics()
+{
+	// 预取结果只保存在轨道缓存中, 缓存关闭时预取没有意义
+	if (!bPrefetchNextLyric || !MusicPlayerComponent || MusicPlayerComponent->MusicDataList.IsEmpty() || !FDreamLyricTrackCache::IsEnabled())
+	{
+		return;
+	}
+
+	// Random 模式每次 PlayMusic 都会重新打乱列表, 按当前列表顺序预取的歌曲多半不会接着播放
+	if (MusicPlayerComponent->PlayMode == EDreamMusicPlayerPlayMode::EDMPPS_Random)
+	{
+		return;
+	}
+
+	const int32 Lookahead = FMath::Min(LyricPrefetchLookahead, MusicPlayerComponent->MusicDataList.Num() - 1);
+	FDreamMusicDataStruct NextMusicData = CurrentMusicData;
+	for (int32 i = 0; i < Lookahead; i++)
+	{
+		NextMusicData = MusicPlayerComponent->GetNextMusicData(NextMusicData);
+
+		// Loop 模式下一首仍是当前歌曲, 列表循环回到当前歌曲时同样停止
+		if (!NextMusicData.IsValid() || NextMusicData == CurrentMusicData)
+		{
+			break;
+		}
+
+		const UDreamMusicPlayerExpansionData_Lyric* ExpansionData = NextMusicData.GetExpansionData<UDreamMusicPlayerExpansionData_Lyric>();
+		if (!ExpansionData || ExpansionData->LyricFileName.IsEmpty() || ExpansionData->GetBakedTrack().IsValid())
+		{
+			continue;
+		}
+
+		DMP_LOG_DEBUG_EXPANSION(Log, TEXT("Prefetch Lyric : %s"), *ExpansionData->LyricFileName);
+
+		// 文件状态读取与解析都在后台线程, 已在缓存中的歌曲只做一次查找
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [FilePath = GetLyricFilePath(ExpansionData->LyricFileName),
+			          FileType = ExpansionData->LyricParseFileType, LineType = ExpansionData->LyricParseLineType, LrcLyricType = ExpansionData->LrcLyricType]()
+		{
+			// 文件不存在时不解析, 切歌时由 InitializeLyricList 报告
+			FDreamLyricTrackCacheKey CacheKey;
+			if (FDreamLyricTrackCache::MakeKey(FilePath, FileType, LineType, LrcLyricType, CacheKey))
+			{
+				PrefetchLyricTrack(CacheKey);
+			}
+		});
+	}
+}
+
+int32 UDreamMusicPlayerExpansion_Lyric::GetLyricCount() const
+{
+	return CurrentLyricTrack.IsValid() ? CurrentLyricTrack->NumLines() : 0;
+}
+
+FDreamMusicLyric UDreamMusicPlayerExpansion_Lyric::GetLyricAtIndex(int32 Index) const
+{
+	return CurrentLyricTrack.IsValid() ? CurrentLyricTrack->MaterializeLine(Index) : FDreamMusicLyric::EMPTY();
+}
+
+void UDreamMusicPlayerExpansion_Lyric::GetLyricWindowRange(int32 NumBefore, int32 NumAfter, int32& OutFirstIndex, int32& OutLastIndex) const
+{
+	const int32 LineCount = GetLyricCount();
+
+	// 尚未进入第一行时以游标 (或第一行) 为中心
+	const int32 CenterIndex = CurrentLyricIndex != INDEX_NONE ? CurrentLyricIndex : FMath::Max(LyricLineCursor, 0);
+	OutFirstIndex = FMath::Clamp(CenterIndex - FMath::Max(NumBefore, 0), 0, LineCount);
+	OutLastIndex = FMath::Min(CenterIndex + FMath::Max(NumAfter, 0), LineCount - 1);
+}
+
+void UDreamMusicPlayerExpansion_Lyric::GetLyricWindowProgress(const FDreamMusicLyricTimestamp& InTimestamp, int32 NumBefore, int32 NumAfter, int32& OutFirstIndex, TArray<float>& OutLineProgress) const
+{
+	int32 LastIndex = INDEX_NONE;
+	GetLyricWindowRange(NumBefore, NumAfter, OutFirstIndex, LastIndex);
+
+	OutLineProgress.SetNumUninitialized(FMath::Max(LastIndex - OutFirstIndex + 1, 0));
+	CalculateLyricWindowProgress(InTimestamp.ToTime(), OutFirstIndex, OutLineProgress);
+}
+
+TConstArrayView<FDreamMusicLyric> UDreamMusicPlayerExpansion_Lyric::GetLyricListWindow(int32 NumBefore, int32 NumAfter) const
+{
+	int32 FirstIndex = 0;
+	int32 LastIndex = INDEX_NONE;
+	GetLyricWindowRange(NumBefore, NumAfter, FirstIndex, LastIndex);
+
+	// 列表与轨道行数一致时才能按行索引切片
+	if (LastIndex < FirstIndex || CurrentMusicLyricList.Num() != GetLyricCount())
+	{
+		return TConstArrayView<FDreamMusicLyric>();
+	}
+
+	return TConstArrayView<FDreamMusicLyric>(CurrentMusicLyricList).Slice(FirstIndex, LastIndex - FirstIndex + 1);
+}
+
+void UDreamMusicPlayerExpansion_Lyric::CalculateLyricWindowProgress(FDreamLyricTime InTime, int32 FirstIndex, TArrayView<float> OutLineProgress) const
+{
+	const TConstArrayView<FDreamLyricTime> StartTimes = CurrentLyricTrack.IsValid() ? CurrentLyricTrack->GetLineStartTimes() : TConstArrayView<FDreamLyricTime>();
+	const TConstArrayView<FDreamLyricTime> EndTimes = CurrentLyricTrack.IsValid() ? CurrentLyricTrack->GetLineEndTimes() : TConstArrayView<FDreamLyricTime>();
+
+	// 一次遍历连续的行时间数组
+	for (int32 i = 0; i < OutLineProgress.Num(); i++)
+	{
+		const int32 LineIndex = FirstIndex + i;
+		if (!StartTimes.IsValidIndex(LineIndex))
+		{
+			OutLineProgress[i] = 0.0f;
+			continue;
+		}
+
+		const int32 LineDuration = EndTimes[LineIndex] - StartTimes[LineIndex];
+		OutLineProgress[i] = LineDuration > 0
+			? FMath::Clamp(static_cast<float>(InTime - StartTimes[LineIndex]) / static_cast<float>(LineDuration), 0.0f, 1.0f)
+			: (InTime >= StartTimes[LineIndex] ? 1.0f : 0.0f);
+	}
+}
+
+TArray<int32> UDreamMusicPlayerExpansion_Lyric::GetActiveLyricIndices(const FDreamMusicLyricTimestamp& InTimestamp) const
+{
+	return TArray<int32>(GetActiveLyricLines(InTimestamp.ToTime()));
+}
+
+TConstArrayView<int32> UDreamMusicPlayerExpansion_Lyric::GetActiveLyricLines(FDreamLyricTime InTime) const
+{
+	return CurrentLyricTrack.IsValid() ? CurrentLyricTrack->GetActiveLines(InTime) : TConstArrayView<int32>();
 }
 
 void UDreamMusicPlayerExpansion_Lyric::PlayMusicWithLyric(FDreamMusicLyric InLyric)
 {
-	if (CurrentMusicLyricList.Contains(InLyric))
+	const FDreamLyricTime LyricStartTime = InLyric.StartTimestamp.ToTime();
+	const int32 LineIndex = CurrentLyricTrack.IsValid() ? CurrentLyricTrack->FindLineIndex(LyricStartTime) : INDEX_NONE;
+	if (LineIndex != INDEX_NONE && CurrentLyricTrack->GetLineStartTime(LineIndex) == LyricStartTime)
 	{
 		float Time = InLyric.StartTimestamp.ToSeconds();
 		Time = UKismetMathLibrary::NormalizeToRange(Time, 0.0f, MusicPlayerComponent->CurrentMusicDuration);
@@ -51,189 +372,246 @@ void UDreamMusicPlayerExpansion_Lyric::PlayMusicWithLyric(FDreamMusicLyric InLyr
 
 FDreamMusicLyricProgress UDreamMusicPlayerExpansion_Lyric::GetCurrentLyricWordProgress(const FDreamMusicLyricTimestamp& InTimestamp) const
 {
-	return CalculateWordProgress(InTimestamp);
+	return CalculateWordProgress(InTimestamp.ToTime());
 }
 
 FDreamMusicLyricProgress UDreamMusicPlayerExpansion_Lyric::GetCurrentRomanizationProgress(const FDreamMusicLyricTimestamp& InTimestamp) const
 {
-	return CalculateWordProgress(InTimestamp, true);
+	return CalculateWordProgress(InTimestamp.ToTime(), true);
+}
+
+FDreamMusicLyricWordProgress UDreamMusicPlayerExpansion_Lyric::GetCurrentWordProgressIndex(const FDreamMusicLyricTimestamp& InTimestamp, bool bUseRoma) const
+{
+	return CalculateWordProgressIndex(InTimestamp.ToTime(), bUseRoma ? EDreamLyricWordChannel::Romanization : EDreamLyricWordChannel::Lyric);
+}
+
+float UDreamMusicPlayerExpansion_Lyric::GetCurrentLyricGraphemeProgress(const FDreamMusicLyricTimestamp& InTimestamp, bool bUseRoma) const
+{
+	return CalculateGraphemeProgress(InTimestamp.ToTime(), bUseRoma ? EDreamLyricWordChannel::Romanization : EDreamLyricWordChannel::Lyric);
 }
 
 FDreamMusicLyricProgress UDreamMusicPlayerExpansion_Lyric::GetCurrentLyricLineProgress(const FDreamMusicLyricTimestamp& InTimestamp) const
 {
-	return CalculateLineProgress(InTimestamp);
+	return CalculateLineProgress(InTimestamp.ToTime());
 }
 
-void UDreamMusicPlayerExpansion_Lyric::BuildWordDurationCache(bool bUseRoma) const
+void UDreamMusicPlayerExpansion_Lyric::BP_MusicStart_Implementation()
 {
-	if (bCacheValid && bLastUseRoma == bUseRoma)
-	{
-		return;
-	}
+	InitializeLyricList();
+}
 
-	const TArray<FDreamMusicLyricWord>& Words = bUseRoma ? CurrentLyric.RomanizationWordTimings : CurrentLyric.WordTimings;
+void UDreamMusicPlayerExpansion_Lyric::BP_MusicSetPercent_Implementation(float InPercent)
+{
+	InvalidateLyricBoundary();
+}
 
-	WordDurationPrefixSum.Empty();
-	WordDurationPrefixSum.Reserve(Words.Num());
+void UDreamMusicPlayerExpansion_Lyric::Tick(FDreamLyricTime InTime, float InDeltaTime)
+{
+	CurrentTime = InTime;
 
-	int32 CumulativeDuration = 0;
-	for (const FDreamMusicLyricWord& Word : Words)
+	// 歌词仍在后台加载且尚未发布任何轨道时忽略
+	// 两个边界之间行与字的状态不变, 每帧只需一次比较; 暂停时时间不变, Seek 与循环使时间落在窗口之外而重新计算
+	if (CurrentLyricTrack.IsValid() && (CurrentTime < LyricBoundaryWindowStart || CurrentTime >= NextLyricBoundaryTime))
 	{
-		int32 WordDuration = Word.EndTimestamp.ToMilliseconds() - Word.StartTimestamp.ToMilliseconds();
-		CumulativeDuration += WordDuration;
-		WordDurationPrefixSum.Add(CumulativeDuration);
+		UpdateLyricBoundary();
 	}
 
-	bCacheValid = true;
-	bLastUseRoma = bUseRoma;
+	// 蓝图的 On Tick 看到的是本帧更新后的歌词
+	Super::Tick(InTime, InDeltaTime);
 }
 
-void UDreamMusicPlayerExpansion_Lyric::BP_MusicStart_Implementation()
+void UDreamMusicPlayerExpansion_Lyric::UpdateLyricBoundary()
 {
-	InitializeLyricList();
+	// 游标查找, 正常播放时均摊 O(1), Seek 与循环时自动重新定位
+	const int32 Index = CurrentLyricTrack->AdvanceLineIndex(CurrentTime, LyricLineCursor);
+	LyricLineCursor = Index;
+	if (CurrentLyricTrack->IsValidLine(Index))
+	{
+		SetCurrentLyric(Index);
+	}
+
+	// 下一个边界: 下一行开始, 当前行结束, 当前行内当前字结束或下一个字开始
+	FDreamLyricTime NextBoundary(MAX_int32);
+	auto ConsiderBoundary = [this, &NextBoundary](FDreamLyricTime BoundaryTime)
+	{
+		if (CurrentTime < BoundaryTime && BoundaryTime < NextBoundary)
+		{
+			NextBoundary = BoundaryTime;
+		}
+	};
+
+	if (CurrentLyricTrack->IsValidLine(Index + 1))
+	{
+		ConsiderBoundary(CurrentLyricTrack->GetLineStartTime(Index + 1));
+	}
+
+	int32 WordIndex = INDEX_NONE;
+	if (CurrentLyricTrack->IsValidLine(CurrentLyricIndex))
+	{
+		ConsiderBoundary(CurrentLyricEndTime);
+
+		const TConstArrayView<FDreamLyricTime> StartTimes = CurrentLyricTrack->GetLineWordStartTimes(EDreamLyricWordChannel::Lyric, CurrentLyricIndex);
+		const TConstArrayView<FDreamLyricTime> EndTimes = CurrentLyricTrack->GetLineWordEndTimes(EDreamLyricWordChannel::Lyric, CurrentLyricIndex);
+		const int32 LastStarted = Algo::UpperBound(StartTimes, CurrentTime) - 1;
+		if (StartTimes.IsValidIndex(LastStarted))
+		{
+			ConsiderBoundary(EndTimes[LastStarted]);
+			WordIndex = CurrentTime < EndTimes[LastStarted] ? LastStarted : INDEX_NONE;
+		}
+		if (StartTimes.IsValidIndex(LastStarted + 1))
+		{
+			ConsiderBoundary(StartTimes[LastStarted + 1]);
+		}
+	}
+
+	// 窗口从本次计算的时间开始, 向后 Seek 到窗口内的时间同样会重新计算
+	LyricBoundaryWindowStart = CurrentTime;
+	NextLyricBoundaryTime = NextBoundary;
+
+	if (WordIndex != CurrentLyricWordIndex)
+	{
+		CurrentLyricWordIndex = WordIndex;
+		OnLyricWordChanged.Broadcast(CurrentLyricIndex, CurrentLyricWordIndex);
+		OnLyricWordChangedNative.Broadcast(CurrentLyricIndex, CurrentLyricWordIndex);
+	}
 }
 
-void UDreamMusicPlayerExpansion_Lyric::BP_Tick_Implementation(const FDreamMusicLyricTimestamp& InTimestamp, float InDeltaTime)
+
+FDreamMusicLyricProgress UDreamMusicPlayerExpansion_Lyric::CalculateWordProgress(FDreamLyricTime InCurrentTime, bool bUseRoma) const
 {
-	SetCurrentLyric(FDreamMusicPlayerLyricTools::GetLyricAtTimestamp(CurrentTimestamp, CurrentMusicLyricList));
-}
+	const EDreamLyricWordChannel Channel = bUseRoma ? EDreamLyricWordChannel::Romanization : EDreamLyricWordChannel::Lyric;
+	const FDreamMusicLyricWordProgress Progress = CalculateWordProgressIndex(InCurrentTime, Channel);
 
+	// 只有正在播放的字需要生成文本
+	if (!Progress.bIsActive)
+	{
+		return FDreamMusicLyricProgress(Progress.CurrentWordIndex, Progress.LineProgress, false, FDreamMusicLyricWord{});
+	}
 
-FDreamMusicLyricProgress UDreamMusicPlayerExpansion_Lyric::CalculateWordProgress(FDreamMusicLyricTimestamp InCurrentTime, bool bUseRoma) const
+	const int32 GlobalWordIndex = CurrentLyricTrack->GetLineWordBegin(Channel, CurrentLyricIndex) + Progress.CurrentWordIndex;
+	return FDreamMusicLyricProgress(Progress.CurrentWordIndex, Progress.LineProgress, true, CurrentLyricTrack->MaterializeWord(Channel, GlobalWordIndex));
+}
+
+FDreamMusicLyricWordProgress UDreamMusicPlayerExpansion_Lyric::CalculateWordProgressIndex(FDreamLyricTime InCurrentTime, EDreamLyricWordChannel Channel) const
 {
 	// 边界检查
-	if (CurrentLyric.IsEmpty())
+	if (!CurrentLyricTrack.IsValid() || !CurrentLyricTrack->IsValidLine(CurrentLyricIndex))
 	{
-		CachedCurrentWordIndex = -1;
-		bCacheValid = false;
-		return FDreamMusicLyricProgress(0, 0.0f, false, FDreamMusicLyricWord{});
+		return FDreamMusicLyricWordProgress(0, 0.0f, false);
 	}
 
 	// 如果当前时间在歌词行开始之前，返回0
-	if (InCurrentTime < CurrentLyric.StartTimestamp)
+	if (InCurrentTime < CurrentLyricStartTime)
 	{
-		CachedCurrentWordIndex = -1;
-		bCacheValid = false;
-		return FDreamMusicLyricProgress(0, 0.0f, false, FDreamMusicLyricWord{});
+		return FDreamMusicLyricWordProgress(0, 0.0f, false);
 	}
 
 	// 如果当前时间在歌词行结束之后，返回1（完成状态）
-	if (InCurrentTime > CurrentLyric.EndTimestamp)
+	if (InCurrentTime > CurrentLyricEndTime)
 	{
-		CachedCurrentWordIndex = -1;
-		bCacheValid = false;
-		return FDreamMusicLyricProgress(-1, 1.0f, false, FDreamMusicLyricWord{});
+		return FDreamMusicLyricWordProgress(-1, 1.0f, false);
 	}
 
+	const TConstArrayView<FDreamLyricTime> StartTimes = CurrentLyricTrack->GetLineWordStartTimes(Channel, CurrentLyricIndex);
+	const TConstArrayView<FDreamLyricTime> EndTimes = CurrentLyricTrack->GetLineWordEndTimes(Channel, CurrentLyricIndex);
+
 	// 如果没有单词时间信息，使用行进度
-	if (bUseRoma ? CurrentLyric.IsRomanizationWordsEmpty() : CurrentLyric.IsWordsEmpty())
+	if (StartTimes.IsEmpty())
 	{
-		return CalculateLineProgress(InCurrentTime);
+		const FDreamMusicLyricProgress LineProgress = CalculateLineProgress(InCurrentTime);
+		return FDreamMusicLyricWordProgress(-1, LineProgress.LineProgress, false);
 	}
 
-	// 构建缓存
-	BuildWordDurationCache(bUseRoma);
-
-	const TArray<FDreamMusicLyricWord>& Words = bUseRoma ? CurrentLyric.RomanizationWordTimings : CurrentLyric.WordTimings;
-
-	// 性能优化：从上次位置开始查找，通常时间是递增的
-	int32 StartIndex = 0;
-	if (CachedCurrentWordIndex >= 0 && CachedCurrentWordIndex < Words.Num() &&
-		InCurrentTime >= LastCalculationTime)
+	const int32 WordCount = StartTimes.Num();
+	auto IsLastStarted = [&StartTimes, WordCount, InCurrentTime](int32 WordIndex)
 	{
-		StartIndex = CachedCurrentWordIndex;
-	}
+		return StartTimes.IsValidIndex(WordIndex) && StartTimes[WordIndex] <= InCurrentTime && (WordIndex + 1 == WordCount || InCurrentTime < StartTimes[WordIndex + 1]);
+	};
 
-	// 查找当前单词
-	int32 CurrentWordIndex = -1;
-	for (int32 i = StartIndex; i < Words.Num(); i++)
+	// 游标快速路径: 仍在同一个字或刚进入下一个字, 否则二分查找
+	int32& Cursor = WordCursors[static_cast<int32>(Channel)];
+	if (!IsLastStarted(Cursor))
 	{
-		const FDreamMusicLyricWord& Word = Words[i];
-		if (InCurrentTime >= Word.StartTimestamp && InCurrentTime < Word.EndTimestamp)
-		{
-			CurrentWordIndex = i;
-			break;
-		}
+		Cursor = IsLastStarted(Cursor + 1) ? Cursor + 1 : Algo::UpperBound(StartTimes, InCurrentTime) - 1;
 	}
 
-	// 如果从缓存位置没找到，从头查找
-	if (CurrentWordIndex == -1 && StartIndex > 0)
+	// 两个字之间的空隙不属于任何字
+	const int32 CurrentWordIndex = Cursor != INDEX_NONE && InCurrentTime < EndTimes[Cursor] ? Cursor : INDEX_NONE;
+
+	// Use the actual span of word timings, fall back to the line duration if it is invalid
+	const FDreamLyricTime FirstWordStartTime = StartTimes[0];
+	const int32 ActualWordTimingDuration = EndTimes[WordCount - 1] - FirstWordStartTime;
+	const int32 LineTotalDuration = CurrentLyricEndTime - CurrentLyricStartTime;
+	const int32 EffectiveDuration = FMath::Max(ActualWordTimingDuration > 0 ? ActualWordTimingDuration : LineTotalDuration, 1);
+
+	if (CurrentWordIndex != INDEX_NONE)
 	{
-		for (int32 i = 0; i < StartIndex; i++)
-		{
-			const FDreamMusicLyricWord& Word = Words[i];
-			if (InCurrentTime >= Word.StartTimestamp && InCurrentTime < Word.EndTimestamp)
-			{
-				CurrentWordIndex = i;
-				break;
-			}
-		}
+		// 行内前缀时长在轨道构建时预先计算
+		const int32 TotalProgress = CurrentLyricTrack->GetLineWordElapsedBefore(Channel, CurrentLyricIndex)[CurrentWordIndex] + (InCurrentTime - StartTimes[CurrentWordIndex]);
+		const float LineProgress = FMath::Clamp(static_cast<float>(TotalProgress) / static_cast<float>(EffectiveDuration), 0.0f, 1.0f);
+		return FDreamMusicLyricWordProgress(CurrentWordIndex, LineProgress, true);
 	}
 
-	// 更新缓存
-	CachedCurrentWordIndex = CurrentWordIndex;
-	LastCalculationTime = InCurrentTime;
+	// 回退到基于实际单词时间的进度计算
+	const int32 Elapsed = InCurrentTime - FirstWordStartTime;
+	const float LineProgress = FMath::Clamp(static_cast<float>(Elapsed) / static_cast<float>(EffectiveDuration), 0.0f, 1.0f);
+	return FDreamMusicLyricWordProgress(-1, LineProgress, false);
+}
 
-	// **FIX: Calculate actual word timing duration instead of using artificial EndTimestamp**
-	int32 ActualWordTimingDuration = 0;
-	if (Words.Num() > 0)
+float UDreamMusicPlayerExpansion_Lyric::CalculateGraphemeProgress(FDreamLyricTime InCurrentTime, EDreamLyricWordChannel Channel) const
+{
+	const FDreamMusicLyricWordProgress WordProgress = CalculateWordProgressIndex(InCurrentTime, Channel);
+	if (!CurrentLyricTrack.IsValid() || !CurrentLyricTrack->IsValidLine(CurrentLyricIndex) || InCurrentTime < CurrentLyricStartTime)
 	{
-		// Use the actual span of word timings for LRC files
-		FDreamMusicLyricTimestamp LastWordEnd = Words.Last().EndTimestamp;
-		FDreamMusicLyricTimestamp FirstWordStart = Words[0].StartTimestamp;
-		ActualWordTimingDuration = LastWordEnd.ToMilliseconds() - FirstWordStart.ToMilliseconds();
+		return 0.0f;
 	}
 
-	// Fallback to line duration if word timing duration is invalid
-	int32 LineTotalDuration = CurrentLyric.EndTimestamp.ToMilliseconds() - CurrentLyric.StartTimestamp.ToMilliseconds();
-	int32 EffectiveDuration = (ActualWordTimingDuration > 0) ? ActualWordTimingDuration : LineTotalDuration;
-
-	if (CurrentWordIndex >= 0)
+	// 字素簇边界在轨道构建时已计算, 这里只做二分
+	const TConstArrayView<int32> GraphemeEnds = CurrentLyricTrack->GetLineGraphemeEnds(Channel, CurrentLyricIndex);
+	if (GraphemeEnds.IsEmpty() || InCurrentTime > CurrentLyricEndTime)
 	{
-		const FDreamMusicLyricWord& CurrentWord = Words[CurrentWordIndex];
+		return WordProgress.LineProgress;
+	}
 
-		// 使用前缀和快速计算进度
-		int32 ProgressToWordStart = (CurrentWordIndex > 0) ? WordDurationPrefixSum[CurrentWordIndex - 1] : 0;
-		int32 CurrentWordElapsed = InCurrentTime.ToMilliseconds() - CurrentWord.StartTimestamp.ToMilliseconds();
-		int32 TotalProgress = ProgressToWordStart + CurrentWordElapsed;
+	// 结束偏移不超过 Offset 的字素簇个数
+	auto CountGraphemes = [&GraphemeEnds](int32 Offset)
+	{
+		return static_cast<float>(Algo::UpperBound(GraphemeEnds, Offset));
+	};
 
-		// **FIX: Use effective duration instead of artificial line duration**
-		float LineProgress = static_cast<float>(TotalProgress) / static_cast<float>(EffectiveDuration);
-		
-		// Clamp to ensure we don't exceed 1.0
-		LineProgress = FMath::Clamp(LineProgress, 0.0f, 1.0f);
+	const int32 WordCount = CurrentLyricTrack->GetLineWordCount(Channel, CurrentLyricIndex);
+	const int32 Cursor = WordCursors[static_cast<int32>(Channel)];
+	const int32 WordIndex = WordProgress.bIsActive ? WordProgress.CurrentWordIndex : Cursor;
 
-		return FDreamMusicLyricProgress(CurrentWordIndex, LineProgress, true, CurrentWord);
+	int32 TextBegin = 0;
+	int32 TextEnd = 0;
+	if (WordCount == 0 || WordIndex < 0 || WordIndex >= WordCount || !CurrentLyricTrack->GetLineWordTextRange(Channel, CurrentLyricIndex, WordIndex, TextBegin, TextEnd))
+	{
+		// 没有逐字时间, 还没到第一个字, 或字文本对不上行文本时按时间均匀推进
+		return WordCount > 0 && Cursor == INDEX_NONE ? 0.0f : WordProgress.LineProgress;
 	}
-	else
+
+	float Alpha = 1.0f;
+	if (WordProgress.bIsActive)
 	{
-		// 回退到基于实际单词时间的进度计算
-		if (Words.Num() > 0)
-		{
-			FDreamMusicLyricTimestamp FirstWordStart = Words[0].StartTimestamp;
-			int32 Elapsed = InCurrentTime.ToMilliseconds() - FirstWordStart.ToMilliseconds();
-			float LineProgress = static_cast<float>(Elapsed) / static_cast<float>(EffectiveDuration);
-			LineProgress = FMath::Clamp(LineProgress, 0.0f, 1.0f);
-			
-			return FDreamMusicLyricProgress(-1, LineProgress, false, FDreamMusicLyricWord{});
-		}
-		else
-		{
-			// Final fallback to line progress
-			return CalculateLineProgress(InCurrentTime);
-		}
+		const FDreamLyricTime WordStart = CurrentLyricTrack->GetLineWordStartTimes(Channel, CurrentLyricIndex)[WordIndex];
+		const FDreamLyricTime WordEnd = CurrentLyricTrack->GetLineWordEndTimes(Channel, CurrentLyricIndex)[WordIndex];
+		Alpha = FMath::Clamp(static_cast<float>(InCurrentTime - WordStart) / static_cast<float>(FMath::Max(WordEnd - WordStart, 1)), 0.0f, 1.0f);
 	}
+
+	const float Highlighted = FMath::Lerp(CountGraphemes(TextBegin), CountGraphemes(TextEnd), Alpha);
+	return FMath::Clamp(Highlighted / static_cast<float>(GraphemeEnds.Num()), 0.0f, 1.0f);
 }
 
-FDreamMusicLyricProgress UDreamMusicPlayerExpansion_Lyric::CalculateLineProgress(FDreamMusicLyricTimestamp InCurrentTime) const
+FDreamMusicLyricProgress UDreamMusicPlayerExpansion_Lyric::CalculateLineProgress(FDreamLyricTime InCurrentTime) const
 {
-	if (InCurrentTime < CurrentLyric.StartTimestamp || InCurrentTime > CurrentLyric.EndTimestamp)
+	if (InCurrentTime < CurrentLyricStartTime || InCurrentTime > CurrentLyricEndTime)
 	{
 		return FDreamMusicLyricProgress(-1, 0.0f, false, FDreamMusicLyricWord{});
 	}
 
-	int32 LineDuration = CurrentLyric.EndTimestamp.ToMilliseconds() - CurrentLyric.StartTimestamp.ToMilliseconds();
-	int32 Elapsed = InCurrentTime.ToMilliseconds() - CurrentLyric.StartTimestamp.ToMilliseconds();
+	int32 LineDuration = CurrentLyricEndTime - CurrentLyricStartTime;
+	int32 Elapsed = InCurrentTime - CurrentLyricStartTime;
 
 	// 修复整数除法问题
 	float Progress = static_cast<float>(Elapsed) / static_cast<float>(LineDuration);
@@ -241,15 +619,29 @@ FDreamMusicLyricProgress UDreamMusicPlayerExpansion_Lyric::CalculateLineProgress
 	return FDreamMusicLyricProgress(-1, Progress, false, FDreamMusicLyricWord{});
 }
 
-void UDreamMusicPlayerExpansion_Lyric::SetCurrentLyric(FDreamMusicLyric InLyric)
+void UDreamMusicPlayerExpansion_Lyric::SetCurrentLyric(int32 InLineIndex)
 {
-	if (InLyric != CurrentLyric && InLyric.IsNotEmpty())
+	if (InLineIndex == CurrentLyricIndex)
 	{
-		ClearLyricProgressCache();
-		CurrentLyric = InLyric;
-		OnLyricChanged.Broadcast(CurrentLyric, CurrentMusicLyricList.Find(CurrentLyric));
-		OnLyricChangedNative.Broadcast(CurrentLyric, CurrentMusicLyricList.Find(CurrentLyric));
-		DMP_LOG_DEBUG_EXPANSION(Log, "Lyric", TEXT("Set : Time : %02d:%02d.%02d Content : %s"),
-		                        InLyric.StartTimestamp.Minute, InLyric.StartTimestamp.Seconds, InLyric.StartTimestamp.Millisecond, *InLyric.Content);
+		return;
+	}
+
+	const FDreamLyricTime LineStartTime = CurrentLyricTrack->GetLineStartTime(InLineIndex);
+	if (LineStartTime.Milliseconds <= 0 && CurrentLyricTrack->GetLineContent(InLineIndex).IsEmpty())
+	{
+		return;
 	}
+
+	ClearLyricProgressCache();
+	CurrentLyricIndex = InLineIndex;
+	CurrentLyricWordIndex = INDEX_NONE;
+	CurrentLyric = CurrentLyricTrack->MaterializeLine(InLineIndex);
+	CurrentLyricStartTime = LineStartTime;
+	CurrentLyricEndTime = CurrentLyricTrack->GetLineEndTime(InLineIndex);
+	OnLyricChanged.Broadcast(CurrentLyric, CurrentLyricIndex);
+	OnLyricChangedNative.Broadcast(CurrentLyric, CurrentLyricIndex);
+	OnLyricIndexChanged.Broadcast(CurrentLyricIndex);
+	OnLyricIndexChangedNative.Broadcast(CurrentLyricIndex);
+	DMP_LOG_DEBUG_EXPANSION(Log, "Lyric", TEXT("Set : Time : %02d:%02d.%02d Content : %s"),
+	                        CurrentLyric.StartTimestamp.Minute, CurrentLyric.StartTimestamp.Seconds, CurrentLyric.StartTimestamp.Millisecond, *CurrentLyric.Content);
 }
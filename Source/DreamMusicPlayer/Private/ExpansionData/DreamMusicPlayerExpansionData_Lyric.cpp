@@ -2,3 +2,144 @@
 
 
 #include "ExpansionData/DreamMusicPlayerExpansionData_Lyric.h"
+
+#include "DreamMusicPlayerCustomVersion.h"
+#include "DreamMusicPlayerLog.h"
+#include "LyricParser/DreamLyricTrack.h"
+#include "LyricParser/DreamLyricTimingSynthesizer.h"
+#include "UObject/ObjectSaveContext.h"
+#if WITH_EDITOR
+#include "LyricParser/DreamLyricParser.h"
+#include "LyricParser/DreamMusicPlayerLyricTools.h"
+#endif
+
+void UDreamMusicPlayerExpansionData_Lyric::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	Ar.UsingCustomVersion(FDreamMusicPlayerCustomVersion::GUID);
+	if (Ar.CustomVer(FDreamMusicPlayerCustomVersion::GUID) < FDreamMusicPlayerCustomVersion::BakedLyricTrack)
+	{
+		return;
+	}
+
+	TSharedPtr<const FDreamLyricTrack> TrackToSave;
+	bool bSynthesizeWordTimings = false;
+#if WITH_EDITOR
+	// 轨道在 PreSave / BeginCacheForCookedPlatformData 中烘焙, 这里只写入
+	if (Ar.IsSaving() && Ar.IsCooking())
+	{
+		TrackToSave = CookedTrack;
+		bSynthesizeWordTimings = bCookedSynthesizeWordTimings;
+	}
+#endif
+
+	bool bHasBakedTrack = TrackToSave.IsValid();
+	Ar << bHasBakedTrack;
+
+	if (!bHasBakedTrack)
+	{
+		if (Ar.IsLoading())
+		{
+			BakedTrack.Reset();
+			bBakedSynthesizeWordTimings = false;
+		}
+		return;
+	}
+
+	// 旧资产烘焙时还没有逐字时间生成
+	if (Ar.CustomVer(FDreamMusicPlayerCustomVersion::GUID) >= FDreamMusicPlayerCustomVersion::BakedLyricSynthesisFlag)
+	{
+		Ar << bSynthesizeWordTimings;
+	}
+
+	if (Ar.IsLoading())
+	{
+		FDreamLyricTrack Track;
+		Track.Serialize(Ar);
+		if (Ar.IsError())
+		{
+			DMP_LOG(Error, TEXT("Failed to load baked lyric track : %s"), *LyricFileName);
+			BakedTrack.Reset();
+			return;
+		}
+		BakedTrack = MakeShared<const FDreamLyricTrack>(MoveTemp(Track));
+		bBakedSynthesizeWordTimings = bSynthesizeWordTimings;
+	}
+	else
+	{
+		// Track::Serialize 在保存时不会修改数据
+		const_cast<FDreamLyricTrack&>(*TrackToSave).Serialize(Ar);
+	}
+}
+
+void UDreamMusicPlayerExpansionData_Lyric::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+#if WITH_EDITOR
+	if (ObjectSaveContext.IsCooking())
+	{
+		CacheCookedTrack();
+	}
+#endif
+}
+
+TSharedPtr<const FDreamLyricTrack> UDreamMusicPlayerExpansionData_Lyric::GetBakedTrack() const
+{
+	// 烘焙的轨道固定了 Cook 时的设置, 与运行时设置不同时回退到解析歌词文件
+	if (BakedTrack.IsValid() && bBakedSynthesizeWordTimings != FDreamLyricTimingSynthesizer::IsEnabled())
+	{
+		return nullptr;
+	}
+
+	return BakedTrack;
+}
+
+#if WITH_EDITOR
+void UDreamMusicPlayerExpansionData_Lyric::BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform)
+{
+	Super::BeginCacheForCookedPlatformData(TargetPlatform);
+	CacheCookedTrack();
+}
+
+void UDreamMusicPlayerExpansionData_Lyric::ClearAllCachedCookedPlatformData()
+{
+	Super::ClearAllCachedCookedPlatformData();
+	CookedTrack.Reset();
+	bCookedSynthesizeWordTimings = false;
+	bCookedTrackCached = false;
+}
+
+void UDreamMusicPlayerExpansionData_Lyric::CacheCookedTrack()
+{
+	if (bCookedTrackCached)
+	{
+		return;
+	}
+
+	bCookedTrackCached = true;
+	bCookedSynthesizeWordTimings = FDreamLyricTimingSynthesizer::IsEnabled();
+	CookedTrack = bBakeLyricOnCook && !LyricFileName.IsEmpty() ? BakeLyricTrack() : nullptr;
+}
+
+TSharedPtr<const FDreamLyricTrack> UDreamMusicPlayerExpansionData_Lyric::BakeLyricTrack() const
+{
+	// Cook 不应在 Saved 下留下运行时缓存
+	FDreamLyricParser Parser(FDreamMusicPlayerLyricTools::GetLyricFilePath(LyricFileName),
+	                         LyricParseFileType,
+	                         LyricParseLineType,
+	                         LrcLyricType,
+	                         false);
+
+	TSharedPtr<const FDreamLyricTrack> Track = Parser.GetTrack();
+	if (!Track.IsValid() || Track->IsEmpty())
+	{
+		DMP_LOG(Warning, TEXT("Lyric bake skipped, no lyric parsed : %s"), *LyricFileName);
+		return nullptr;
+	}
+
+	DMP_LOG(Log, TEXT("Baked lyric track : %s Lines : %d"), *LyricFileName, Track->NumLines());
+	return Track;
+}
+#endif
@@ -0,0 +1,117 @@
+﻿#include "LyricParser/DreamLyricBatchParser.h"
+
+#include "LyricParser/DreamLyricParser.h"
+#include "LyricParser/DreamLyricTrack.h"
+#include "DreamMusicPlayerLog.h"
+#include "Async/ParallelFor.h"
+
+namespace FDreamLyricBatchParser
+{
+	void Parse(TConstArrayView<FDreamLyricBatchRequest> Requests,
+	           TArray<FDreamLyricBatchResult>& OutResults,
+	           FDreamLyricBatchStats& OutStats,
+	           bool bValidate,
+	           const std::atomic<bool>* CancelFlag)
+	{
+		OutStats = FDreamLyricBatchStats();
+		OutStats.NumFiles = Requests.Num();
+
+		OutResults.Reset(Requests.Num());
+		OutResults.SetNum(Requests.Num());
+
+		const uint64 BatchStartCycles = FPlatformTime::Cycles64();
+
+		// 相同文件与设置只解析一次, 避免两个任务同时解析并写入同一个缓存文件
+		TArray<int32> UniqueIndices;
+		TArray<int32> SourceIndices;
+		UniqueIndices.Reserve(Requests.Num());
+		SourceIndices.SetNumUninitialized(Requests.Num());
+		{
+			using FRequestKey = TTuple<FString, EDreamMusicPlayerLyricParseFileType, EDreamMusicPlayerLyricParseLineType, EDreamMusicPlayerLrcLyricType>;
+
+			TMap<FRequestKey, int32> FirstIndexByKey;
+			FirstIndexByKey.Reserve(Requests.Num());
+			for (int32 Index = 0; Index < Requests.Num(); Index++)
+			{
+				const FDreamLyricBatchRequest& Request = Requests[Index];
+				FRequestKey Key(FPaths::ConvertRelativePathToFull(Request.FilePath), Request.FileType, Request.LineType, Request.LrcLyricType);
+
+				if (const int32* FirstIndex = FirstIndexByKey.Find(Key))
+				{
+					SourceIndices[Index] = *FirstIndex;
+				}
+				else
+				{
+					FirstIndexByKey.Add(MoveTemp(Key), Index);
+					SourceIndices[Index] = Index;
+					UniqueIndices.Add(Index);
+				}
+			}
+		}
+
+		// 每个文件一个任务, 解析器之间不共享可变状态
+		ParallelFor(UniqueIndices.Num(), [&Requests, &OutResults, &UniqueIndices, bValidate, CancelFlag](int32 UniqueIndex)
+		{
+			const int32 Index = UniqueIndices[UniqueIndex];
+			const FDreamLyricBatchRequest& Request = Requests[Index];
+			FDreamLyricBatchResult& Result = OutResults[Index];
+			Result.FilePath = Request.FilePath;
+
+			if (CancelFlag && CancelFlag->load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+
+			FDreamLyricParser Parser(Request.FilePath, Request.FileType, Request.LineType, Request.LrcLyricType);
+
+			Result.Track = Parser.GetTrack();
+			Result.bLoadedFromCache = Parser.bLoadedFromCache;
+			Result.LineCount = Parser.GetLyricCount();
+			Result.Duration = Parser.GetTotalDuration();
+			Result.bSuccess = Result.LineCount > 0;
+			Result.NumUnsortedLines = Parser.NumUnsortedSourceLines;
+			Result.FirstUnsortedLine = Parser.FirstUnsortedSourceLine;
+			Result.FirstUnsortedTimeMs = Parser.FirstUnsortedSourceTime.Milliseconds;
+
+			if (bValidate)
+			{
+				Result.ValidationErrors = Parser.GetValidationErrors();
+			}
+
+			Result.ParseTimeMs = static_cast<float>(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+		});
+
+		OutStats.WallTimeMs = static_cast<float>(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - BatchStartCycles));
+
+		// 重复的请求共享第一次的结果 (轨道为共享指针, 不复制)
+		for (int32 Index = 0; Index < Requests.Num(); Index++)
+		{
+			if (SourceIndices[Index] != Index)
+			{
+				OutResults[Index] = OutResults[SourceIndices[Index]];
+				OutResults[Index].FilePath = Requests[Index].FilePath;
+				OutResults[Index].ParseTimeMs = 0.0f;
+			}
+		}
+
+		for (const FDreamLyricBatchResult& Result : OutResults)
+		{
+			OutStats.NumSucceeded += Result.bSuccess ? 1 : 0;
+			OutStats.NumFromCache += Result.bLoadedFromCache ? 1 : 0;
+			OutStats.NumLines += Result.LineCount;
+			OutStats.TotalParseTimeMs += Result.ParseTimeMs;
+
+			if (Result.ParseTimeMs > OutStats.MaxParseTimeMs)
+			{
+				OutStats.MaxParseTimeMs = Result.ParseTimeMs;
+				OutStats.SlowestFile = Result.FilePath;
+			}
+		}
+
+		DMP_LOG(Log, TEXT("Batch lyric parse : %d/%d files, %d lines, wall %.2f ms, total %.2f ms, slowest %.2f ms (%s)"),
+		        OutStats.NumSucceeded, OutStats.NumFiles, OutStats.NumLines,
+		        OutStats.WallTimeMs, OutStats.TotalParseTimeMs, OutStats.MaxParseTimeMs, *OutStats.SlowestFile);
+	}
+}
@@ -0,0 +1,231 @@
+﻿#include "LyricParser/DreamLyricCache.h"
+
+#include "DreamMusicPlayerDebugLog.h"
+#include "LyricParser/DreamLyricTrack.h"
+#include "Async/MappedFileHandle.h"
+#include "Hash/CityHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#define DMP_DEBUG_CHANNEL "Parser"
+
+namespace
+{
+	struct FDreamLyricCacheHeader
+	{
+		uint32 Magic = FDreamLyricCache::Magic;
+		uint32 Version = FDreamLyricCache::Version;
+		FDateTime SourceTimestamp;
+		int64 SourceSize = 0;
+		uint64 SourceHash = 0;
+		uint8 FileType = 0;
+		uint8 LineType = 0;
+		uint8 LrcLyricType = 0;
+		uint8 ResolvedLrcLyricType = 0;
+		uint8 bSynthesizeWordTimings = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FDreamLyricCacheHeader& Header)
+		{
+			Ar << Header.Magic;
+			Ar << Header.Version;
+
+			// 版本不同时不再读取后续字段
+			if (Ar.IsLoading() && (Header.Magic != FDreamLyricCache::Magic || Header.Version != FDreamLyricCache::Version))
+			{
+				return Ar;
+			}
+
+			Ar << Header.SourceTimestamp;
+			Ar << Header.SourceSize;
+			Ar << Header.SourceHash;
+			Ar << Header.FileType;
+			Ar << Header.LineType;
+			Ar << Header.LrcLyricType;
+			Ar << Header.ResolvedLrcLyricType;
+			Ar << Header.bSynthesizeWordTimings;
+			return Ar;
+		}
+	};
+
+	bool IsHeaderMatching(const FDreamLyricCacheHeader& Header, const FDreamLyricCacheKey& Key)
+	{
+		if (Header.Magic != FDreamLyricCache::Magic || Header.Version != FDreamLyricCache::Version)
+		{
+			return false;
+		}
+
+		if (Header.FileType != static_cast<uint8>(Key.FileType) ||
+			Header.LineType != static_cast<uint8>(Key.LineType) ||
+			Header.LrcLyricType != static_cast<uint8>(Key.LrcLyricType) ||
+			Header.bSynthesizeWordTimings != static_cast<uint8>(Key.bSynthesizeWordTimings))
+		{
+			return false;
+		}
+
+		if (Header.SourceTimestamp == Key.SourceTimestamp && Header.SourceSize == Key.SourceSize)
+		{
+			return true;
+		}
+
+		// 修改时间变化 (例如重新检出) 但内容未变
+		return Key.SourceHash != 0 && Header.SourceHash == Key.SourceHash;
+	}
+
+	bool ReadCache(FArchive& Ar, const FDreamLyricCacheKey& Key, FDreamLyricCacheData& OutData)
+	{
+		FDreamLyricCacheHeader Header;
+		Ar << Header;
+
+		if (Ar.IsError() || !IsHeaderMatching(Header, Key))
+		{
+			return false;
+		}
+
+		TMap<FString, FString> MetaData;
+		Ar << MetaData;
+
+		FDreamLyricTrack Track;
+		Track.Serialize(Ar);
+
+		if (Ar.IsError())
+		{
+			return false;
+		}
+
+		OutData.Track = MakeShared<const FDreamLyricTrack>(MoveTemp(Track));
+		OutData.MetaData = MoveTemp(MetaData);
+		OutData.ResolvedLrcLyricType = static_cast<EDreamMusicPlayerLrcLyricType>(Header.ResolvedLrcLyricType);
+		return true;
+	}
+
+	// 正在解析的源文件, 以缓存文件路径为键
+	struct FInFlightSource
+	{
+		FCriticalSection Mutex;
+		int32 NumUsers = 0;
+	};
+
+	FCriticalSection& GetInFlightLock()
+	{
+		static FCriticalSection InFlightLock;
+		return InFlightLock;
+	}
+
+	TMap<FString, TSharedRef<FInFlightSource>>& GetInFlightSources()
+	{
+		static TMap<FString, TSharedRef<FInFlightSource>> InFlightSources;
+		return InFlightSources;
+	}
+}
+
+FString FDreamLyricCache::GetCacheFilePath(const FString& SourceFilePath)
+{
+	const FString FullPath = FPaths::ConvertRelativePathToFull(SourceFilePath);
+	const uint64 PathHash = CityHash64(reinterpret_cast<const char*>(*FullPath), FullPath.Len() * sizeof(TCHAR));
+
+	return FPaths::ProjectSavedDir() / TEXT("DreamMusicPlayer") / TEXT("LyricCache")
+		/ FString::Printf(TEXT("%s_%016llx%s"), *FPaths::GetBaseFilename(SourceFilePath), PathHash, Extension);
+}
+
+bool FDreamLyricCache::Load(const FString& SourceFilePath, const FDreamLyricCacheKey& Key, FDreamLyricCacheData& OutData)
+{
+	const FString CacheFilePath = GetCacheFilePath(SourceFilePath);
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	bool bLoaded = false;
+	TUniquePtr<IMappedFileHandle> MappedHandle(PlatformFile.OpenMapped(*CacheFilePath));
+	if (MappedHandle.IsValid() && MappedHandle->GetFileSize() > 0)
+	{
+		TUniquePtr<IMappedFileRegion> MappedRegion(MappedHandle->MapRegion(0, MappedHandle->GetFileSize()));
+		if (MappedRegion.IsValid())
+		{
+			FMemoryReaderView Reader(MakeArrayView(MappedRegion->GetMappedPtr(), static_cast<int32>(MappedRegion->GetMappedSize())));
+			bLoaded = ReadCache(Reader, Key, OutData);
+		}
+	}
+	else if (PlatformFile.FileExists(*CacheFilePath))
+	{
+		// 平台不支持内存映射
+		TArray<uint8> CacheBytes;
+		if (FFileHelper::LoadFileToArray(CacheBytes, *CacheFilePath, FILEREAD_Silent))
+		{
+			FMemoryReader Reader(CacheBytes);
+			bLoaded = ReadCache(Reader, Key, OutData);
+		}
+	}
+
+	DMP_LOG_DEBUG_PARSER(Log, TEXT("Lyric Cache %s : %s"), bLoaded ? TEXT("Hit") : TEXT("Miss"), *CacheFilePath);
+	return bLoaded;
+}
+
+bool FDreamLyricCache::Save(const FString& SourceFilePath, const FDreamLyricCacheKey& Key, const FDreamLyricCacheData& Data)
+{
+	if (!Data.Track.IsValid())
+	{
+		return false;
+	}
+
+	FDreamLyricCacheHeader Header;
+	Header.SourceTimestamp = Key.SourceTimestamp;
+	Header.SourceSize = Key.SourceSize;
+	Header.SourceHash = Key.SourceHash;
+	Header.FileType = static_cast<uint8>(Key.FileType);
+	Header.LineType = static_cast<uint8>(Key.LineType);
+	Header.LrcLyricType = static_cast<uint8>(Key.LrcLyricType);
+	Header.ResolvedLrcLyricType = static_cast<uint8>(Data.ResolvedLrcLyricType);
+	Header.bSynthesizeWordTimings = static_cast<uint8>(Key.bSynthesizeWordTimings);
+
+	TArray<uint8> CacheBytes;
+	FMemoryWriter Writer(CacheBytes);
+	Writer << Header;
+	Writer << const_cast<TMap<FString, FString>&>(Data.MetaData);
+	const_cast<FDreamLyricTrack&>(*Data.Track).Serialize(Writer);
+
+	// 先写完整的临时文件再替换, 其它线程不会映射到写了一半的缓存
+	const FString CacheFilePath = GetCacheFilePath(SourceFilePath);
+	const FString TempFilePath = FString::Printf(TEXT("%s.%s.tmp"), *CacheFilePath, *FGuid::NewGuid().ToString(EGuidFormats::Digits));
+	if (!FFileHelper::SaveArrayToFile(CacheBytes, *TempFilePath))
+	{
+		DMP_LOG(Warning, TEXT("Failed to write lyric cache: %s"), *TempFilePath);
+		return false;
+	}
+
+	if (!IFileManager::Get().Move(*CacheFilePath, *TempFilePath, true, true, false, true))
+	{
+		IFileManager::Get().Delete(*TempFilePath, false, true, true);
+		DMP_LOG(Warning, TEXT("Failed to replace lyric cache: %s"), *CacheFilePath);
+		return false;
+	}
+
+	DMP_LOG_DEBUG_PARSER(Log, TEXT("Lyric Cache Saved : %s (%d bytes)"), *CacheFilePath, CacheBytes.Num());
+	return true;
+}
+
+FDreamLyricCache::FScopedSourceLock::FScopedSourceLock(const FString& SourceFilePath)
+	: CacheFilePath(GetCacheFilePath(SourceFilePath))
+{
+	TSharedPtr<FInFlightSource> Source;
+	{
+		FScopeLock Lock(&GetInFlightLock());
+		TSharedRef<FInFlightSource>& Entry = GetInFlightSources().FindOrAdd(CacheFilePath, MakeShared<FInFlightSource>());
+		bContended = Entry->NumUsers++ > 0;
+		Source = Entry;
+	}
+
+	// 在映射锁之外等待, 不阻塞其它文件
+	Source->Mutex.Lock();
+}
+
+FDreamLyricCache::FScopedSourceLock::~FScopedSourceLock()
+{
+	FScopeLock Lock(&GetInFlightLock());
+	TSharedRef<FInFlightSource> Source = GetInFlightSources().FindChecked(CacheFilePath);
+	Source->Mutex.Unlock();
+
+	if (--Source->NumUsers == 0)
+	{
+		GetInFlightSources().Remove(CacheFilePath);
+	}
+}
+
+#undef DMP_DEBUG_CHANNEL
@@ -1,6 +1,7 @@
 ﻿#include "LyricParser/DreamLyricGroupProcessor.h"
+#include "LyricParser/DreamLyricTimestampScanner.h"
 
-void FDreamLyricGroupProcessor::ProcessGroup(const TArray<FString>& LinesInGroup, FDreamMusicLyric& OutLyric)
+void FDreamLyricGroupProcessor::ProcessGroup(TConstArrayView<FStringView> LinesInGroup, FDreamMusicLyric& OutLyric)
 {
 	if (LinesInGroup.Num() == 0)
 		return;
@@ -16,78 +17,33 @@ void FDreamLyricGroupProcessor::ProcessGroup(const TArray<FString>& LinesInGroup
 	else if (ActualLines == 2 && ExpectedLines == 3)
 	{
 		// Fallback to 2-line mode: first line = lyrics, second line = translation
-		ProcessLineToField(OutLyric, LinesInGroup[0], TEXT("Content"));
-		ProcessLineToField(OutLyric, LinesInGroup[1], TEXT("Translate"));
+		ProcessLineToField(OutLyric, LinesInGroup[0], EDreamLyricField::Content);
+		ProcessLineToField(OutLyric, LinesInGroup[1], EDreamLyricField::Translate);
 	}
 	else if (ActualLines == 1)
 	{
 		// Fallback to 1-line mode: only lyrics, no translation
-		ProcessLineToField(OutLyric, LinesInGroup[0], TEXT("Content"));
+		ProcessLineToField(OutLyric, LinesInGroup[0], EDreamLyricField::Content);
 	}
 }
 
 int32 FDreamLyricGroupProcessor::GetExpectedLineCount() const
 {
-	switch (LineType)
-	{
-	case EDreamMusicPlayerLyricParseLineType::Romanization_Lyric_Translation:
-	case EDreamMusicPlayerLyricParseLineType::Lyric_Romanization_Translation:
-	case EDreamMusicPlayerLyricParseLineType::Translation_Lyric_Romanization:
-		return 3;
-	case EDreamMusicPlayerLyricParseLineType::Romanization_Lyric:
-	case EDreamMusicPlayerLyricParseLineType::Lyric_Romanization:
-	case EDreamMusicPlayerLyricParseLineType::Translation_Lyric:
-	case EDreamMusicPlayerLyricParseLineType::Lyric_Translation:
-		return 2;
-	case EDreamMusicPlayerLyricParseLineType::Lyric_Only:
-	default:
-		return 1;
-	}
+	return FDreamLyricLineLayouts::Get(LineType).NumLines;
 }
 
-void FDreamLyricGroupProcessor::AssignContentByLineType(FDreamMusicLyric& Lyric, const TArray<FString>& LinesInGroup, int32 ExpectedLines)
+void FDreamLyricGroupProcessor::AssignContentByLineType(FDreamMusicLyric& Lyric, TConstArrayView<FStringView> LinesInGroup, int32 ExpectedLines)
 {
-	switch (LineType)
+	const FDreamLyricLineLayout& Layout = FDreamLyricLineLayouts::Get(LineType);
+	const int32 NumLines = FMath::Min3(LinesInGroup.Num(), ExpectedLines, Layout.NumLines);
+
+	for (int32 i = 0; i < NumLines; i++)
 	{
-	case EDreamMusicPlayerLyricParseLineType::Romanization_Lyric_Translation:
-		if (LinesInGroup.Num() >= 1) ProcessLineToField(Lyric, LinesInGroup[0], TEXT("Romanization"));
-		if (LinesInGroup.Num() >= 2) ProcessLineToField(Lyric, LinesInGroup[1], TEXT("Content"));
-		if (LinesInGroup.Num() >= 3) ProcessLineToField(Lyric, LinesInGroup[2], TEXT("Translate"));
-		break;
-	case EDreamMusicPlayerLyricParseLineType::Lyric_Romanization_Translation:
-		if (LinesInGroup.Num() >= 1) ProcessLineToField(Lyric, LinesInGroup[0], TEXT("Content"));
-		if (LinesInGroup.Num() >= 2) ProcessLineToField(Lyric, LinesInGroup[1], TEXT("Romanization"));
-		if (LinesInGroup.Num() >= 3) ProcessLineToField(Lyric, LinesInGroup[2], TEXT("Translate"));
-		break;
-	case EDreamMusicPlayerLyricParseLineType::Translation_Lyric_Romanization:
-		if (LinesInGroup.Num() >= 1) ProcessLineToField(Lyric, LinesInGroup[0], TEXT("Translate"));
-		if (LinesInGroup.Num() >= 2) ProcessLineToField(Lyric, LinesInGroup[1], TEXT("Content"));
-		if (LinesInGroup.Num() >= 3) ProcessLineToField(Lyric, LinesInGroup[2], TEXT("Romanization"));
-		break;
-	case EDreamMusicPlayerLyricParseLineType::Romanization_Lyric:
-		if (LinesInGroup.Num() >= 1) ProcessLineToField(Lyric, LinesInGroup[0], TEXT("Romanization"));
-		if (LinesInGroup.Num() >= 2) ProcessLineToField(Lyric, LinesInGroup[1], TEXT("Content"));
-		break;
-	case EDreamMusicPlayerLyricParseLineType::Lyric_Romanization:
-		if (LinesInGroup.Num() >= 1) ProcessLineToField(Lyric, LinesInGroup[0], TEXT("Content"));
-		if (LinesInGroup.Num() >= 2) ProcessLineToField(Lyric, LinesInGroup[1], TEXT("Romanization"));
-		break;
-	case EDreamMusicPlayerLyricParseLineType::Translation_Lyric:
-		if (LinesInGroup.Num() >= 1) ProcessLineToField(Lyric, LinesInGroup[0], TEXT("Translate"));
-		if (LinesInGroup.Num() >= 2) ProcessLineToField(Lyric, LinesInGroup[1], TEXT("Content"));
-		break;
-	case EDreamMusicPlayerLyricParseLineType::Lyric_Translation:
-		if (LinesInGroup.Num() >= 1) ProcessLineToField(Lyric, LinesInGroup[0], TEXT("Content"));
-		if (LinesInGroup.Num() >= 2) ProcessLineToField(Lyric, LinesInGroup[1], TEXT("Translate"));
-		break;
-	case EDreamMusicPlayerLyricParseLineType::Lyric_Only:
-	default:
-		if (LinesInGroup.Num() >= 1) ProcessLineToField(Lyric, LinesInGroup[0], TEXT("Content"));
-		break;
+		ProcessLineToField(Lyric, LinesInGroup[i], Layout.Fields[i]);
 	}
 }
 
-void FDreamLyricGroupProcessor::ProcessLineToField(FDreamMusicLyric& Lyric, const FString& Line, const FString& TargetField)
+void FDreamLyricGroupProcessor::ProcessLineToField(FDreamMusicLyric& Lyric, FStringView Line, EDreamLyricField TargetField)
 {
 	switch (ParseMethod)
 	{
@@ -104,12 +60,9 @@ void FDreamLyricGroupProcessor::ProcessLineToField(FDreamMusicLyric& Lyric, cons
 	}
 }
 
-void FDreamLyricGroupProcessor::ProcessWordByWordToField(FDreamMusicLyric& Lyric, const FString& Line, const FString& TargetField)
+void FDreamLyricGroupProcessor::ProcessWordByWordToField(FDreamMusicLyric& Lyric, FStringView Line, EDreamLyricField TargetField)
 {
-	TArray<FDreamMusicLyricTimestamp> Timestamps;
-	TArray<FString> Contents;
-
-	if (!ExtractTimestampContentPairs(Line, Timestamps, Contents, TEXT("\\[(\\d{2}):(\\d{2})[.:](\\d{2,3})\\]([^\\[]*)")))
+	if (!ExtractTimestampContentPairs(Line, ScratchTimestamps, ScratchContents, TEXT('['), TEXT(']')))
 	{
 		ProcessLineByLineToField(Lyric, Line, TargetField);
 		return;
@@ -117,118 +70,92 @@ void FDreamLyricGroupProcessor::ProcessWordByWordToField(FDreamMusicLyric& Lyric
 
 	TArray<FDreamMusicLyricWord> Words;
 	// Use the new word-segment based approach instead of character-by-character
-	FString FullContent = BuildWordTimingsFromSegments(Timestamps, Contents, Words);
-	AssignToField(Lyric, FullContent, Words, TargetField);
+	FString FullContent = BuildWordTimingsFromSegments(ScratchTimestamps, ScratchContents, Words);
+	AssignToField(Lyric, MoveTemp(FullContent), MoveTemp(Words), TargetField);
 }
 
-void FDreamLyricGroupProcessor::ProcessESLyricToField(FDreamMusicLyric& Lyric, const FString& Line, const FString& TargetField)
+void FDreamLyricGroupProcessor::ProcessESLyricToField(FDreamMusicLyric& Lyric, FStringView Line, EDreamLyricField TargetField)
 {
-	TArray<FDreamMusicLyricTimestamp> Timestamps;
-	TArray<FString> Contents;
-
-	if (!ExtractTimestampContentPairs(Line, Timestamps, Contents, TEXT("<(\\d{2}):(\\d{2})[.:](\\d{2,3})>([^<]*)")))
+	if (!ExtractTimestampContentPairs(Line, ScratchTimestamps, ScratchContents, TEXT('<'), TEXT('>')))
 	{
 		ProcessLineByLineToField(Lyric, Line, TargetField);
 		return;
 	}
 
 	TArray<FDreamMusicLyricWord> Words;
-	FString FullContent = BuildWordTimingsFromSegments(Timestamps, Contents, Words);
-	AssignToField(Lyric, FullContent, Words, TargetField);
+	FString FullContent = BuildWordTimingsFromSegments(ScratchTimestamps, ScratchContents, Words);
+	AssignToField(Lyric, MoveTemp(FullContent), MoveTemp(Words), TargetField);
 }
 
-void FDreamLyricGroupProcessor::ProcessLineByLineToField(FDreamMusicLyric& Lyric, const FString& Line, const FString& TargetField)
+void FDreamLyricGroupProcessor::ProcessLineByLineToField(FDreamMusicLyric& Lyric, FStringView Line, EDreamLyricField TargetField)
 {
-	FString ExtractedContent = ExtractContentFromLine(Line);
-	TArray<FDreamMusicLyricWord> EmptyWords; // No word timings for LineByLine mode
-	AssignToField(Lyric, ExtractedContent, EmptyWords, TargetField);
+	// No word timings for LineByLine mode
+	AssignToField(Lyric, ExtractContentFromLine(Line), TArray<FDreamMusicLyricWord>(), TargetField);
 }
 
-bool FDreamLyricGroupProcessor::ExtractTimestampContentPairs(const FString& Line, TArray<FDreamMusicLyricTimestamp>& OutTimestamps, TArray<FString>& OutContents, const FString& RegexPattern)
+bool FDreamLyricGroupProcessor::ExtractTimestampContentPairs(FStringView Line, TArray<FDreamLyricTime>& OutTimestamps, TArray<FStringView>& OutContents, TCHAR OpenTag, TCHAR CloseTag)
 {
-	FRegexPattern Pattern(RegexPattern);
-	FRegexMatcher Matcher(Pattern, Line);
-
-	OutTimestamps.Empty();
-	OutContents.Empty();
+	OutTimestamps.Reset();
+	OutContents.Reset();
 
-	while (Matcher.FindNext())
+	FDreamLyricTimestampScanner::ForEachTaggedSegment(Line, OpenTag, CloseTag, [&OutTimestamps, &OutContents](FDreamLyricTime Time, FStringView Content)
 	{
-		int32 Minutes = FCString::Atoi(*Matcher.GetCaptureGroup(1));
-		int32 Seconds = FCString::Atoi(*Matcher.GetCaptureGroup(2));
-		FString MillisecondsStr = Matcher.GetCaptureGroup(3);
-		FString WordContent = Matcher.GetCaptureGroup(4);
-
-		int32 Milliseconds = (MillisecondsStr.Len() == 2) ? FCString::Atoi(*MillisecondsStr) * 10 : FCString::Atoi(*MillisecondsStr);
-		FDreamMusicLyricTimestamp Timestamp(Minutes, Seconds, Milliseconds);
-
-		OutTimestamps.Add(Timestamp);
-		OutContents.Add(WordContent);
-	}
+		OutTimestamps.Add(Time);
+		OutContents.Add(Content);
+	});
 
 	return OutTimestamps.Num() > 0;
 }
 
 // NEW METHOD: Build word timings from word segments (similar to ASS parsing)
-FString FDreamLyricGroupProcessor::BuildWordTimingsFromSegments(const TArray<FDreamMusicLyricTimestamp>& Timestamps, const TArray<FString>& Contents, TArray<FDreamMusicLyricWord>& OutWords)
+FString FDreamLyricGroupProcessor::BuildWordTimingsFromSegments(const TArray<FDreamLyricTime>& Timestamps, const TArray<FStringView>& Contents, TArray<FDreamMusicLyricWord>& OutWords)
 {
 	OutWords.Empty();
 	FString FullContent;
 
 	for (int32 i = 0; i < Timestamps.Num() && i < Contents.Num(); i++)
 	{
-		FDreamMusicLyricTimestamp StartTimestamp = Timestamps[i];
-		FString WordContent = Contents[i];
+		FDreamLyricTime StartTimestamp = Timestamps[i];
+		const FStringView WordContent = Contents[i];
 
 		// Skip empty content
 		if (WordContent.IsEmpty())
 			continue;
 
 		// Calculate end timestamp for this word segment
-		FDreamMusicLyricTimestamp EndTimestamp;
-		if (i + 1 < Timestamps.Num())
-		{
-			// Use next timestamp as end time
-			EndTimestamp = Timestamps[i + 1];
-		}
-		else
-		{
-			// For last segment, add default duration (500ms)
-			int32 EndMs = StartTimestamp.ToMilliseconds() + 500;
-			EndTimestamp = CreateTimestampFromMs(EndMs);
-		}
+		// Use next timestamp as end time, for last segment add default duration (500ms)
+		FDreamLyricTime EndTimestamp = (i + 1 < Timestamps.Num()) ? Timestamps[i + 1] : StartTimestamp + 500;
 
 		// Create word entry for the entire segment content
 		// This preserves the complete word/phrase from each timestamp segment
-		FDreamMusicLyricWord Word(StartTimestamp, EndTimestamp, WordContent);
-		OutWords.Add(Word);
-		FullContent += WordContent;
+		OutWords.Emplace(FDreamMusicLyricTimestamp(StartTimestamp), FDreamMusicLyricTimestamp(EndTimestamp), FString(WordContent));
+		FullContent.Append(WordContent.GetData(), WordContent.Len());
 	}
 
 	return FullContent;
 }
 
 // DEPRECATED: Old character-by-character method (keeping for compatibility)
-FString FDreamLyricGroupProcessor::BuildWordsFromTimestamps(const TArray<FDreamMusicLyricTimestamp>& Timestamps, const TArray<FString>& Contents, TArray<FDreamMusicLyricWord>& OutWords)
+FString FDreamLyricGroupProcessor::BuildWordsFromTimestamps(const TArray<FDreamLyricTime>& Timestamps, const TArray<FStringView>& Contents, TArray<FDreamMusicLyricWord>& OutWords)
 {
 	OutWords.Empty();
 	FString FullContent;
 
 	for (int32 i = 0; i < Timestamps.Num(); i++)
 	{
-		FDreamMusicLyricTimestamp CurrentTimestamp = Timestamps[i];
-		FString WordContent = Contents[i];
+		FDreamLyricTime CurrentTimestamp = Timestamps[i];
+		const FStringView WordContent = Contents[i];
 
 		// Process each character in the content (old behavior)
 		for (int32 CharIndex = 0; CharIndex < WordContent.Len(); CharIndex++)
 		{
-			FString Char = WordContent.Mid(CharIndex, 1);
+			FString Char(WordContent.Mid(CharIndex, 1));
 
 			// Calculate end timestamp for this character
-			FDreamMusicLyricTimestamp EndTimestamp = CalculateEndTimestamp(CurrentTimestamp, CharIndex, WordContent, i, Timestamps);
+			FDreamLyricTime EndTimestamp = CalculateEndTimestamp(CurrentTimestamp, CharIndex, WordContent, i, Timestamps);
 
 			// Create word entry for character
-			FDreamMusicLyricWord Word(CurrentTimestamp, EndTimestamp, Char);
+			FDreamMusicLyricWord Word(FDreamMusicLyricTimestamp(CurrentTimestamp), FDreamMusicLyricTimestamp(EndTimestamp), Char);
 			OutWords.Add(Word);
 			FullContent += Char;
 
@@ -243,7 +170,7 @@ FString FDreamLyricGroupProcessor::BuildWordsFromTimestamps(const TArray<FDreamM
 	return FullContent;
 }
 
-FDreamMusicLyricTimestamp FDreamLyricGroupProcessor::CalculateEndTimestamp(const FDreamMusicLyricTimestamp& StartTimestamp, int32 CharIndex, const FString& WordContent, int32 SegmentIndex, const TArray<FDreamMusicLyricTimestamp>& AllTimestamps)
+FDreamLyricTime FDreamLyricGroupProcessor::CalculateEndTimestamp(FDreamLyricTime StartTimestamp, int32 CharIndex, FStringView WordContent, int32 SegmentIndex, const TArray<FDreamLyricTime>& AllTimestamps)
 {
 	// If this is the last character in this content segment
 	if (CharIndex == WordContent.Len() - 1)
@@ -256,7 +183,7 @@ FDreamMusicLyricTimestamp FDreamLyricGroupProcessor::CalculateEndTimestamp(const
 		else
 		{
 			// Default duration for last character
-			return CreateTimestampFromMs(StartTimestamp.ToMilliseconds() + 500);
+			return StartTimestamp + 500;
 		}
 	}
 	else
@@ -265,7 +192,7 @@ FDreamMusicLyricTimestamp FDreamLyricGroupProcessor::CalculateEndTimestamp(const
 		int32 CharDuration = 200; // Default 200ms per character
 		if (SegmentIndex + 1 < AllTimestamps.Num())
 		{
-			int32 TotalDuration = AllTimestamps[SegmentIndex + 1].ToMilliseconds() - StartTimestamp.ToMilliseconds();
+			int32 TotalDuration = AllTimestamps[SegmentIndex + 1] - StartTimestamp;
 			int32 RemainingChars = WordContent.Len() - CharIndex;
 			if (RemainingChars > 0)
 			{
@@ -273,48 +200,52 @@ FDreamMusicLyricTimestamp FDreamLyricGroupProcessor::CalculateEndTimestamp(const
 			}
 		}
 
-		return CreateTimestampFromMs(StartTimestamp.ToMilliseconds() + CharDuration);
+		return StartTimestamp + CharDuration;
 	}
 }
 
-FDreamMusicLyricTimestamp FDreamLyricGroupProcessor::CreateTimestampFromMs(int32 TotalMs)
+FDreamMusicLyricTimestamp FDreamLyricGroupProcessor::CreateTimestampFromMs(int32 TotalMs) const
 {
-	return FDreamMusicLyricTimestamp(
-		TotalMs / 3600000,
-		(TotalMs / 60000) % 60,
-		(TotalMs / 1000) % 60,
-		TotalMs % 1000
-	);
+	return FDreamMusicLyricTimestamp::FromMilliseconds(TotalMs);
 }
 
-void FDreamLyricGroupProcessor::AssignToField(FDreamMusicLyric& Lyric, const FString& Content, const TArray<FDreamMusicLyricWord>& Words, const FString& TargetField)
+void FDreamLyricGroupProcessor::AssignToField(FDreamMusicLyric& Lyric, FString&& Content, TArray<FDreamMusicLyricWord>&& Words, EDreamLyricField TargetField)
 {
-	if (TargetField == TEXT("Content"))
-	{
-		Lyric.Content = Content;
-		Lyric.WordTimings = Words;
-	}
-	else if (TargetField == TEXT("Romanization"))
-	{
-		Lyric.Romanization = Content;
-		Lyric.RomanizationWordTimings = Words;
-	}
-	else if (TargetField == TEXT("Translate"))
+	switch (TargetField)
 	{
-		Lyric.Translate = Content;
+	case EDreamLyricField::Content:
+		Lyric.Content = MoveTemp(Content);
+		Lyric.WordTimings = MoveTemp(Words);
+		break;
+	case EDreamLyricField::Romanization:
+		Lyric.Romanization = MoveTemp(Content);
+		Lyric.RomanizationWordTimings = MoveTemp(Words);
+		break;
+	case EDreamLyricField::Translate:
 		// Translation typically doesn't need word-by-word timing, so we don't assign Words
+		Lyric.Translate = MoveTemp(Content);
+		break;
 	}
 }
 
-FString FDreamLyricGroupProcessor::ExtractContentFromLine(const FString& Line)
+FString FDreamLyricGroupProcessor::ExtractContentFromLine(FStringView Line)
 {
-	FRegexPattern Pattern(TEXT("\\[(\\d{2}):(\\d{2})[.:](\\d{2,3})\\](.*)"));
-	FRegexMatcher Matcher(Pattern, Line);
+	FDreamLyricTime Time;
 
-	if (Matcher.FindNext())
+	// LRC 解析器传入的行以时间标签开头, 无需再次搜索
+	const int32 LeadingTagLength = FDreamLyricTimestampScanner::ScanTag(Line, TEXT('['), TEXT(']'), Time);
+	if (LeadingTagLength > 0)
 	{
-		return Matcher.GetCaptureGroup(4);
+		return FString(Line.RightChop(LeadingTagLength));
+	}
+
+	int32 TagStart = 0;
+	int32 TagLength = 0;
+
+	if (FDreamLyricTimestampScanner::FindTag(Line, TEXT('['), TEXT(']'), Time, TagStart, TagLength))
+	{
+		return FString(Line.RightChop(TagStart + TagLength));
 	}
 
 	return FString();
-}
\ No newline at end of file
+}
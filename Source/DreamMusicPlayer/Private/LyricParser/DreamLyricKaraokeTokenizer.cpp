@@ -0,0 +1,163 @@
+﻿#include "LyricParser/DreamLyricKaraokeTokenizer.h"
+
+namespace
+{
+	/**
+	 * Walk one override block (without braces) and report the duration of every karaoke tag in order
+	 */
+	template <typename CallbackType>
+	void ForEachKaraokeTag(FStringView Block, CallbackType&& Callback)
+	{
+		const TCHAR* Data = Block.GetData();
+		const int32 Len = Block.Len();
+		int32 ParenDepth = 0;
+
+		for (int32 Index = 0; Index < Len; Index++)
+		{
+			const TCHAR Char = Data[Index];
+
+			// \t(...) \clip(...) \pos(x,y) 等参数整体跳过
+			if (Char == TEXT('('))
+			{
+				ParenDepth++;
+				continue;
+			}
+			if (Char == TEXT(')'))
+			{
+				ParenDepth = FMath::Max(0, ParenDepth - 1);
+				continue;
+			}
+			if (ParenDepth > 0 || Char != TEXT('\\'))
+			{
+				continue;
+			}
+
+			int32 Cursor = Index + 1;
+			if (Cursor >= Len || (Data[Cursor] != TEXT('k') && Data[Cursor] != TEXT('K')))
+			{
+				continue;
+			}
+			Cursor++;
+
+			if (Cursor < Len && (Data[Cursor] == TEXT('f') || Data[Cursor] == TEXT('o')))
+			{
+				Cursor++;
+			}
+
+			if (Cursor >= Len || !FChar::IsDigit(Data[Cursor]))
+			{
+				// \kt 等不是卡拉OK时长标签
+				continue;
+			}
+
+			int32 Duration = 0;
+			while (Cursor < Len && FChar::IsDigit(Data[Cursor]))
+			{
+				Duration = Duration * 10 + (Data[Cursor] - TEXT('0'));
+				Cursor++;
+			}
+
+			Callback(Duration);
+			Index = Cursor - 1;
+		}
+	}
+}
+
+namespace FDreamLyricKaraokeTokenizer
+{
+	int32 Tokenize(FStringView Text, FString& OutCleanText, TArray<FDreamLyricKaraokeSpan>& OutSpans)
+	{
+		const TCHAR* Data = Text.GetData();
+		const int32 Len = Text.Len();
+
+		const int32 FirstSpan = OutSpans.Num();
+		int32 ElapsedCentiseconds = 0;
+
+		// 当前音节, 遇到下一个卡拉OK标签或文本结束时才写入 OutSpans
+		FDreamLyricKaraokeSpan OpenSpan;
+		bool bHasOpenSpan = false;
+
+		OutCleanText.Reserve(OutCleanText.Len() + Len);
+
+		auto CloseOpenSpan = [&OutCleanText, &OutSpans, &OpenSpan, &bHasOpenSpan]()
+		{
+			if (!bHasOpenSpan)
+			{
+				return;
+			}
+
+			OpenSpan.TextLength = OutCleanText.Len() - OpenSpan.TextOffset;
+			if (OpenSpan.TextLength > 0)
+			{
+				OutSpans.Add(OpenSpan);
+			}
+			bHasOpenSpan = false;
+		};
+
+		int32 Index = 0;
+		while (Index < Len)
+		{
+			const TCHAR Char = Data[Index];
+
+			if (Char == TEXT('{'))
+			{
+				int32 CloseIndex = Index + 1;
+				while (CloseIndex < Len && Data[CloseIndex] != TEXT('}'))
+				{
+					CloseIndex++;
+				}
+
+				// 未闭合的 { 按普通文本处理
+				if (CloseIndex >= Len)
+				{
+					OutCleanText.Append(Data + Index, Len - Index);
+					break;
+				}
+
+				ForEachKaraokeTag(FStringView(Data + Index + 1, CloseIndex - Index - 1), [&](int32 DurationCentiseconds)
+				{
+					CloseOpenSpan();
+
+					OpenSpan.TextOffset = OutCleanText.Len();
+					OpenSpan.StartCentiseconds = ElapsedCentiseconds;
+					OpenSpan.EndCentiseconds = ElapsedCentiseconds + DurationCentiseconds;
+					ElapsedCentiseconds = OpenSpan.EndCentiseconds;
+					bHasOpenSpan = true;
+				});
+
+				Index = CloseIndex + 1;
+				continue;
+			}
+
+			if (Char == TEXT('\\') && Index + 1 < Len)
+			{
+				const TCHAR Escape = Data[Index + 1];
+				if (Escape == TEXT('N') || Escape == TEXT('n'))
+				{
+					OutCleanText.AppendChar(TEXT('\n'));
+					Index += 2;
+					continue;
+				}
+				if (Escape == TEXT('h'))
+				{
+					OutCleanText.AppendChar(TEXT(' '));
+					Index += 2;
+					continue;
+				}
+			}
+
+			// 普通文本整段追加
+			int32 RunEnd = Index + 1;
+			while (RunEnd < Len && Data[RunEnd] != TEXT('{') && Data[RunEnd] != TEXT('\\'))
+			{
+				RunEnd++;
+			}
+			OutCleanText.Append(Data + Index, RunEnd - Index);
+			Index = RunEnd;
+		}
+
+		CloseOpenSpan();
+
+		return OutSpans.Num() - FirstSpan;
+	}
+}
@@ -1,13 +1,22 @@
 ﻿#include "LyricParser/DreamLyricParser.h"
 #include "LyricParser/DreamMusicPlayerLyricFileParser.h"
 #include "LyricParser/DreamMusicPlayerLyricTools.h"
+#include "LyricParser/DreamLyricCache.h"
+#include "LyricParser/DreamLyricTrack.h"
+#include "LyricParser/DreamLyricStats.h"
+#include "LyricParser/DreamLyricTimingSynthesizer.h"
 #include "DreamMusicPlayerDebugLog.h"
+#include "Algo/StableSort.h"
+#include "Async/MappedFileHandle.h"
+#include "Hash/CityHash.h"
+#include "String/ParseLines.h"
 
 #define DMP_DEBUG_CHANNEL "Parser"
 
-FDreamLyricParser::FDreamLyricParser(FString InFilePath, EDreamMusicPlayerLyricParseFileType InFileType, EDreamMusicPlayerLyricParseLineType InLineType, EDreamMusicPlayerLrcLyricType InLrcParseMethod)
+FDreamLyricParser::FDreamLyricParser(FString InFilePath, EDreamMusicPlayerLyricParseFileType InFileType, EDreamMusicPlayerLyricParseLineType InLineType, EDreamMusicPlayerLrcLyricType InLrcParseMethod, bool bInAllowCache)
 {
 	FilePath = InFilePath;
+	bAllowCache = bInAllowCache;
 	FileType = InFileType;
 	LineType = InLineType;
 	LrcParseMethod = InLrcParseMethod;
@@ -22,28 +31,61 @@ FDreamLyricParser::FDreamLyricParser(FString InFilePath, EDreamMusicPlayerLyricP
 
 void FDreamLyricParser::BeginDecodeFile()
 {
+	LLM_SCOPE_BYTAG(DreamMusicPlayer_Lyrics);
+
 	// Clear previous data
 	ClearCachedLines();
 	ClearLyrics();
 	MetaData.Empty();
+	Track.Reset();
+	SourceHash = 0;
+	bLoadedFromCache = false;
 
-	// Check if file exists
-	if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*FilePath))
+	const FFileStatData SourceStat = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*FilePath);
+	if (!SourceStat.bIsValid || SourceStat.bIsDirectory)
 	{
 		UE_LOG(LogTemp, Error, TEXT("Lyric file not found: %s"), *FilePath);
 		return;
 	}
 
-	// Load file content
-	if (!FFileHelper::LoadFileToStringArray(CachedFileLines, *FilePath))
+	const bool bUseCache = bAllowCache && GetDefault<UDreamMusicPlayerSettings>()->bEnableLyricCache;
+
+	FDreamLyricCacheKey CacheKey;
+	CacheKey.SourceTimestamp = SourceStat.ModificationTime;
+	CacheKey.SourceSize = SourceStat.FileSize;
+	CacheKey.FileType = FileType;
+	CacheKey.LineType = LineType;
+	CacheKey.LrcLyricType = LrcParseMethod;
+	CacheKey.bSynthesizeWordTimings = FDreamLyricTimingSynthesizer::IsEnabled();
+
+	// 修改时间与大小一致, 直接使用缓存, 不读取源文件
+	if (bUseCache && TryLoadFromCache(CacheKey))
+	{
+		return;
+	}
+
+	// 同一文件只解析一次: 等待正在解析的调用方, 然后直接使用它写入的缓存
+	TOptional<FDreamLyricCache::FScopedSourceLock> SourceLock;
+	if (bUseCache)
+	{
+		SourceLock.Emplace(FilePath);
+		if (SourceLock->WasContended() && TryLoadFromCache(CacheKey))
+		{
+			return;
+		}
+	}
+
+	// Load file content (single read)
+	if (!LoadFileContent())
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to load lyric file: %s"), *FilePath);
 		return;
 	}
 
-	if (!FFileHelper::LoadFileToString(CachedFileContent, *FilePath))
+	// 修改时间变化但内容未变, 使用缓存并刷新缓存中的修改时间
+	CacheKey.SourceHash = SourceHash;
+	if (bUseCache && TryLoadFromCache(CacheKey))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to load lyric file: %s"), *FilePath);
+		SaveToCache(CacheKey);
 		return;
 	}
 
@@ -56,7 +98,24 @@ void FDreamLyricParser::BeginDecodeFile()
 	if (Parser.IsValid())
 	{
 		Parser->Parse();
-		Lyrics = Parser->GetParsedLyrics();
+		Lyrics = Parser->TakeParsedLyrics();
+
+		// 排序后轨道总是有序的, 源文件的顺序只能在这里取得
+		const FDreamLyricSourceOrder& SourceOrder = Parser->GetSourceOrder();
+		NumUnsortedSourceLines = SourceOrder.NumUnsortedLines;
+		FirstUnsortedSourceLine = SourceOrder.FirstUnsortedLine;
+		FirstUnsortedSourceTime = SourceOrder.FirstUnsortedTime;
+
+		// LRC 的类型与元数据在解析歌词行的同一次扫描中得到
+		if (FileType == EDreamMusicPlayerLyricParseFileType::LRC)
+		{
+			FDreamMusicPlayerLyricFileParser_LRC& LrcParser = static_cast<FDreamMusicPlayerLyricFileParser_LRC&>(*Parser);
+			LrcParseMethod = LrcParser.GetResolvedParseMethod();
+			MetaData = LrcParser.TakeMetaData();
+
+			DMP_LOG_DEBUG_PARSER(Log, TEXT("LRC type: %s, offset: %d ms, %d metadata tags"),
+				*UEnum::GetValueAsString(LrcParseMethod), LrcParser.GetOffsetMs(), MetaData.Num())
+		}
 
 		for (const FDreamMusicLyric& Lyric : Lyrics)
 		{
@@ -66,7 +125,17 @@ void FDreamLyricParser::BeginDecodeFile()
 		// Sort lyrics by timestamp
 		SortLyricsByTimestamp();
 
-		UE_LOG(LogTemp, Log, TEXT("Successfully parsed %d lyrics from file"), Lyrics.Num());
+		Track = MakeShared<const FDreamLyricTrack>(Lyrics);
+
+		if (bUseCache)
+		{
+			SaveToCache(CacheKey);
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Successfully parsed %d lyrics from file"), Track->NumLines());
+
+		// 轨道是唯一的结果, 歌词列表仅在 GetLyrics 时按需生成
+		Lyrics.Empty();
 	}
 	else
 	{
@@ -74,6 +143,75 @@ void FDreamLyricParser::BeginDecodeFile()
 	}
 }
 
+bool FDreamLyricParser::LoadFileContent()
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	// 优先使用内存映射, 避免额外的读取缓冲
+	bool bDecoded = false;
+	TUniquePtr<IMappedFileHandle> MappedHandle(PlatformFile.OpenMapped(*FilePath));
+	if (MappedHandle.IsValid() && MappedHandle->GetFileSize() > 0)
+	{
+		TUniquePtr<IMappedFileRegion> MappedRegion(MappedHandle->MapRegion(0, MappedHandle->GetFileSize()));
+		if (MappedRegion.IsValid())
+		{
+			SourceHash = CityHash64(reinterpret_cast<const char*>(MappedRegion->GetMappedPtr()), MappedRegion->GetMappedSize());
+			FFileHelper::BufferToString(CachedFileContent, MappedRegion->GetMappedPtr(), static_cast<int32>(MappedRegion->GetMappedSize()));
+			FDreamLyricStats::RecordFileRead(MappedRegion->GetMappedSize());
+			bDecoded = true;
+		}
+	}
+
+	// 平台不支持内存映射时退回到一次性读取
+	if (!bDecoded)
+	{
+		TArray<uint8> FileBytes;
+		if (!FFileHelper::LoadFileToArray(FileBytes, *FilePath, FILEREAD_Silent))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to load lyric file: %s"), *FilePath);
+			return false;
+		}
+
+		SourceHash = CityHash64(reinterpret_cast<const char*>(FileBytes.GetData()), FileBytes.Num());
+		FFileHelper::BufferToString(CachedFileContent, FileBytes.GetData(), FileBytes.Num());
+		FDreamLyricStats::RecordFileRead(FileBytes.Num());
+	}
+
+	// 行视图直接指向解码后的内容, 保留空行 (SRT 依赖空行分隔字幕块)
+	UE::String::ParseLines(CachedFileContent, [this](FStringView Line)
+	{
+		CachedFileLines.Add(Line);
+	});
+
+	return true;
+}
+
+bool FDreamLyricParser::TryLoadFromCache(const FDreamLyricCacheKey& Key)
+{
+	FDreamLyricCacheData CacheData;
+	if (!FDreamLyricCache::Load(FilePath, Key, CacheData))
+	{
+		return false;
+	}
+
+	Track = MoveTemp(CacheData.Track);
+	MetaData = MoveTemp(CacheData.MetaData);
+	LrcParseMethod = CacheData.ResolvedLrcLyricType;
+	bLoadedFromCache = true;
+
+	UE_LOG(LogTemp, Log, TEXT("Loaded %d lyrics from cache: %s"), Track->NumLines(), *FilePath);
+	return true;
+}
+
+void FDreamLyricParser::SaveToCache(const FDreamLyricCacheKey& Key) const
+{
+	FDreamLyricCacheData CacheData;
+	CacheData.Track = Track;
+	CacheData.MetaData = MetaData;
+	CacheData.ResolvedLrcLyricType = LrcParseMethod;
+	FDreamLyricCache::Save(FilePath, Key, CacheData);
+}
+
 void FDreamLyricParser::InitializeParser()
 {
 	if (CachedFileLines.IsEmpty())
@@ -114,22 +252,31 @@ void FDreamLyricParser::ClearLyrics()
 	Lyrics.Empty();
 }
 
-TArray<FDreamMusicLyric> FDreamLyricParser::GetLyrics()
+const TArray<FDreamMusicLyric>& FDreamLyricParser::GetLyrics()
 {
+	// 从缓存加载时只有轨道数据, 按需生成歌词列表
+	if (Lyrics.IsEmpty() && Track.IsValid())
+	{
+		Track->MaterializeLines(Lyrics);
+	}
+
 	return Lyrics;
 }
 
+int32 FDreamLyricParser::GetLyricCount() const
+{
+	return Track.IsValid() ? Track->NumLines() : Lyrics.Num();
+}
+
 void FDreamLyricParser::SortLyricsByTimestamp()
 {
-	Lyrics.Sort([](const FDreamMusicLyric& A, const FDreamMusicLyric& B)
-	{
-		return A.StartTimestamp.ToMilliseconds() < B.StartTimestamp.ToMilliseconds();
-	});
+	// 稳定排序, 同一时间的多行 (例如 ASS 对唱) 保持源文件顺序
+	Algo::StableSortBy(Lyrics, [](const FDreamMusicLyric& Lyric) { return Lyric.StartTimestamp.ToMilliseconds(); });
 }
 
 bool FDreamLyricParser::IsValidLyricFile() const
 {
-	return !CachedFileLines.IsEmpty() && FPlatformFileManager::Get().GetPlatformFile().FileExists(*FilePath);
+	return (bLoadedFromCache || !CachedFileLines.IsEmpty()) && FPlatformFileManager::Get().GetPlatformFile().FileExists(*FilePath);
 }
 
 FString FDreamLyricParser::GetFileExtension() const
@@ -164,73 +311,6 @@ EDreamMusicPlayerLyricParseFileType FDreamLyricParser::DetectFileType() const
 	return EDreamMusicPlayerLyricParseFileType::LRC;
 }
 
-EDreamMusicPlayerLrcLyricType FDreamLyricParser::DetectLRCSubtype() const
-{
-	for (const FString& Line : CachedFileLines)
-	{
-		FString TrimmedLine = Line.TrimStartAndEnd();
-
-		// Skip metadata lines by checking if line contains actual timestamp and content
-		if (TrimmedLine.StartsWith(TEXT("[")))
-		{
-			// Simple detection: check for ESLyric format (contains <timestamp> tags within content)
-			if (TrimmedLine.Contains(TEXT("<")) && TrimmedLine.Contains(TEXT(">")))
-			{
-				// Look for pattern like [mm:ss.mmm]content<mm:ss.mmm>
-				int32 FirstBracket = TrimmedLine.Find(TEXT("]"));
-				if (FirstBracket != INDEX_NONE)
-				{
-					FString AfterFirstTimestamp = TrimmedLine.Mid(FirstBracket + 1);
-					if (AfterFirstTimestamp.Contains(TEXT("<")) && AfterFirstTimestamp.Contains(TEXT(">")))
-					{
-						return EDreamMusicPlayerLrcLyricType::ESLyric;
-					}
-				}
-			}
-
-			// Check for word-by-word format (multiple [timestamp] tags per line)
-			int32 FirstTimestamp = TrimmedLine.Find(TEXT("]"));
-			if (FirstTimestamp != INDEX_NONE)
-			{
-				FString AfterFirstTimestamp = TrimmedLine.Mid(FirstTimestamp + 1);
-				if (AfterFirstTimestamp.Contains(TEXT("[")))
-				{
-					return EDreamMusicPlayerLrcLyricType::WordByWord;
-				}
-			}
-		}
-	}
-
-	// Default to line-by-line
-	return EDreamMusicPlayerLrcLyricType::LineByLine;
-}
-
-void FDreamLyricParser::ExtractMetadata()
-{
-	MetaData.Empty();
-
-	for (const FString& Line : CachedFileLines)
-	{
-		FString TrimmedLine = Line.TrimStartAndEnd();
-
-		// LRC metadata format: [tag:value]
-		if (TrimmedLine.StartsWith(TEXT("[")) && TrimmedLine.EndsWith(TEXT("]")))
-		{
-			FString Content = TrimmedLine.Mid(1, TrimmedLine.Len() - 2);
-			FString Tag, Value;
-
-			if (Content.Split(TEXT(":"), &Tag, &Value))
-			{
-				// Check if it's not a timestamp (metadata vs lyric line)
-				if (!Tag.IsNumeric() && !Tag.Contains(TEXT(".")))
-				{
-					MetaData.Add(Tag.ToLower(), Value);
-				}
-			}
-		}
-	}
-}
-
 FString FDreamLyricParser::GetMetadata(const FString& Key) const
 {
 	const FString* FoundValue = MetaData.Find(Key.ToLower());
@@ -239,49 +319,43 @@ FString FDreamLyricParser::GetMetadata(const FString& Key) const
 
 float FDreamLyricParser::GetTotalDuration() const
 {
-	if (Lyrics.IsEmpty())
+	if (!Track.IsValid() || Track->IsEmpty())
 		return 0.0f;
 
 	// Find the latest end timestamp
-	float MaxDuration = 0.0f;
-	for (const FDreamMusicLyric& Lyric : Lyrics)
+	FDreamLyricTime MaxTime;
+	for (int32 i = 0; i < Track->NumLines(); i++)
 	{
-		float EndTime = Lyric.EndTimestamp.ToSeconds();
-		if (EndTime > MaxDuration)
-		{
-			MaxDuration = EndTime;
-		}
+		MaxTime = FMath::Max(MaxTime, Track->GetLineEndTime(i));
 
 		// Fallback to start timestamp if end timestamp is not set
-		if (Lyric.EndTimestamp.ToMilliseconds() == 0)
+		if (Track->GetLineEndTime(i).Milliseconds == 0)
 		{
-			float StartTime = Lyric.StartTimestamp.ToSeconds();
-			if (StartTime > MaxDuration)
-			{
-				MaxDuration = StartTime;
-			}
+			MaxTime = FMath::Max(MaxTime, Track->GetLineStartTime(i));
 		}
 	}
 
-	return MaxDuration;
+	return MaxTime.ToSeconds();
 }
 
 bool FDreamLyricParser::ValidateTimestamps() const
 {
-	if (Lyrics.IsEmpty())
+	if (!Track.IsValid() || Track->IsEmpty())
 		return true;
 
-	for (int32 i = 0; i < Lyrics.Num() - 1; i++)
+	const TConstArrayView<FDreamLyricTime> StartTimes = Track->GetLineStartTimes();
+	const TConstArrayView<FDreamLyricTime> EndTimes = Track->GetLineEndTimes();
+
+	for (int32 i = 0; i < StartTimes.Num() - 1; i++)
 	{
 		// Check if timestamps are in ascending order
-		if (Lyrics[i].StartTimestamp.ToMilliseconds() > Lyrics[i + 1].StartTimestamp.ToMilliseconds())
+		if (StartTimes[i] > StartTimes[i + 1])
 		{
 			return false;
 		}
 
 		// Check if end timestamp is after start timestamp
-		if (Lyrics[i].EndTimestamp.ToMilliseconds() > 0 &&
-			Lyrics[i].StartTimestamp.ToMilliseconds() >= Lyrics[i].EndTimestamp.ToMilliseconds())
+		if (EndTimes[i].Milliseconds > 0 && StartTimes[i] >= EndTimes[i])
 		{
 			return false;
 		}
@@ -299,12 +373,12 @@ TArray<FString> FDreamLyricParser::GetValidationErrors() const
 		Errors.Add(TEXT("File does not exist or is not accessible"));
 	}
 
-	if (CachedFileLines.IsEmpty())
+	if (!bLoadedFromCache && CachedFileLines.IsEmpty())
 	{
 		Errors.Add(TEXT("No content loaded from file"));
 	}
 
-	if (Lyrics.IsEmpty())
+	if (GetLyricCount() == 0)
 	{
 		Errors.Add(TEXT("No lyrics parsed from file"));
 	}
@@ -316,11 +390,14 @@ TArray<FString> FDreamLyricParser::GetValidationErrors() const
 
 	// Check for missing content
 	int32 EmptyLyrics = 0;
-	for (const FDreamMusicLyric& Lyric : Lyrics)
+	if (Track.IsValid())
 	{
-		if (Lyric.Content.IsEmpty() && !Lyric.bIsEmptyLine)
+		for (int32 i = 0; i < Track->NumLines(); i++)
 		{
-			EmptyLyrics++;
+			if (Track->GetLineContent(i).IsEmpty() && !Track->IsEmptyLine(i))
+			{
+				EmptyLyrics++;
+			}
 		}
 	}
 
@@ -0,0 +1,99 @@
+﻿#include "LyricParser/DreamLyricStats.h"
+
+#include "DreamMusicPlayerLog.h"
+#include "HAL/IConsoleManager.h"
+#include <atomic>
+
+LLM_DEFINE_TAG(DreamMusicPlayer_Lyrics);
+
+namespace
+{
+	std::atomic<int64> GNumLinesCopied{0};
+	std::atomic<int64> GBytesCopied{0};
+	std::atomic<int64> GNumTracks{0};
+	std::atomic<int64> GTrackBytes{0};
+	std::atomic<int64> GNumFilesRead{0};
+	std::atomic<int64> GFileBytesRead{0};
+
+	FAutoConsoleCommand GDumpLyricStatsCommand(
+		TEXT("DreamMusicPlayer.Lyric.Stats"),
+		TEXT("Print lyric pipeline copy / track / file read counters"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			DMP_LOG(Display, TEXT("Lyric Stats: %s"), *FDreamLyricStats::GetSnapshot().ToString());
+		}));
+
+	FAutoConsoleCommand GResetLyricStatsCommand(
+		TEXT("DreamMusicPlayer.Lyric.ResetStats"),
+		TEXT("Reset lyric pipeline counters"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FDreamLyricStats::Reset();
+		}));
+}
+
+namespace FDreamLyricStats
+{
+	FString FSnapshot::ToString() const
+	{
+		return FString::Printf(TEXT("LinesCopied=%lld BytesCopied=%lld Tracks=%lld TrackBytes=%lld FilesRead=%lld FileBytesRead=%lld"),
+		                       NumLinesCopied, BytesCopied, NumTracks, TrackBytes, NumFilesRead, FileBytesRead);
+	}
+
+	void RecordLinesCopied(int64 NumLines, int64 Bytes)
+	{
+		GNumLinesCopied.fetch_add(NumLines, std::memory_order_relaxed);
+		GBytesCopied.fetch_add(Bytes, std::memory_order_relaxed);
+	}
+
+	void RecordTrack(int64 Bytes)
+	{
+		GNumTracks.fetch_add(1, std::memory_order_relaxed);
+		GTrackBytes.fetch_add(Bytes, std::memory_order_relaxed);
+	}
+
+	void RecordFileRead(int64 Bytes)
+	{
+		GNumFilesRead.fetch_add(1, std::memory_order_relaxed);
+		GFileBytesRead.fetch_add(Bytes, std::memory_order_relaxed);
+	}
+
+	FSnapshot GetSnapshot()
+	{
+		FSnapshot Snapshot;
+		Snapshot.NumLinesCopied = GNumLinesCopied.load(std::memory_order_relaxed);
+		Snapshot.BytesCopied = GBytesCopied.load(std::memory_order_relaxed);
+		Snapshot.NumTracks = GNumTracks.load(std::memory_order_relaxed);
+		Snapshot.TrackBytes = GTrackBytes.load(std::memory_order_relaxed);
+		Snapshot.NumFilesRead = GNumFilesRead.load(std::memory_order_relaxed);
+		Snapshot.FileBytesRead = GFileBytesRead.load(std::memory_order_relaxed);
+		return Snapshot;
+	}
+
+	void Reset()
+	{
+		GNumLinesCopied = 0;
+		GBytesCopied = 0;
+		GNumTracks = 0;
+		GTrackBytes = 0;
+		GNumFilesRead = 0;
+		GFileBytesRead = 0;
+	}
+
+	SIZE_T GetAllocatedSize(const FDreamMusicLyric& Lyric)
+	{
+		SIZE_T Size = Lyric.Content.GetAllocatedSize() + Lyric.Translate.GetAllocatedSize() + Lyric.Romanization.GetAllocatedSize()
+			+ Lyric.WordTimings.GetAllocatedSize() + Lyric.RomanizationWordTimings.GetAllocatedSize();
+
+		for (const FDreamMusicLyricWord& Word : Lyric.WordTimings)
+		{
+			Size += Word.Content.GetAllocatedSize();
+		}
+		for (const FDreamMusicLyricWord& Word : Lyric.RomanizationWordTimings)
+		{
+			Size += Word.Content.GetAllocatedSize();
+		}
+
+		return Size;
+	}
+}
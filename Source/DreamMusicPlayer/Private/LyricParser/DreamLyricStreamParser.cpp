@@ -0,0 +1,281 @@
+﻿#include "LyricParser/DreamLyricStreamParser.h"
+
+#include "LyricParser/DreamMusicPlayerLyricFileParser.h"
+#include "LyricParser/DreamLyricCache.h"
+#include "LyricParser/DreamLyricTrack.h"
+#include "LyricParser/DreamLyricStats.h"
+#include "LyricParser/DreamLyricTimingSynthesizer.h"
+#include "DreamMusicPlayerLog.h"
+#include "DreamMusicPlayerSettings.h"
+#include "Algo/StableSort.h"
+#include "Async/AsyncFileHandle.h"
+#include "String/ParseLines.h"
+
+FDreamLyricStreamParser::FDreamLyricStreamParser(FString InFilePath, EDreamMusicPlayerLyricParseFileType InFileType, EDreamMusicPlayerLyricParseLineType InLineType, int64 InChunkSize)
+	: FilePath(MoveTemp(InFilePath))
+	  , FileType(InFileType)
+	  , LineType(InLineType)
+	  , ChunkSize(FMath::Max<int64>(InChunkSize, 4 * 1024))
+{
+}
+
+FDreamLyricStreamParser::~FDreamLyricStreamParser() = default;
+
+bool FDreamLyricStreamParser::SupportsFileType(EDreamMusicPlayerLyricParseFileType FileType)
+{
+	return FileType == EDreamMusicPlayerLyricParseFileType::SRT || FileType == EDreamMusicPlayerLyricParseFileType::ASS;
+}
+
+bool FDreamLyricStreamParser::Run(const FOnTrackPublished& OnTrackPublished, const std::atomic<bool>* CancelFlag)
+{
+	auto IsCancelled = [CancelFlag]()
+	{
+		return CancelFlag && CancelFlag->load(std::memory_order_relaxed);
+	};
+
+	LLM_SCOPE_BYTAG(DreamMusicPlayer_Lyrics);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FFileStatData SourceStat = PlatformFile.GetStatData(*FilePath);
+	if (!SourceStat.bIsValid || SourceStat.bIsDirectory || !SupportsFileType(FileType))
+	{
+		DMP_LOG(Error, TEXT("Lyric stream: file not found or unsupported: %s"), *FilePath);
+		OnTrackPublished(nullptr, true);
+		return false;
+	}
+
+	const bool bUseCache = GetDefault<UDreamMusicPlayerSettings>()->bEnableLyricCache;
+
+	FDreamLyricCacheKey CacheKey;
+	CacheKey.SourceTimestamp = SourceStat.ModificationTime;
+	CacheKey.SourceSize = SourceStat.FileSize;
+	CacheKey.FileType = FileType;
+	CacheKey.LineType = LineType;
+	CacheKey.bSynthesizeWordTimings = FDreamLyricTimingSynthesizer::IsEnabled();
+
+	auto TryPublishFromCache = [this, &CacheKey, &OnTrackPublished](bool& bOutHasLyrics)
+	{
+		FDreamLyricCacheData CacheData;
+		if (!FDreamLyricCache::Load(FilePath, CacheKey, CacheData))
+		{
+			return false;
+		}
+
+		bOutHasLyrics = CacheData.Track.IsValid() && !CacheData.Track->IsEmpty();
+		OnTrackPublished(MoveTemp(CacheData.Track), true);
+		return true;
+	};
+
+	bool bCachedHasLyrics = false;
+	if (bUseCache && TryPublishFromCache(bCachedHasLyrics))
+	{
+		return bCachedHasLyrics;
+	}
+
+	// 预取或批量解析正在处理同一文件时等待其写入缓存, 不重复解析
+	TOptional<FDreamLyricCache::FScopedSourceLock> SourceLock;
+	if (bUseCache)
+	{
+		SourceLock.Emplace(FilePath);
+		if (SourceLock->WasContended() && TryPublishFromCache(bCachedHasLyrics))
+		{
+			return bCachedHasLyrics;
+		}
+	}
+
+	if (FileType == EDreamMusicPlayerLyricParseFileType::SRT)
+	{
+		Parser = MakeUnique<FDreamMusicPlayerLyricFileParser_SRT>(FStringView(), TConstArrayView<FStringView>(), LineType);
+	}
+	else
+	{
+		Parser = MakeUnique<FDreamMusicPlayerLyricFileParser_ASS>(FStringView(), TConstArrayView<FStringView>(), LineType);
+	}
+
+	TUniquePtr<IAsyncReadFileHandle> FileHandle(PlatformFile.OpenAsyncRead(*FilePath));
+	if (!FileHandle.IsValid())
+	{
+		DMP_LOG(Error, TEXT("Lyric stream: failed to open %s"), *FilePath);
+		OnTrackPublished(nullptr, true);
+		return false;
+	}
+
+	const int64 FileSize = SourceStat.FileSize;
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	TArray<uint8> PendingBytes;
+	PendingBytes.Reserve(static_cast<int32>(FMath::Min(FileSize, ChunkSize * 2)));
+
+	bool bFirstChunk = true;
+	bool bWholeFileFallback = false;
+	bool bReadFailed = false;
+	int32 NextPublishCount = FirstPublishLineCount;
+
+	int64 Offset = 0;
+	TUniquePtr<IAsyncReadRequest> Request(FileSize > 0 ? FileHandle->ReadRequest(0, FMath::Min(ChunkSize, FileSize)) : nullptr);
+
+	while (Request.IsValid())
+	{
+		Request->WaitCompletion();
+		uint8* ChunkData = Request->GetReadResults();
+		Request.Reset();
+
+		const int64 ChunkBytes = FMath::Min(ChunkSize, FileSize - Offset);
+		Offset += ChunkBytes;
+
+		if (!ChunkData)
+		{
+			DMP_LOG(Error, TEXT("Lyric stream: read failed at offset %lld: %s"), Offset - ChunkBytes, *FilePath);
+			bReadFailed = true;
+			break;
+		}
+
+		// 下一块在解析当前块时读取
+		if (Offset < FileSize && !IsCancelled())
+		{
+			Request.Reset(FileHandle->ReadRequest(Offset, FMath::Min(ChunkSize, FileSize - Offset)));
+		}
+
+		PendingBytes.Append(ChunkData, static_cast<int32>(ChunkBytes));
+		FMemory::Free(ChunkData);
+
+		if (bFirstChunk)
+		{
+			bFirstChunk = false;
+
+			// UTF-16 文件无法按字节安全切分, 读取完整文件后一次性解码
+			if (PendingBytes.Num() >= 2 && ((PendingBytes[0] == 0xFF && PendingBytes[1] == 0xFE) || (PendingBytes[0] == 0xFE && PendingBytes[1] == 0xFF)))
+			{
+				bWholeFileFallback = true;
+			}
+			else if (PendingBytes.Num() >= 3 && PendingBytes[0] == 0xEF && PendingBytes[1] == 0xBB && PendingBytes[2] == 0xBF)
+			{
+				PendingBytes.RemoveAt(0, 3, EAllowShrinking::No);
+			}
+		}
+
+		if (bWholeFileFallback)
+		{
+			continue;
+		}
+
+		// 只解码到最后一个换行符, 避免在行中间 (或多字节字符中间) 切分
+		const bool bLastChunk = !Request.IsValid();
+		int32 DecodeBytes = PendingBytes.Num();
+		if (!bLastChunk)
+		{
+			DecodeBytes = 0;
+			for (int32 Index = PendingBytes.Num() - 1; Index >= 0; Index--)
+			{
+				if (PendingBytes[Index] == '\n')
+				{
+					DecodeBytes = Index + 1;
+					break;
+				}
+			}
+		}
+
+		if (DecodeBytes > 0)
+		{
+			FeedUTF8(PendingBytes.GetData(), DecodeBytes);
+
+			const int32 RemainingBytes = PendingBytes.Num() - DecodeBytes;
+			FMemory::Memmove(PendingBytes.GetData(), PendingBytes.GetData() + DecodeBytes, RemainingBytes);
+			PendingBytes.SetNumUninitialized(RemainingBytes, EAllowShrinking::No);
+		}
+
+		if (!bLastChunk && Parser->GetParsedLyrics().Num() >= NextPublishCount)
+		{
+			NextPublishCount = Parser->GetParsedLyrics().Num() * 2;
+			OnTrackPublished(BuildSnapshot(), false);
+		}
+	}
+
+	// 取消或读取失败时, 等待仍在进行的读取完成后再释放文件句柄
+	if (Request.IsValid())
+	{
+		Request->WaitCompletion();
+		if (uint8* Unused = Request->GetReadResults())
+		{
+			FMemory::Free(Unused);
+		}
+		Request.Reset();
+	}
+
+	if (bReadFailed || IsCancelled())
+	{
+		OnTrackPublished(nullptr, true);
+		return false;
+	}
+
+	if (bWholeFileFallback)
+	{
+		FString FileText;
+		FFileHelper::BufferToString(FileText, PendingBytes.GetData(), PendingBytes.Num());
+		FeedText(FileText);
+	}
+
+	FDreamLyricStats::RecordFileRead(Offset);
+
+	Parser->FinishParse();
+
+	TSharedPtr<const FDreamLyricTrack> FinalTrack = BuildFinalTrack();
+
+	if (bUseCache)
+	{
+		FDreamLyricCacheData CacheData;
+		CacheData.Track = FinalTrack;
+		FDreamLyricCache::Save(FilePath, CacheKey, CacheData);
+	}
+
+	DMP_LOG(Log, TEXT("Lyric stream: %d lyrics in %.2f ms: %s"), FinalTrack->NumLines(),
+	        FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles), *FilePath);
+
+	const bool bHasLyrics = !FinalTrack->IsEmpty();
+	OnTrackPublished(MoveTemp(FinalTrack), true);
+	return bHasLyrics;
+}
+
+void FDreamLyricStreamParser::FeedUTF8(const uint8* Bytes, int32 NumBytes)
+{
+	const FUTF8ToTCHAR Converter(reinterpret_cast<const UTF8CHAR*>(Bytes), NumBytes);
+	FeedText(FStringView(Converter.Get(), Converter.Length()));
+}
+
+void FDreamLyricStreamParser::FeedText(FStringView Text)
+{
+	ChunkLines.Reset();
+	UE::String::ParseLines(Text, [this](FStringView Line)
+	{
+		ChunkLines.Add(Line);
+	});
+
+	Parser->ParseLines(ChunkLines);
+	ChunkLines.Reset();
+}
+
+TSharedPtr<const FDreamLyricTrack> FDreamLyricStreamParser::BuildSnapshot() const
+{
+	// 解析器仍在使用歌词数组 (ASS 按索引合并), 只对指针排序, 不复制歌词
+	const TArray<FDreamMusicLyric>& ParsedLyrics = Parser->GetParsedLyrics();
+
+	TArray<const FDreamMusicLyric*> Snapshot;
+	Snapshot.Reserve(ParsedLyrics.Num());
+	for (const FDreamMusicLyric& Lyric : ParsedLyrics)
+	{
+		Snapshot.Add(&Lyric);
+	}
+
+	Algo::StableSortBy(Snapshot, [](const FDreamMusicLyric* Lyric) { return Lyric->StartTimestamp.ToMilliseconds(); });
+
+	return MakeShared<const FDreamLyricTrack>(Snapshot);
+}
+
+TSharedPtr<const FDreamLyricTrack> FDreamLyricStreamParser::BuildFinalTrack()
+{
+	TArray<FDreamMusicLyric> FinalLyrics = Parser->TakeParsedLyrics();
+	// 与快照使用相同的稳定排序, 同一开始时间的行在快照与最终轨道中顺序一致
+	Algo::StableSortBy(FinalLyrics, [](const FDreamMusicLyric& Lyric) { return Lyric.StartTimestamp.ToMilliseconds(); });
+
+	return MakeShared<const FDreamLyricTrack>(FinalLyrics);
+}
@@ -0,0 +1,51 @@
+﻿#include "LyricParser/DreamLyricTextSegmenter.h"
+
+#include "Internationalization/BreakIterator.h"
+#include "Internationalization/IBreakIterator.h"
+
+FDreamLyricTextSegmenter::FDreamLyricTextSegmenter()
+	: GraphemeIterator(FBreakIterator::CreateCharacterBoundaryIterator())
+	  , WordIterator(FBreakIterator::CreateWordBreakIterator())
+{
+}
+
+int32 FDreamLyricTextSegmenter::AppendGraphemeEnds(FStringView Text, TArray<int32>& OutEnds)
+{
+	return AppendBoundaries(*GraphemeIterator, Text, OutEnds);
+}
+
+int32 FDreamLyricTextSegmenter::AppendWordBreakEnds(FStringView Text, TArray<int32>& OutEnds)
+{
+	return AppendBoundaries(*WordIterator, Text, OutEnds);
+}
+
+int32 FDreamLyricTextSegmenter::AppendBoundaries(IBreakIterator& Iterator, FStringView Text, TArray<int32>& OutEnds)
+{
+	if (Text.IsEmpty())
+	{
+		return 0;
+	}
+
+	const int32 FirstEnd = OutEnds.Num();
+
+	Iterator.SetStringRef(Text);
+	Iterator.ResetToBeginning();
+
+	int32 Begin = 0;
+	for (int32 End = Iterator.MoveToNext(); End != INDEX_NONE && End > Begin; End = Iterator.MoveToNext())
+	{
+		OutEnds.Add(End);
+		Begin = End;
+	}
+
+	// 迭代器只引用文本, 用完即清除
+	Iterator.ClearString();
+
+	// 保证片段覆盖整段文本
+	if (Begin < Text.Len())
+	{
+		OutEnds.Add(Text.Len());
+	}
+
+	return OutEnds.Num() - FirstEnd;
+}
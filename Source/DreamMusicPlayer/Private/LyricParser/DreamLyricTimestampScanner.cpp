@@ -0,0 +1,205 @@
+﻿#include "LyricParser/DreamLyricTimestampScanner.h"
+
+namespace
+{
+	FORCEINLINE bool IsAsciiDigit(TCHAR Char)
+	{
+		return Char >= TEXT('0') && Char <= TEXT('9');
+	}
+
+	FORCEINLINE bool IsFractionSeparator(TCHAR Char)
+	{
+		return Char == TEXT('.') || Char == TEXT(',');
+	}
+
+	/** Read between MinDigits and MaxDigits decimal digits starting at Pos, returns the digit count (0 on failure) */
+	int32 ReadNumber(FStringView Text, int32 Pos, int32 MinDigits, int32 MaxDigits, int32& OutValue)
+	{
+		int32 Digits = 0;
+		int32 Value = 0;
+		while (Pos + Digits < Text.Len() && Digits < MaxDigits && IsAsciiDigit(Text[Pos + Digits]))
+		{
+			Value = Value * 10 + (Text[Pos + Digits] - TEXT('0'));
+			Digits++;
+		}
+
+		if (Digits < MinDigits)
+		{
+			return 0;
+		}
+
+		OutValue = Value;
+		return Digits;
+	}
+
+	/** Read a 1-3 digit fraction and normalise it to milliseconds, extra precision digits are consumed and dropped */
+	int32 ReadFraction(FStringView Text, int32 Pos, int32& OutMilliseconds)
+	{
+		int32 Value = 0;
+		const int32 Digits = ReadNumber(Text, Pos, 1, 3, Value);
+		if (Digits == 0)
+		{
+			return 0;
+		}
+
+		static constexpr int32 Scale[] = {0, 100, 10, 1};
+		OutMilliseconds = Value * Scale[Digits];
+
+		int32 Consumed = Digits;
+		while (Pos + Consumed < Text.Len() && IsAsciiDigit(Text[Pos + Consumed]))
+		{
+			Consumed++;
+		}
+		return Consumed;
+	}
+
+	FORCEINLINE bool HasDigitAt(FStringView Text, int32 Pos)
+	{
+		return Pos < Text.Len() && IsAsciiDigit(Text[Pos]);
+	}
+
+	int32 SkipWhitespace(FStringView Text, int32 Pos)
+	{
+		while (Pos < Text.Len() && FChar::IsWhitespace(Text[Pos]))
+		{
+			Pos++;
+		}
+		return Pos;
+	}
+}
+
+int32 FDreamLyricTimestampScanner::ScanClock(FStringView Text, FDreamLyricTime& OutTime)
+{
+	int32 Pos = 0;
+	int32 First = 0;
+	int32 Second = 0;
+
+	// 第一段: 分钟 (LRC) 或 小时 (SRT/ASS)
+	int32 Digits = ReadNumber(Text, Pos, 1, 3, First);
+	if (Digits == 0 || Pos + Digits >= Text.Len() || Text[Pos + Digits] != TEXT(':'))
+	{
+		return 0;
+	}
+	Pos += Digits + 1;
+
+	Digits = ReadNumber(Text, Pos, 1, 2, Second);
+	if (Digits == 0)
+	{
+		return 0;
+	}
+	Pos += Digits;
+
+	int32 Hours = 0;
+	int32 Minutes = First;
+	int32 Seconds = Second;
+	int32 Milliseconds = 0;
+
+	if (Pos < Text.Len() && Text[Pos] == TEXT(':') && HasDigitAt(Text, Pos + 1))
+	{
+		// Either H:MM:SS(.fff) or LRC mm:ss:xx
+		const int32 ThirdStart = Pos + 1;
+		int32 Third = 0;
+		Digits = ReadNumber(Text, ThirdStart, 1, 3, Third);
+		const int32 AfterThird = ThirdStart + Digits;
+
+		if (Digits <= 2 && AfterThird < Text.Len() && IsFractionSeparator(Text[AfterThird]) && HasDigitAt(Text, AfterThird + 1))
+		{
+			Hours = First;
+			Minutes = Second;
+			Seconds = Third;
+			const int32 FractionDigits = ReadFraction(Text, AfterThird + 1, Milliseconds);
+			Pos = AfterThird + 1 + FractionDigits;
+		}
+		else
+		{
+			const int32 FractionDigits = ReadFraction(Text, ThirdStart, Milliseconds);
+			Pos = ThirdStart + FractionDigits;
+		}
+	}
+	else if (Pos < Text.Len() && IsFractionSeparator(Text[Pos]) && HasDigitAt(Text, Pos + 1))
+	{
+		const int32 FractionDigits = ReadFraction(Text, Pos + 1, Milliseconds);
+		Pos += 1 + FractionDigits;
+	}
+
+	OutTime = FDreamLyricTime::FromParts(Hours, Minutes, Seconds, Milliseconds);
+	return Pos;
+}
+
+int32 FDreamLyricTimestampScanner::ScanTag(FStringView Text, TCHAR OpenTag, TCHAR CloseTag, FDreamLyricTime& OutTime)
+{
+	if (Text.Len() < 3 || Text[0] != OpenTag)
+	{
+		return 0;
+	}
+
+	FDreamLyricTime Time;
+	const int32 ClockLength = ScanClock(Text.RightChop(1), Time);
+	if (ClockLength == 0 || 1 + ClockLength >= Text.Len() || Text[1 + ClockLength] != CloseTag)
+	{
+		return 0;
+	}
+
+	OutTime = Time;
+	return ClockLength + 2;
+}
+
+bool FDreamLyricTimestampScanner::FindTag(FStringView Text, TCHAR OpenTag, TCHAR CloseTag, FDreamLyricTime& OutTime, int32& OutTagStart, int32& OutTagLength)
+{
+	for (int32 Index = 0; Index < Text.Len(); Index++)
+	{
+		if (Text[Index] != OpenTag)
+		{
+			continue;
+		}
+
+		const int32 TagLength = ScanTag(Text.RightChop(Index), OpenTag, CloseTag, OutTime);
+		if (TagLength > 0)
+		{
+			OutTagStart = Index;
+			OutTagLength = TagLength;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FDreamLyricTimestampScanner::FindClock(FStringView Text, FDreamLyricTime& OutTime)
+{
+	for (int32 Index = 0; Index < Text.Len(); Index++)
+	{
+		if (!IsAsciiDigit(Text[Index]) || (Index > 0 && IsAsciiDigit(Text[Index - 1])))
+		{
+			continue;
+		}
+
+		if (ScanClock(Text.RightChop(Index), OutTime) > 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FDreamLyricTimestampScanner::ScanRange(FStringView Text, FDreamLyricTime& OutStart, FDreamLyricTime& OutEnd)
+{
+	int32 Pos = SkipWhitespace(Text, 0);
+
+	const int32 StartLength = ScanClock(Text.RightChop(Pos), OutStart);
+	if (StartLength == 0)
+	{
+		return false;
+	}
+	Pos = SkipWhitespace(Text, Pos + StartLength);
+
+	static const FStringView Arrow = TEXTVIEW("-->");
+	if (!Text.RightChop(Pos).StartsWith(Arrow))
+	{
+		return false;
+	}
+	Pos = SkipWhitespace(Text, Pos + Arrow.Len());
+
+	return ScanClock(Text.RightChop(Pos), OutEnd) > 0;
+}
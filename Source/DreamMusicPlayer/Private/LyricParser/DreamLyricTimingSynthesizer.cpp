@@ -0,0 +1,124 @@
+﻿#include "LyricParser/DreamLyricTimingSynthesizer.h"
+
+#include "DreamMusicPlayerSettings.h"
+
+namespace
+{
+	// CJK 字符与假名大致一字一音节, 字母文字约三个字母一个音节
+	constexpr float SyllabicWeight = 1.0f;
+	constexpr float AlphabeticWeight = 0.35f;
+
+	bool IsInRange(UTF32CHAR CodePoint, UTF32CHAR First, UTF32CHAR Last)
+	{
+		return CodePoint >= First && CodePoint <= Last;
+	}
+
+	UTF32CHAR DecodeFirstCodePoint(FStringView Grapheme)
+	{
+		if (Grapheme.Len() >= 2 && StringConv::IsHighSurrogate(Grapheme[0]) && StringConv::IsLowSurrogate(Grapheme[1]))
+		{
+			return StringConv::EncodeSurrogate(Grapheme[0], Grapheme[1]);
+		}
+		return static_cast<UTF32CHAR>(Grapheme[0]);
+	}
+}
+
+bool FDreamLyricTimingSynthesizer::IsEnabled()
+{
+	return GetDefault<UDreamMusicPlayerSettings>()->bSynthesizeWordTimings;
+}
+
+float FDreamLyricTimingSynthesizer::GetCodePointWeight(UTF32CHAR CodePoint)
+{
+	// ASCII: 只有字母和数字需要时间
+	if (CodePoint < 0x80)
+	{
+		return FChar::IsAlnum(static_cast<TCHAR>(CodePoint)) ? AlphabeticWeight : 0.0f;
+	}
+
+	// Latin-1 标点, 通用标点, CJK 标点, 全角标点
+	if (IsInRange(CodePoint, 0x0080, 0x00BF)
+		|| IsInRange(CodePoint, 0x2000, 0x206F)
+		|| IsInRange(CodePoint, 0x3000, 0x303F)
+		|| IsInRange(CodePoint, 0xFE30, 0xFE4F)
+		|| IsInRange(CodePoint, 0xFF01, 0xFF0F)
+		|| IsInRange(CodePoint, 0xFF1A, 0xFF20)
+		|| IsInRange(CodePoint, 0xFF3B, 0xFF40)
+		|| IsInRange(CodePoint, 0xFF5B, 0xFF65))
+	{
+		return 0.0f;
+	}
+
+	// 假名, CJK 统一表意文字 (含扩展区与兼容区), 谚文音节
+	if (IsInRange(CodePoint, 0x3040, 0x30FF)
+		|| IsInRange(CodePoint, 0x3400, 0x4DBF)
+		|| IsInRange(CodePoint, 0x4E00, 0x9FFF)
+		|| IsInRange(CodePoint, 0xAC00, 0xD7AF)
+		|| IsInRange(CodePoint, 0xF900, 0xFAFF)
+		|| IsInRange(CodePoint, 0x20000, 0x2FA1F))
+	{
+		return SyllabicWeight;
+	}
+
+	return AlphabeticWeight;
+}
+
+int32 FDreamLyricTimingSynthesizer::Synthesize(FStringView Text, TConstArrayView<int32> GraphemeEnds, FDreamLyricTime StartTime, FDreamLyricTime EndTime, TArray<FSyllable>& OutSyllables)
+{
+	const int32 Duration = EndTime - StartTime;
+	if (Text.IsEmpty() || Duration <= 0)
+	{
+		return 0;
+	}
+
+	const int32 FirstSyllable = OutSyllables.Num();
+	TArray<float, TInlineAllocator<64>> CumulativeWeights;
+	float TotalWeight = 0.0f;
+
+	int32 GraphemeBegin = 0;
+	for (const int32 GraphemeEnd : GraphemeEnds)
+	{
+		if (GraphemeEnd <= GraphemeBegin || GraphemeEnd > Text.Len())
+		{
+			break;
+		}
+
+		const float Weight = GetCodePointWeight(DecodeFirstCodePoint(Text.Mid(GraphemeBegin, GraphemeEnd - GraphemeBegin)));
+
+		if (Weight > 0.0f)
+		{
+			// 行首的空格与标点并入第一个音节
+			const int32 TextOffset = OutSyllables.Num() == FirstSyllable ? 0 : GraphemeBegin;
+			OutSyllables.Add({TextOffset, GraphemeEnd - TextOffset});
+
+			TotalWeight += Weight;
+			CumulativeWeights.Add(TotalWeight);
+		}
+		else if (OutSyllables.Num() > FirstSyllable)
+		{
+			// 空格与标点不占时间, 并入前一个音节
+			FSyllable& Previous = OutSyllables.Last();
+			Previous.TextLength = GraphemeEnd - Previous.TextOffset;
+		}
+
+		GraphemeBegin = GraphemeEnd;
+	}
+
+	const int32 NumSyllables = CumulativeWeights.Num();
+	if (NumSyllables == 0)
+	{
+		return 0;
+	}
+
+	// 按累计权重取整, 相邻音节首尾相接, 最后一个音节结束于行结束时间
+	FDreamLyricTime SyllableStart = StartTime;
+	for (int32 i = 0; i < NumSyllables; i++)
+	{
+		FSyllable& Syllable = OutSyllables[FirstSyllable + i];
+		Syllable.StartTime = SyllableStart;
+		Syllable.EndTime = i + 1 == NumSyllables ? EndTime : StartTime + FMath::RoundToInt32(Duration * (CumulativeWeights[i] / TotalWeight));
+		SyllableStart = Syllable.EndTime;
+	}
+
+	return NumSyllables;
+}
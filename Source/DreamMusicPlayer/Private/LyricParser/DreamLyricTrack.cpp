@@ -0,0 +1,511 @@
+﻿#include "LyricParser/DreamLyricTrack.h"
+#include "LyricParser/DreamLyricStats.h"
+#include "LyricParser/DreamLyricTextSegmenter.h"
+
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+
+namespace
+{
+	/** 平铺数组按原始内存读写, 加载时不逐元素解析 */
+	template <typename ElementType>
+	void SerializeFlatArray(FArchive& Ar, TArray<ElementType>& Array)
+	{
+		static_assert(TIsTriviallyDestructible<ElementType>::Value, "Only flat arrays can be serialized as raw memory");
+
+		int32 Num = Array.Num();
+		Ar << Num;
+
+		if (Ar.IsLoading())
+		{
+			if (Num < 0 || static_cast<int64>(Num) * sizeof(ElementType) > Ar.TotalSize() - Ar.Tell())
+			{
+				Ar.SetError();
+				return;
+			}
+			Array.SetNumUninitialized(Num);
+		}
+
+		Ar.Serialize(Array.GetData(), static_cast<int64>(Num) * sizeof(ElementType));
+	}
+}
+
+FDreamLyricTrack::FDreamLyricTrack(TConstArrayView<FDreamMusicLyric> InLyrics)
+{
+	Build(InLyrics.Num(), [InLyrics](int32 LineIndex) -> const FDreamMusicLyric& { return InLyrics[LineIndex]; });
+}
+
+FDreamLyricTrack::FDreamLyricTrack(TConstArrayView<const FDreamMusicLyric*> InLyrics)
+{
+	Build(InLyrics.Num(), [InLyrics](int32 LineIndex) -> const FDreamMusicLyric& { return *InLyrics[LineIndex]; });
+}
+
+template <typename LyricAccessorType>
+void FDreamLyricTrack::Build(int32 LineCount, LyricAccessorType&& GetLyric)
+{
+	LLM_SCOPE_BYTAG(DreamMusicPlayer_Lyrics);
+
+	int32 TextLength = 0;
+	int32 WordCounts[static_cast<int32>(EDreamLyricWordChannel::Num)] = {0, 0};
+	int32 ChannelTextLengths[static_cast<int32>(EDreamLyricWordChannel::Num)] = {0, 0};
+	for (int32 LineIndex = 0; LineIndex < LineCount; LineIndex++)
+	{
+		const FDreamMusicLyric& Lyric = GetLyric(LineIndex);
+		TextLength += Lyric.Content.Len() + Lyric.Translate.Len() + Lyric.Romanization.Len();
+		ChannelTextLengths[static_cast<int32>(EDreamLyricWordChannel::Lyric)] += Lyric.Content.Len();
+		ChannelTextLengths[static_cast<int32>(EDreamLyricWordChannel::Romanization)] += Lyric.Romanization.Len();
+		WordCounts[static_cast<int32>(EDreamLyricWordChannel::Lyric)] += Lyric.WordTimings.Num();
+		WordCounts[static_cast<int32>(EDreamLyricWordChannel::Romanization)] += Lyric.RomanizationWordTimings.Num();
+	}
+
+	LineStartTimes.Reserve(LineCount);
+	LineEndTimes.Reserve(LineCount);
+	LineContentSpans.Reserve(LineCount);
+	LineTranslateSpans.Reserve(LineCount);
+	LineRomanizationSpans.Reserve(LineCount);
+	EmptyLineFlags.Reserve(LineCount);
+	TextPool.Reserve(TextLength);
+
+	for (int32 ChannelIndex = 0; ChannelIndex < static_cast<int32>(EDreamLyricWordChannel::Num); ChannelIndex++)
+	{
+		FWordTable& Table = WordTables[ChannelIndex];
+		Table.StartTimes.Reserve(WordCounts[ChannelIndex]);
+		Table.EndTimes.Reserve(WordCounts[ChannelIndex]);
+		Table.TextSpans.Reserve(WordCounts[ChannelIndex]);
+		Table.ElapsedBefore.Reserve(WordCounts[ChannelIndex]);
+		Table.LineWordOffsets.Reserve(LineCount + 1);
+		Table.LineWordOffsets.Add(0);
+
+		SegmentTables[ChannelIndex].Reset(LineCount, ChannelTextLengths[ChannelIndex]);
+	}
+
+	FDreamLyricTextSegmenter Segmenter;
+
+	// 逐行歌词的逐字时间在构建时一次生成, 之后与解析得到的逐字时间没有区别
+	TArray<FDreamLyricTimingSynthesizer::FSyllable> SyllableScratch;
+	TArray<FDreamLyricTimingSynthesizer::FSyllable>* SyllableScratchPtr = FDreamLyricTimingSynthesizer::IsEnabled() ? &SyllableScratch : nullptr;
+
+	for (int32 LineIndex = 0; LineIndex < LineCount; LineIndex++)
+	{
+		const FDreamMusicLyric& Lyric = GetLyric(LineIndex);
+		LineStartTimes.Add(Lyric.StartTimestamp.ToTime());
+		LineEndTimes.Add(Lyric.EndTimestamp.ToTime());
+		LineContentSpans.Add(AppendText(Lyric.Content));
+		LineTranslateSpans.Add(AppendText(Lyric.Translate));
+		LineRomanizationSpans.Add(AppendText(Lyric.Romanization));
+		EmptyLineFlags.Add(Lyric.bIsEmptyLine);
+
+		// 逐字合成使用行的字素簇边界, 需先于 AppendWords
+		AppendSegments(EDreamLyricWordChannel::Lyric, LineIndex, Segmenter);
+		AppendSegments(EDreamLyricWordChannel::Romanization, LineIndex, Segmenter);
+
+		AppendWords(EDreamLyricWordChannel::Lyric, Lyric.WordTimings, SyllableScratchPtr);
+		AppendWords(EDreamLyricWordChannel::Romanization, Lyric.RomanizationWordTimings, SyllableScratchPtr);
+	}
+
+	TextPool.Shrink();
+	BuildTimeline();
+
+	FDreamLyricStats::RecordTrack(GetAllocatedSize());
+}
+
+FDreamLyricTextSpan FDreamLyricTrack::AppendText(FStringView Text)
+{
+	FDreamLyricTextSpan Span;
+	Span.Offset = TextPool.Num();
+	Span.Length = Text.Len();
+	TextPool.Append(Text.GetData(), Text.Len());
+	return Span;
+}
+
+void FDreamLyricTrack::AppendWords(EDreamLyricWordChannel Channel, const TArray<FDreamMusicLyricWord>& Words, TArray<FDreamLyricTimingSynthesizer::FSyllable>* SyllableScratch)
+{
+	FWordTable& Table = WordTables[static_cast<int32>(Channel)];
+
+	// 逐字文本通常就是整行文本的切分, 能对上时直接引用行文本, 不再重复写入文本池
+	const int32 LineIndex = LineStartTimes.Num() - 1;
+	const FDreamLyricTextSpan LineSpan = GetLineTextSpan(Channel, LineIndex);
+	int32 LineCursor = 0;
+	int32 Elapsed = 0;
+
+	if (Words.IsEmpty() && SyllableScratch)
+	{
+		SyllableScratch->Reset();
+		FDreamLyricTimingSynthesizer::Synthesize(GetText(LineSpan), GetLineGraphemeEnds(Channel, LineIndex), LineStartTimes[LineIndex], LineEndTimes[LineIndex], *SyllableScratch);
+
+		for (const FDreamLyricTimingSynthesizer::FSyllable& Syllable : *SyllableScratch)
+		{
+			Table.StartTimes.Add(Syllable.StartTime);
+			Table.EndTimes.Add(Syllable.EndTime);
+			Table.TextSpans.Add({LineSpan.Offset + Syllable.TextOffset, Syllable.TextLength});
+			Table.ElapsedBefore.Add(Elapsed);
+			Elapsed += Syllable.EndTime - Syllable.StartTime;
+		}
+	}
+
+	for (const FDreamMusicLyricWord& Word : Words)
+	{
+		const FDreamLyricTime StartTime = Word.StartTimestamp.ToTime();
+		const FDreamLyricTime EndTime = Word.EndTimestamp.ToTime();
+		Table.StartTimes.Add(StartTime);
+		Table.EndTimes.Add(EndTime);
+		Table.ElapsedBefore.Add(Elapsed);
+		Elapsed += EndTime - StartTime;
+
+		if (LineCursor != INDEX_NONE && GetText(LineSpan).RightChop(LineCursor).StartsWith(Word.Content, ESearchCase::CaseSensitive))
+		{
+			Table.TextSpans.Add({LineSpan.Offset + LineCursor, Word.Content.Len()});
+			LineCursor += Word.Content.Len();
+		}
+		else
+		{
+			Table.TextSpans.Add(AppendText(Word.Content));
+			LineCursor = INDEX_NONE;
+		}
+	}
+
+	Table.LineWordOffsets.Add(Table.StartTimes.Num());
+}
+
+void FDreamLyricTrack::FWordTable::BuildElapsedBefore()
+{
+	ElapsedBefore.SetNumUninitialized(StartTimes.Num());
+
+	for (int32 LineIndex = 0; LineIndex + 1 < LineWordOffsets.Num(); LineIndex++)
+	{
+		int32 Elapsed = 0;
+		for (int32 WordIndex = LineWordOffsets[LineIndex]; WordIndex < LineWordOffsets[LineIndex + 1]; WordIndex++)
+		{
+			ElapsedBefore[WordIndex] = Elapsed;
+			Elapsed += EndTimes[WordIndex] - StartTimes[WordIndex];
+		}
+	}
+}
+
+void FDreamLyricTrack::FSegmentTable::Reset(int32 LineCount, int32 TextLength)
+{
+	// 字素簇数不超过文本长度, 分词片段通常少得多
+	GraphemeEnds.Reset(TextLength);
+	WordBreakEnds.Reset(TextLength / 2);
+	LineGraphemeOffsets.Reset(LineCount + 1);
+	LineWordBreakOffsets.Reset(LineCount + 1);
+	LineGraphemeOffsets.Add(0);
+	LineWordBreakOffsets.Add(0);
+}
+
+void FDreamLyricTrack::AppendSegments(EDreamLyricWordChannel Channel, int32 LineIndex, FDreamLyricTextSegmenter& Segmenter)
+{
+	FSegmentTable& Table = SegmentTables[static_cast<int32>(Channel)];
+	const FStringView Text = GetText(GetLineTextSpan(Channel, LineIndex));
+
+	Segmenter.AppendGraphemeEnds(Text, Table.GraphemeEnds);
+	Segmenter.AppendWordBreakEnds(Text, Table.WordBreakEnds);
+	Table.LineGraphemeOffsets.Add(Table.GraphemeEnds.Num());
+	Table.LineWordBreakOffsets.Add(Table.WordBreakEnds.Num());
+}
+
+void FDreamLyricTrack::BuildSegments()
+{
+	FDreamLyricTextSegmenter Segmenter;
+
+	for (int32 ChannelIndex = 0; ChannelIndex < static_cast<int32>(EDreamLyricWordChannel::Num); ChannelIndex++)
+	{
+		const EDreamLyricWordChannel Channel = static_cast<EDreamLyricWordChannel>(ChannelIndex);
+
+		int32 TextLength = 0;
+		for (int32 LineIndex = 0; LineIndex < NumLines(); LineIndex++)
+		{
+			TextLength += GetLineTextSpan(Channel, LineIndex).Length;
+		}
+
+		SegmentTables[ChannelIndex].Reset(NumLines(), TextLength);
+		for (int32 LineIndex = 0; LineIndex < NumLines(); LineIndex++)
+		{
+			AppendSegments(Channel, LineIndex, Segmenter);
+		}
+	}
+}
+
+bool FDreamLyricTrack::GetLineWordTextRange(EDreamLyricWordChannel Channel, int32 LineIndex, int32 WordInLine, int32& OutBegin, int32& OutEnd) const
+{
+	if (!IsValidLine(LineIndex) || WordInLine < 0 || WordInLine >= GetLineWordCount(Channel, LineIndex))
+	{
+		return false;
+	}
+
+	// 无法对上行文本的字单独写入了文本池, 不在行文本范围内
+	const FDreamLyricTextSpan& LineSpan = GetLineTextSpan(Channel, LineIndex);
+	const FDreamLyricTextSpan& WordSpan = GetWordTable(Channel).TextSpans[GetLineWordBegin(Channel, LineIndex) + WordInLine];
+	if (WordSpan.Offset < LineSpan.Offset || WordSpan.Offset + WordSpan.Length > LineSpan.Offset + LineSpan.Length)
+	{
+		return false;
+	}
+
+	OutBegin = WordSpan.Offset - LineSpan.Offset;
+	OutEnd = OutBegin + WordSpan.Length;
+	return true;
+}
+
+int32 FDreamLyricTrack::FindLineIndex(FDreamLyricTime Time) const
+{
+	// 第一个开始时间大于 Time 的行的前一行
+	return Algo::UpperBound(LineStartTimes, Time) - 1;
+}
+
+void FDreamLyricTrack::BuildTimeline()
+{
+	struct FTimelineEdge
+	{
+		FDreamLyricTime Time;
+		int32 LineIndex;
+		bool bStart;
+	};
+
+	TArray<FTimelineEdge> Edges;
+	Edges.Reserve(NumLines() * 2);
+	for (int32 LineIndex = 0; LineIndex < NumLines(); LineIndex++)
+	{
+		// 没有时长的行不会处于显示状态
+		if (LineStartTimes[LineIndex] < LineEndTimes[LineIndex])
+		{
+			Edges.Add({LineStartTimes[LineIndex], LineIndex, true});
+			Edges.Add({LineEndTimes[LineIndex], LineIndex, false});
+		}
+	}
+
+	// 同一时刻先结束再开始, 行区间为左闭右开
+	Algo::Sort(Edges, [](const FTimelineEdge& A, const FTimelineEdge& B)
+	{
+		return A.Time != B.Time ? A.Time < B.Time : A.bStart < B.bStart;
+	});
+
+	TimelineTimes.Reset();
+	TimelineLineOffsets.Reset();
+	TimelineLines.Reset();
+
+	// 活动行按行索引保持有序, 每个时间段复制一次, 不重叠的歌词总量约为行数
+	TArray<int32, TInlineAllocator<8>> ActiveLines;
+	for (int32 EdgeIndex = 0; EdgeIndex < Edges.Num();)
+	{
+		const FDreamLyricTime Time = Edges[EdgeIndex].Time;
+		for (; EdgeIndex < Edges.Num() && Edges[EdgeIndex].Time == Time; EdgeIndex++)
+		{
+			const FTimelineEdge& Edge = Edges[EdgeIndex];
+			const int32 Position = Algo::LowerBound(ActiveLines, Edge.LineIndex);
+			if (Edge.bStart)
+			{
+				ActiveLines.Insert(Edge.LineIndex, Position);
+			}
+			else
+			{
+				ActiveLines.RemoveAt(Position, 1, EAllowShrinking::No);
+			}
+		}
+
+		TimelineTimes.Add(Time);
+		TimelineLineOffsets.Add(TimelineLines.Num());
+		TimelineLines.Append(ActiveLines);
+	}
+	TimelineLineOffsets.Add(TimelineLines.Num());
+
+	TimelineTimes.Shrink();
+	TimelineLines.Shrink();
+}
+
+TConstArrayView<int32> FDreamLyricTrack::GetActiveLines(FDreamLyricTime Time) const
+{
+	const int32 Segment = Algo::UpperBound(TimelineTimes, Time) - 1;
+	if (Segment < 0)
+	{
+		return TConstArrayView<int32>();
+	}
+
+	const int32 Begin = TimelineLineOffsets[Segment];
+	return TConstArrayView<int32>(TimelineLines).Slice(Begin, TimelineLineOffsets[Segment + 1] - Begin);
+}
+
+int32 FDreamLyricTrack::AdvanceLineIndex(FDreamLyricTime Time, int32 CursorIndex) const
+{
+	if (!IsValidLine(CursorIndex) || Time < LineStartTimes[CursorIndex])
+	{
+		return FindLineIndex(Time);
+	}
+
+	// 正常播放: 仍在当前行或只前进了几行
+	constexpr int32 MaxLinearSteps = 4;
+	const int32 LastLinearIndex = FMath::Min(CursorIndex + MaxLinearSteps, LineStartTimes.Num() - 1);
+
+	int32 Index = CursorIndex;
+	while (Index < LastLinearIndex && LineStartTimes[Index + 1] <= Time)
+	{
+		Index++;
+	}
+
+	if (Index == LineStartTimes.Num() - 1 || Time < LineStartTimes[Index + 1])
+	{
+		return Index;
+	}
+
+	// 向前跳转: 只在游标之后的范围内二分
+	return Index + Algo::UpperBound(MakeArrayView(LineStartTimes).RightChop(Index + 1), Time);
+}
+
+FDreamMusicLyric FDreamLyricTrack::MaterializeLine(int32 LineIndex) const
+{
+	if (!IsValidLine(LineIndex))
+	{
+		return FDreamMusicLyric::EMPTY();
+	}
+
+	FDreamMusicLyric Lyric;
+	Lyric.StartTimestamp = FDreamMusicLyricTimestamp(LineStartTimes[LineIndex]);
+	Lyric.EndTimestamp = FDreamMusicLyricTimestamp(LineEndTimes[LineIndex]);
+	Lyric.Content = FString(GetLineContent(LineIndex));
+	Lyric.Translate = FString(GetLineTranslate(LineIndex));
+	Lyric.Romanization = FString(GetLineRomanization(LineIndex));
+	Lyric.bIsEmptyLine = EmptyLineFlags[LineIndex];
+	MaterializeWords(EDreamLyricWordChannel::Lyric, LineIndex, Lyric.WordTimings);
+	MaterializeWords(EDreamLyricWordChannel::Romanization, LineIndex, Lyric.RomanizationWordTimings);
+
+	// 轨道之外的每一份歌词都是深拷贝, 计入统计
+	FDreamLyricStats::RecordLinesCopied(1, FDreamLyricStats::GetAllocatedSize(Lyric));
+	return Lyric;
+}
+
+FDreamMusicLyricWord FDreamLyricTrack::MaterializeWord(EDreamLyricWordChannel Channel, int32 WordIndex) const
+{
+	const FWordTable& Table = GetWordTable(Channel);
+	if (!Table.StartTimes.IsValidIndex(WordIndex))
+	{
+		return FDreamMusicLyricWord();
+	}
+
+	return FDreamMusicLyricWord(FDreamMusicLyricTimestamp(Table.StartTimes[WordIndex]),
+	                            FDreamMusicLyricTimestamp(Table.EndTimes[WordIndex]),
+	                            FString(GetText(Table.TextSpans[WordIndex])));
+}
+
+void FDreamLyricTrack::MaterializeWords(EDreamLyricWordChannel Channel, int32 LineIndex, TArray<FDreamMusicLyricWord>& OutWords) const
+{
+	const int32 Begin = GetLineWordBegin(Channel, LineIndex);
+	const int32 Count = GetLineWordCount(Channel, LineIndex);
+
+	OutWords.Reset(Count);
+	for (int32 WordIndex = Begin; WordIndex < Begin + Count; WordIndex++)
+	{
+		OutWords.Add(MaterializeWord(Channel, WordIndex));
+	}
+}
+
+void FDreamLyricTrack::MaterializeLines(TArray<FDreamMusicLyric>& OutLyrics) const
+{
+	OutLyrics.Reset(NumLines());
+	for (int32 LineIndex = 0; LineIndex < NumLines(); LineIndex++)
+	{
+		OutLyrics.Add(MaterializeLine(LineIndex));
+	}
+}
+
+SIZE_T FDreamLyricTrack::GetAllocatedSize() const
+{
+	SIZE_T Size = LineStartTimes.GetAllocatedSize()
+		+ LineEndTimes.GetAllocatedSize()
+		+ LineContentSpans.GetAllocatedSize()
+		+ LineTranslateSpans.GetAllocatedSize()
+		+ LineRomanizationSpans.GetAllocatedSize()
+		+ EmptyLineFlags.GetAllocatedSize()
+		+ TextPool.GetAllocatedSize()
+		+ TimelineTimes.GetAllocatedSize()
+		+ TimelineLineOffsets.GetAllocatedSize()
+		+ TimelineLines.GetAllocatedSize();
+
+	for (const FWordTable& Table : WordTables)
+	{
+		Size += Table.GetAllocatedSize();
+	}
+
+	for (const FSegmentTable& Table : SegmentTables)
+	{
+		Size += Table.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+void FDreamLyricTrack::Serialize(FArchive& Ar)
+{
+	SerializeFlatArray(Ar, LineStartTimes);
+	SerializeFlatArray(Ar, LineEndTimes);
+	SerializeFlatArray(Ar, LineContentSpans);
+	SerializeFlatArray(Ar, LineTranslateSpans);
+	SerializeFlatArray(Ar, LineRomanizationSpans);
+	Ar << EmptyLineFlags;
+
+	for (FWordTable& Table : WordTables)
+	{
+		SerializeFlatArray(Ar, Table.StartTimes);
+		SerializeFlatArray(Ar, Table.EndTimes);
+		SerializeFlatArray(Ar, Table.TextSpans);
+		SerializeFlatArray(Ar, Table.LineWordOffsets);
+	}
+
+	SerializeFlatArray(Ar, TextPool);
+
+	// 损坏的缓存不允许产生越界的轨道
+	if (Ar.IsLoading() && !Ar.IsError())
+	{
+		const int32 LineCount = LineStartTimes.Num();
+		bool bValid = LineEndTimes.Num() == LineCount
+			&& LineContentSpans.Num() == LineCount
+			&& LineTranslateSpans.Num() == LineCount
+			&& LineRomanizationSpans.Num() == LineCount
+			&& EmptyLineFlags.Num() == LineCount;
+
+		auto IsValidSpan = [this](const FDreamLyricTextSpan& Span)
+		{
+			return Span.Offset >= 0 && Span.Length >= 0 && Span.Offset + Span.Length <= TextPool.Num();
+		};
+
+		for (int32 LineIndex = 0; bValid && LineIndex < LineCount; LineIndex++)
+		{
+			bValid = IsValidSpan(LineContentSpans[LineIndex]) && IsValidSpan(LineTranslateSpans[LineIndex]) && IsValidSpan(LineRomanizationSpans[LineIndex]);
+		}
+
+		for (const FWordTable& Table : WordTables)
+		{
+			bValid = bValid
+				&& Table.LineWordOffsets.Num() == LineCount + 1
+				&& Table.EndTimes.Num() == Table.StartTimes.Num()
+				&& Table.TextSpans.Num() == Table.StartTimes.Num()
+				&& Table.LineWordOffsets[0] == 0
+				&& Table.LineWordOffsets.Last() == Table.StartTimes.Num();
+
+			for (int32 LineIndex = 0; bValid && LineIndex < LineCount; LineIndex++)
+			{
+				bValid = Table.LineWordOffsets[LineIndex] <= Table.LineWordOffsets[LineIndex + 1];
+			}
+
+			for (int32 WordIndex = 0; bValid && WordIndex < Table.TextSpans.Num(); WordIndex++)
+			{
+				bValid = IsValidSpan(Table.TextSpans[WordIndex]);
+			}
+		}
+
+		if (!bValid)
+		{
+			Ar.SetError();
+			*this = FDreamLyricTrack();
+		}
+		else
+		{
+			for (FWordTable& Table : WordTables)
+			{
+				Table.BuildElapsedBefore();
+			}
+			BuildTimeline();
+			BuildSegments();
+
+			FDreamLyricStats::RecordTrack(GetAllocatedSize());
+		}
+	}
+}
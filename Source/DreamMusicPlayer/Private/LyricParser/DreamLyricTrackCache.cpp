@@ -0,0 +1,170 @@
+﻿#include "LyricParser/DreamLyricTrackCache.h"
+
+#include "LyricParser/DreamLyricParser.h"
+#include "LyricParser/DreamLyricTrack.h"
+#include "LyricParser/DreamLyricTimingSynthesizer.h"
+#include "DreamMusicPlayerLog.h"
+#include "DreamMusicPlayerSettings.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+
+namespace
+{
+	// 条目数上限只用于 TLruCache 的容量, 实际由内存预算限制
+	constexpr int32 MaxCachedTracks = 4096;
+
+	FAutoConsoleCommand GDumpTrackCacheCommand(
+		TEXT("DreamMusicPlayer.Lyric.TrackCache"),
+		TEXT("Print lyric track cache usage"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			DMP_LOG(Display, TEXT("Lyric Track Cache: %s"), *FDreamLyricTrackCache::Get().GetStatsString());
+		}));
+
+	FAutoConsoleCommand GClearTrackCacheCommand(
+		TEXT("DreamMusicPlayer.Lyric.ClearTrackCache"),
+		TEXT("Drop every cached lyric track"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FDreamLyricTrackCache::Get().Empty();
+		}));
+}
+
+FDreamLyricTrackCache& FDreamLyricTrackCache::Get()
+{
+	static FDreamLyricTrackCache Instance;
+	return Instance;
+}
+
+FDreamLyricTrackCache::FDreamLyricTrackCache()
+	: Entries(MaxCachedTracks)
+{
+}
+
+bool FDreamLyricTrackCache::MakeKey(const FString& FilePath,
+                                    EDreamMusicPlayerLyricParseFileType FileType,
+                                    EDreamMusicPlayerLyricParseLineType LineType,
+                                    EDreamMusicPlayerLrcLyricType LrcLyricType,
+                                    FDreamLyricTrackCacheKey& OutKey)
+{
+	OutKey.FilePath = FilePath;
+	OutKey.FileType = FileType;
+	OutKey.LineType = LineType;
+	OutKey.LrcLyricType = LrcLyricType;
+	OutKey.bSynthesizeWordTimings = FDreamLyricTimingSynthesizer::IsEnabled();
+
+	const FFileStatData SourceStat = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*FilePath);
+	if (!SourceStat.bIsValid || SourceStat.bIsDirectory)
+	{
+		return false;
+	}
+
+	OutKey.SourceTimestamp = SourceStat.ModificationTime;
+	OutKey.SourceSize = SourceStat.FileSize;
+	return true;
+}
+
+TSharedPtr<const FDreamLyricTrack> FDreamLyricTrackCache::Find(const FDreamLyricTrackCacheKey& Key)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	if (const FEntry* Entry = Entries.FindAndTouch(Key))
+	{
+		NumHits++;
+		return Entry->Track;
+	}
+
+	NumMisses++;
+	return nullptr;
+}
+
+TSharedPtr<const FDreamLyricTrack> FDreamLyricTrackCache::Add(const FDreamLyricTrackCacheKey& Key, TSharedPtr<const FDreamLyricTrack> Track)
+{
+	// 空轨道 (文件无效或解析失败) 不缓存, 文件修复后即可重新解析
+	if (!Track.IsValid() || Track->IsEmpty())
+	{
+		return Track;
+	}
+
+	const int64 BudgetBytes = GetBudgetBytes();
+	const int64 TrackBytes = static_cast<int64>(Track->GetAllocatedSize());
+
+	FScopeLock ScopeLock(&Lock);
+
+	if (const FEntry* Existing = Entries.FindAndTouch(Key))
+	{
+		return Existing->Track;
+	}
+
+	if (TrackBytes > BudgetBytes)
+	{
+		return Track;
+	}
+
+	EvictToBudget(BudgetBytes, TrackBytes);
+
+	UsedBytes += TrackBytes;
+	Entries.Add(Key, FEntry{Track, TrackBytes});
+	return Track;
+}
+
+TSharedPtr<const FDreamLyricTrack> FDreamLyricTrackCache::FindOrLoad(const FString& FilePath,
+                                                                     EDreamMusicPlayerLyricParseFileType FileType,
+                                                                     EDreamMusicPlayerLyricParseLineType LineType,
+                                                                     EDreamMusicPlayerLrcLyricType LrcLyricType)
+{
+	FDreamLyricTrackCacheKey Key;
+	const bool bHasKey = MakeKey(FilePath, FileType, LineType, LrcLyricType, Key);
+
+	if (bHasKey)
+	{
+		if (TSharedPtr<const FDreamLyricTrack> Track = Find(Key))
+		{
+			return Track;
+		}
+	}
+
+	FDreamLyricParser Parser(FilePath, FileType, LineType, LrcLyricType);
+	return bHasKey ? Add(Key, Parser.GetTrack()) : Parser.GetTrack();
+}
+
+void FDreamLyricTrackCache::Empty()
+{
+	FScopeLock ScopeLock(&Lock);
+	Entries.Empty(MaxCachedTracks);
+	UsedBytes = 0;
+}
+
+int32 FDreamLyricTrackCache::Num() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Entries.Num();
+}
+
+int64 FDreamLyricTrackCache::GetUsedBytes() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return UsedBytes;
+}
+
+FString FDreamLyricTrackCache::GetStatsString() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return FString::Printf(TEXT("Tracks=%d Used=%.2f MB Budget=%.2f MB Hits=%lld Misses=%lld Evictions=%lld"),
+	                       Entries.Num(), UsedBytes / (1024.0 * 1024.0), GetBudgetBytes() / (1024.0 * 1024.0), NumHits, NumMisses, NumEvictions);
+}
+
+int64 FDreamLyricTrackCache::GetBudgetBytes()
+{
+	return static_cast<int64>(FMath::Max(GetDefault<UDreamMusicPlayerSettings>()->LyricTrackCacheBudgetMB, 0)) * 1024 * 1024;
+}
+
+void FDreamLyricTrackCache::EvictToBudget(int64 BudgetBytes, int64 IncomingBytes)
+{
+	while (Entries.Num() > 0 && (UsedBytes + IncomingBytes > BudgetBytes || Entries.Num() >= Entries.Max()))
+	{
+		const FEntry Evicted = Entries.RemoveLeastRecent();
+		UsedBytes -= Evicted.Bytes;
+		NumEvictions++;
+	}
+}
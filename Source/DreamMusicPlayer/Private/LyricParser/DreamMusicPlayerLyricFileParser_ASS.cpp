@@ -1,339 +1,221 @@
 ﻿#include "DreamMusicPlayerLog.h"
 #include "LyricParser/DreamMusicPlayerLyricFileParser.h"
+#include "LyricParser/DreamLyricTimestampScanner.h"
 
-void FDreamMusicPlayerLyricFileParser_ASS::Parse()
+namespace
 {
-	bool bIsEvent = false;
-
-	for (const FString& SourceLine : Lines)
+	/**
+	 * 将 Dialogue 内容按逗号切分为 NumFields 个字段视图, 最后一个字段 (Text) 保留剩余全部内容 (文本中可能含有逗号)
+	 */
+	bool SplitDialogueFields(FStringView DialogueContent, int32 NumFields, TArray<FStringView, TInlineAllocator<10>>& OutFields)
 	{
-		FString Line = SourceLine.TrimStartAndEnd();
+		OutFields.Reset();
 
-		if (Line == TEXT("[Events]"))
+		int32 FieldStart = 0;
+		for (int32 Index = 0; Index < DialogueContent.Len() && OutFields.Num() < NumFields - 1; Index++)
 		{
-			bIsEvent = true;
-			continue;
-		}
-
-		if (bIsEvent && Line.StartsWith(TEXT("Dialogue:"), ESearchCase::CaseSensitive))
-		{
-			// 跳过"Dialogue:"部分
-			FString DialogueContent = Line.RightChop(9);
-
-			// 按逗号分割字段
-			TArray<FString> Parts;
-			DialogueContent.ParseIntoArray(Parts, TEXT(","), false);
-
-			if (Parts.Num() < 10)
-			{
-				DMP_LOG(Warning, TEXT("Invalid Dialogue Line: %s Parts: %d"), *Line, Parts.Num())
-				continue;
-			}
-
-			// 获取时间信息和样式
-			FString StartTimeStr = Parts[1];
-			FString EndTimeStr = Parts[2];
-			FString Style = Parts[3]; // Style类型: orig, ts, roma
-			FString Text = Parts[9];
-
-			// 处理可能被逗号分割的文本部分
-			for (int32 i = 10; i < Parts.Num(); i++)
-			{
-				Text += TEXT(",") + Parts[i];
-			}
-
-			DMP_LOG(Log, TEXT("Parsing Dialogue - Style: %s, Start: %s, End: %s, Text: %s"),
-			        *Style, *StartTimeStr, *EndTimeStr, *Text);
-
-			// 解析时间戳 (ASS格式: HH:MM:SS.cc 或 HH:MM:SS.fff)
-			FDreamMusicLyricTimestamp StartTimestamp = ParseASSTimestamp(StartTimeStr);
-			FDreamMusicLyricTimestamp EndTimestamp = ParseASSTimestamp(EndTimeStr);
-
-			DMP_LOG(Log, TEXT("Parsed Timestamps - Start ms: %d, End ms: %d"),
-			        StartTimestamp.ToMilliseconds(), EndTimestamp.ToMilliseconds());
-
-			// 根据样式类型处理
-			if (Style == TEXT("orig"))
-			{
-				// 查找是否已存在相同时间的歌词行
-				FDreamMusicLyric* ExistingLyric = nullptr;
-				for (FDreamMusicLyric& Lyric : ParsedLyrics)
-				{
-					if (Lyric.StartTimestamp.ToMilliseconds() == StartTimestamp.ToMilliseconds())
-					{
-						ExistingLyric = &Lyric;
-						break;
-					}
-				}
-
-				if (ExistingLyric)
-				{
-					// 如果已存在，更新原文内容
-					ExistingLyric->Content = Text;
-					ExistingLyric->EndTimestamp = EndTimestamp;
-				}
-				else
-				{
-					// 创建新的歌词行
-					FDreamMusicLyric Lyric;
-					Lyric.StartTimestamp = StartTimestamp;
-					Lyric.EndTimestamp = EndTimestamp;
-					Lyric.Content = Text;
-					ParsedLyrics.Add(Lyric);
-				}
-			}
-			else if (Style == TEXT("ts"))
-			{
-				// 查找对应的原文行
-				bool bFound = false;
-				for (FDreamMusicLyric& Lyric : ParsedLyrics)
-				{
-					if (Lyric.StartTimestamp.ToMilliseconds() == StartTimestamp.ToMilliseconds())
-					{
-						Lyric.Translate = Text;
-						bFound = true;
-						break;
-					}
-				}
-
-				// 如果没有找到对应的原文行，则创建新的
-				if (!bFound)
-				{
-					FDreamMusicLyric Lyric;
-					Lyric.StartTimestamp = StartTimestamp;
-					Lyric.EndTimestamp = EndTimestamp;
-					Lyric.Translate = Text;
-					ParsedLyrics.Add(Lyric);
-				}
-			}
-			else if (Style == TEXT("roma"))
+			if (DialogueContent[Index] == TEXT(','))
 			{
-				// 查找对应的原文行
-				bool bFound = false;
-				for (FDreamMusicLyric& Lyric : ParsedLyrics)
-				{
-					if (Lyric.StartTimestamp.ToMilliseconds() == StartTimestamp.ToMilliseconds())
-					{
-						Lyric.Romanization = Text;
-						// 同时处理罗马音的卡拉OK标签
-						ProcessRomanizationKaraokeTags(Lyric);
-						bFound = true;
-						break;
-					}
-				}
-
-				// 如果没有找到对应的原文行，则创建新的
-				if (!bFound)
-				{
-					FDreamMusicLyric Lyric;
-					Lyric.StartTimestamp = StartTimestamp;
-					Lyric.EndTimestamp = EndTimestamp;
-					Lyric.Romanization = Text;
-					// 处理罗马音的卡拉OK标签
-					ProcessRomanizationKaraokeTags(Lyric);
-					ParsedLyrics.Add(Lyric);
-				}
+				OutFields.Add(DialogueContent.Mid(FieldStart, Index - FieldStart));
+				FieldStart = Index + 1;
 			}
 		}
-	}
 
-	// 处理所有原文行的卡拉OK标签
-	for (FDreamMusicLyric& Lyric : ParsedLyrics)
-	{
-		if (!Lyric.Content.IsEmpty())
+		if (OutFields.Num() < NumFields - 1)
 		{
-			ProcessKaraokeTags(Lyric);
+			return false;
 		}
-	}
-}
-
-
-void FDreamMusicPlayerLyricFileParser_ASS::ProcessText(FDreamMusicLyric& Lyric)
-{
-	// 可以在这里处理卡拉OK时间标签等特殊格式
-	// 对于原文(orig)行，可以解析{\kfXX}标签获取单词时间信息
-	// 对于翻译(ts)和罗马音(roma)行，通常不需要特殊处理
 
-	if (!Lyric.Content.IsEmpty())
-	{
-		// 处理原文中的卡拉OK时间标签
-		ProcessKaraokeTags(Lyric);
+		OutFields.Add(DialogueContent.RightChop(FieldStart));
+		return true;
 	}
-}
-
-FDreamMusicLyricTimestamp FDreamMusicPlayerLyricFileParser_ASS::ParseASSTimestamp(const FString& TimestampStr)
-{
-	// ASS时间格式: HH:MM:SS.cc 或 HH:MM:SS.fff (cc是厘秒，fff是毫秒)
-	// 示例: 00:00:00.17 或 00:01:13.84
 
-	TArray<FString> TimeParts;
-	TimestampStr.ParseIntoArray(TimeParts, TEXT(":"));
-
-	if (TimeParts.Num() != 3)
+	/**
+	 * 解析卡拉OK时间标签, 例如: {\kf16}ウ{\kf19}タ{\kf8}オ
+	 * @param OutText 去除标签后的文本
+	 * @param OutWords 单词时间, 从 StartTimeMs 开始累加
+	 * @param Spans 复用的音节缓冲
+	 */
+	void ParseKaraokeText(FStringView Text, int32 StartTimeMs, FString& OutText, TArray<FDreamMusicLyricWord>& OutWords, TArray<FDreamLyricKaraokeSpan>& Spans)
 	{
-		return FDreamMusicLyricTimestamp();
-	}
+		FString CleanText;
+		Spans.Reset();
+		FDreamLyricKaraokeTokenizer::Tokenize(Text, CleanText, Spans);
 
-	int32 Hours = FCString::Atoi(*TimeParts[0]);
-	int32 Minutes = FCString::Atoi(*TimeParts[1]);
+		// 清除已存在的单词时间信息
+		OutWords.Reset(Spans.Num());
 
-	// 处理秒和小数部分
-	FString SecondPart = TimeParts[2];
-	TArray<FString> SecondParts;
-	SecondPart.ParseIntoArray(SecondParts, TEXT("."));
-
-	int32 Seconds = FCString::Atoi(*SecondParts[0]);
-	int32 Milliseconds = 0;
-
-	if (SecondParts.Num() > 1)
-	{
-		FString Fraction = SecondParts[1];
-		if (Fraction.Len() == 2)
-		{
-			// 厘秒格式 (cc)，需要转换为毫秒
-			Milliseconds = FCString::Atoi(*Fraction) * 10;
-		}
-		else if (Fraction.Len() == 3)
-		{
-			// 毫秒格式 (fff)
-			Milliseconds = FCString::Atoi(*Fraction);
-		}
-		else if (Fraction.Len() == 1)
+		const FStringView CleanView(CleanText);
+		for (const FDreamLyricKaraokeSpan& Span : Spans)
 		{
-			// 十分之一秒格式 (c)
-			Milliseconds = FCString::Atoi(*Fraction) * 100;
+			// 厘秒转换为毫秒
+			OutWords.Emplace(FDreamMusicLyricTimestamp::FromMilliseconds(StartTimeMs + Span.StartCentiseconds * 10),
+			                 FDreamMusicLyricTimestamp::FromMilliseconds(StartTimeMs + Span.EndCentiseconds * 10),
+			                 FString(CleanView.Mid(Span.TextOffset, Span.TextLength)));
 		}
-	}
 
-	return FDreamMusicLyricTimestamp(Hours, Minutes, Seconds, Milliseconds);
+		OutText = MoveTemp(CleanText);
+	}
 }
 
-void FDreamMusicPlayerLyricFileParser_ASS::ProcessKaraokeTags(FDreamMusicLyric& Lyric)
+bool FDreamMusicPlayerLyricFileParser_ASS::FEventFormat::IsValid() const
 {
-	// 解析原文中的卡拉OK时间标签，例如: {\kf16}ウ{\kf19}タ{\kf8}オ
-	FString Text = Lyric.Content;
-
-	// 使用正则表达式查找{\kfXX}标签
-	FRegexPattern Pattern(TEXT("\\{\\\\kf(\\d+)\\}([^\\{]*)"));
-	FRegexMatcher Matcher(Pattern, Text);
-
-	int32 CurrentTimeMs = Lyric.StartTimestamp.ToMilliseconds();
-
-	// 清除已存在的单词时间信息
-	Lyric.WordTimings.Empty();
+	// Text 必须是最后一个字段 (文本中可能含有逗号)
+	return StartIndex >= 0 && EndIndex >= 0 && StyleIndex >= 0 && TextIndex == NumFields - 1;
+}
 
-	FString CleanText = TEXT(""); // 构建清理后的文本
+void FDreamMusicPlayerLyricFileParser_ASS::FEventFormat::ParseFormatLine(FStringView FormatLine)
+{
+	FStringView FormatFields = FormatLine;
+	FEventFormat Parsed;
+	Parsed.NumFields = 0;
+	Parsed.StartIndex = Parsed.EndIndex = Parsed.StyleIndex = Parsed.TextIndex = INDEX_NONE;
 
-	while (Matcher.FindNext())
+	while (true)
 	{
-		FString DurationStr = Matcher.GetCaptureGroup(1);
-		FString Character = Matcher.GetCaptureGroup(2);
+		int32 CommaIndex = INDEX_NONE;
+		const bool bHasComma = FormatFields.FindChar(TEXT(','), CommaIndex);
+		const FStringView FieldName = (bHasComma ? FormatFields.Left(CommaIndex) : FormatFields).TrimStartAndEnd();
 
-		// 处理可能的空字符情况
-		if (Character.IsEmpty())
-			continue;
-
-		int32 Duration = FCString::Atoi(*DurationStr) * 10; // 转换为毫秒
-
-		FDreamMusicLyricTimestamp StartTs, EndTs;
-		// 根据毫秒数计算出时分秒
-		StartTs.Millisecond = CurrentTimeMs % 1000;
-		StartTs.Seconds = (CurrentTimeMs / 1000) % 60;
-		StartTs.Minute = (CurrentTimeMs / 60000) % 60;
-		StartTs.Hours = CurrentTimeMs / 3600000;
-
-		int32 EndTimeMs = CurrentTimeMs + Duration;
-		EndTs.Millisecond = EndTimeMs % 1000;
-		EndTs.Seconds = (EndTimeMs / 1000) % 60;
-		EndTs.Minute = (EndTimeMs / 60000) % 60;
-		EndTs.Hours = EndTimeMs / 3600000;
+		if (FieldName.Equals(TEXT("Start"), ESearchCase::IgnoreCase)) Parsed.StartIndex = Parsed.NumFields;
+		else if (FieldName.Equals(TEXT("End"), ESearchCase::IgnoreCase)) Parsed.EndIndex = Parsed.NumFields;
+		else if (FieldName.Equals(TEXT("Style"), ESearchCase::IgnoreCase)) Parsed.StyleIndex = Parsed.NumFields;
+		else if (FieldName.Equals(TEXT("Text"), ESearchCase::IgnoreCase)) Parsed.TextIndex = Parsed.NumFields;
+		Parsed.NumFields++;
 
-		FDreamMusicLyricWord Word(StartTs, EndTs, Character);
-		Lyric.WordTimings.Add(Word);
-
-		// 构建清理后的文本
-		CleanText += Character;
-
-		CurrentTimeMs = EndTimeMs;
+		if (!bHasComma)
+		{
+			break;
+		}
+		FormatFields.RightChopInline(CommaIndex + 1);
 	}
 
-	// 如果解析到了带标签的内容，使用清理后的文本
-	if (Lyric.WordTimings.Num() > 0)
+	if (Parsed.IsValid())
 	{
-		Lyric.Content = CleanText;
+		*this = Parsed;
 	}
 	else
 	{
-		// 如果没有找到标签，尝试清理可能残留的标签
-		FString CleanedText = Text;
-		CleanedText = CleanedText.Replace(TEXT("{\\kf"), TEXT(""));
-		CleanedText = CleanedText.Replace(TEXT("{"), TEXT(""));
-		CleanedText = CleanedText.Replace(TEXT("}"), TEXT(""));
-		Lyric.Content = CleanedText;
+		DMP_LOG(Warning, TEXT("Unsupported ASS event format, using default field order: %.*s"), FormatLine.Len(), FormatLine.GetData());
 	}
 }
 
-void FDreamMusicPlayerLyricFileParser_ASS::ProcessRomanizationKaraokeTags(FDreamMusicLyric& Lyric)
+void FDreamMusicPlayerLyricFileParser_ASS::Parse()
 {
-	// 解析罗马音中的卡拉OK时间标签，例如: {\kf16}u {\kf19}ta {\kf8}o
-	FString Text = Lyric.Romanization;
+	LyricSlotsByStartTime.Reserve(Lines.Num() / 2);
+	ParseLines(Lines);
 
-	// 使用正则表达式查找{\kfXX}标签
-	FRegexPattern Pattern(TEXT("\\{\\\\kf(\\d+)\\}([^\\{]*)"));
-	FRegexMatcher Matcher(Pattern, Text);
+	DMP_LOG(Log, TEXT("ASS Parser: %d dialogue groups"), ParsedLyrics.Num());
+}
 
-	int32 CurrentTimeMs = Lyric.StartTimestamp.ToMilliseconds();
+FDreamMusicLyric& FDreamMusicPlayerLyricFileParser_ASS::FindOrAddLyric(FDreamLyricTime StartTime, FDreamLyricTime EndTime, EDreamLyricField Field)
+{
+	const uint8 FieldBit = 1 << static_cast<uint8>(Field);
+
+	TArray<FLyricSlot, TInlineAllocator<1>>& Slots = LyricSlotsByStartTime.FindOrAdd(StartTime.Milliseconds);
+	for (FLyricSlot& Slot : Slots)
+	{
+		if ((Slot.FilledFields & FieldBit) == 0)
+		{
+			Slot.FilledFields |= FieldBit;
+			return ParsedLyrics[Slot.LyricIndex];
+		}
+	}
 
-	// 清除已存在的罗马音单词时间信息
-	Lyric.RomanizationWordTimings.Empty();
+	Slots.Add({ParsedLyrics.Num(), FieldBit});
+	SourceOrder.Add(StartTime);
+	FDreamMusicLyric& Lyric = ParsedLyrics.AddDefaulted_GetRef();
+	Lyric.StartTimestamp = FDreamMusicLyricTimestamp(StartTime);
+	Lyric.EndTimestamp = FDreamMusicLyricTimestamp(EndTime);
+	return Lyric;
+}
 
-	FString CleanText = TEXT(""); // 构建清理后的文本
+void FDreamMusicPlayerLyricFileParser_ASS::ParseLines(TConstArrayView<FStringView> InLines)
+{
+	TArray<FStringView, TInlineAllocator<10>> Parts;
 
-	while (Matcher.FindNext())
+	for (const FStringView SourceLine : InLines)
 	{
-		FString DurationStr = Matcher.GetCaptureGroup(1);
-		FString Character = Matcher.GetCaptureGroup(2);
+		const FStringView Line = SourceLine.TrimStartAndEnd();
 
-		// 处理可能的空字符情况
-		if (Character.IsEmpty())
+		if (Line.StartsWith(TEXT('[')))
+		{
+			bIsEvent = Line == TEXT("[Events]");
 			continue;
+		}
 
-		int32 Duration = FCString::Atoi(*DurationStr) * 10; // 转换为毫秒
+		if (!bIsEvent)
+		{
+			continue;
+		}
 
-		FDreamMusicLyricTimestamp StartTs, EndTs;
-		// 根据毫秒数计算出时分秒
-		StartTs.Millisecond = CurrentTimeMs % 1000;
-		StartTs.Seconds = (CurrentTimeMs / 1000) % 60;
-		StartTs.Minute = (CurrentTimeMs / 60000) % 60;
-		StartTs.Hours = CurrentTimeMs / 3600000;
+		if (Line.StartsWith(TEXTVIEW("Format:"), ESearchCase::CaseSensitive))
+		{
+			EventFormat.ParseFormatLine(Line.RightChop(7));
+			continue;
+		}
 
-		int32 EndTimeMs = CurrentTimeMs + Duration;
-		EndTs.Millisecond = EndTimeMs % 1000;
-		EndTs.Seconds = (EndTimeMs / 1000) % 60;
-		EndTs.Minute = (EndTimeMs / 60000) % 60;
-		EndTs.Hours = EndTimeMs / 3600000;
+		if (Line.StartsWith(TEXTVIEW("Dialogue:"), ESearchCase::CaseSensitive))
+		{
+			// 跳过"Dialogue:"部分, 按 Format: 描述的字段数分割
+			if (!SplitDialogueFields(Line.RightChop(9), EventFormat.NumFields, Parts))
+			{
+				DMP_LOG(Warning, TEXT("Invalid Dialogue Line: %.*s Parts: %d"), Line.Len(), Line.GetData(), Parts.Num())
+				continue;
+			}
 
-		FDreamMusicLyricWord Word(StartTs, EndTs, Character);
-		Lyric.RomanizationWordTimings.Add(Word);
+			// 获取时间信息和样式
+			const FStringView StartTimeStr = Parts[EventFormat.StartIndex];
+			const FStringView EndTimeStr = Parts[EventFormat.EndIndex];
+			const FStringView Style = Parts[EventFormat.StyleIndex].TrimStartAndEnd(); // Style类型: orig, ts, roma
+			const FStringView Text = Parts[EventFormat.TextIndex];
 
-		// 构建清理后的文本
-		CleanText += Character;
+			// 解析时间戳 (ASS格式: HH:MM:SS.cc 或 HH:MM:SS.fff)
+			const FDreamLyricTime StartTime = ParseASSTimestamp(StartTimeStr).ToTime();
+			const FDreamLyricTime EndTime = ParseASSTimestamp(EndTimeStr).ToTime();
 
-		CurrentTimeMs = EndTimeMs;
+			// 根据样式类型处理, 卡拉OK标签在读取时直接处理, 不再额外遍历
+			if (Style == TEXT("orig"))
+			{
+				// 已由同一时间的 ts / roma 建立时填入该行, 否则 (包括对唱的第二行 orig) 新建一行
+				FDreamMusicLyric& Lyric = FindOrAddLyric(StartTime, EndTime, EDreamLyricField::Content);
+				Lyric.EndTimestamp = FDreamMusicLyricTimestamp(EndTime);
+				ProcessKaraokeTags(Lyric, Text);
+			}
+			else if (Style == TEXT("ts"))
+			{
+				FDreamMusicLyric& Lyric = FindOrAddLyric(StartTime, EndTime, EDreamLyricField::Translate);
+				Lyric.Translate = FString(Text);
+			}
+			else if (Style == TEXT("roma"))
+			{
+				FDreamMusicLyric& Lyric = FindOrAddLyric(StartTime, EndTime, EDreamLyricField::Romanization);
+				ProcessRomanizationKaraokeTags(Lyric, Text);
+			}
+		}
 	}
+}
 
-	// 如果解析到了带标签的内容，使用清理后的文本
-	if (Lyric.RomanizationWordTimings.Num() > 0)
-	{
-		Lyric.Romanization = CleanText;
-	}
-	else
+
+FDreamMusicLyricTimestamp FDreamMusicPlayerLyricFileParser_ASS::ParseASSTimestamp(FStringView TimestampStr)
+{
+	// ASS时间格式: H:MM:SS.cc 或 HH:MM:SS.fff (cc是厘秒，fff是毫秒)
+	// 示例: 0:00:00.17 或 00:01:13.84
+	FDreamLyricTime Time;
+	if (FDreamLyricTimestampScanner::ScanClock(TimestampStr.TrimStartAndEnd(), Time) == 0)
 	{
-		// 如果没有找到标签，尝试清理可能残留的标签
-		FString CleanedText = Text;
-		CleanedText = CleanedText.Replace(TEXT("{\\kf"), TEXT(""));
-		CleanedText = CleanedText.Replace(TEXT("{"), TEXT(""));
-		CleanedText = CleanedText.Replace(TEXT("}"), TEXT(""));
-		Lyric.Romanization = CleanedText;
+		return FDreamMusicLyricTimestamp();
 	}
+
+	return FDreamMusicLyricTimestamp(Time);
+}
+
+void FDreamMusicPlayerLyricFileParser_ASS::ProcessKaraokeTags(FDreamMusicLyric& Lyric, FStringView Text)
+{
+	ParseKaraokeText(Text, Lyric.StartTimestamp.ToMilliseconds(), Lyric.Content, Lyric.WordTimings, KaraokeSpans);
+}
+
+void FDreamMusicPlayerLyricFileParser_ASS::ProcessRomanizationKaraokeTags(FDreamMusicLyric& Lyric, FStringView Text)
+{
+	ParseKaraokeText(Text, Lyric.StartTimestamp.ToMilliseconds(), Lyric.Romanization, Lyric.RomanizationWordTimings, KaraokeSpans);
 }
@@ -1,51 +1,172 @@
 ﻿#include "LyricParser/DreamMusicPlayerLyricFileParser.h"
+#include "LyricParser/DreamLyricTimestampScanner.h"
 #include "DreamMusicPlayerLog.h"
+#include "Algo/Sort.h"
+
+namespace
+{
+	// 一行带时间标签的歌词; 按 (TimeMs, Order) 排序即为保持文件顺序的稳定分组
+	struct FLrcTimedLine
+	{
+		int32 TimeMs;
+		int32 Order;
+		FStringView Line;
+	};
+
+	void ApplyOffset(TArray<FDreamMusicLyricWord>& Words, int32 OffsetMs)
+	{
+		for (FDreamMusicLyricWord& Word : Words)
+		{
+			Word.StartTimestamp = FDreamMusicLyricTimestamp::FromMilliseconds(FMath::Max(Word.StartTimestamp.ToMilliseconds() - OffsetMs, 0));
+			Word.EndTimestamp = FDreamMusicLyricTimestamp::FromMilliseconds(FMath::Max(Word.EndTimestamp.ToMilliseconds() - OffsetMs, 0));
+		}
+	}
+}
 
 // Enhanced FDreamMusicPlayerLyricFileParser_LRC::Parse() method
 void FDreamMusicPlayerLyricFileParser_LRC::Parse()
 {
-	ParsedLyrics.Empty();
-
-	// Collect valid lines
-	TArray<FString> ValidLines;
-	for (const FString& Line : Lines)
+	ParsedLyrics.Reset();
+	MetaData.Reset();
+	OffsetMs = 0;
+
+	// 未指定类型时, 在同一次扫描中根据第一行带逐字标签的歌词判断
+	const bool bDetectParseMethod = ParseMethod == EDreamMusicPlayerLrcLyricType::None;
+	bool bHasWordTags = false;
+	bool bHasESLyricTags = false;
+
+	// Single pass: every line is trimmed and scanned once, the tag time is the integer group key
+	TArray<FLrcTimedLine> TimedLines;
+	TimedLines.Reserve(Lines.Num());
+
+	bool bSorted = true;
+	TSet<int32> SeenTimes;
+	for (const FStringView SourceLine : Lines)
 	{
-		FString TrimmedLine = Line.TrimStartAndEnd();
-		if (TrimmedLine.IsEmpty() || IsMetadataLine(TrimmedLine))
+		const FStringView Line = SourceLine.TrimStartAndEnd();
+		if (Line.IsEmpty() || Line[0] != TEXT('['))
+		{
+			continue;
+		}
+
+		// 元数据标签 ([ar:xxx], [offset:+100] ...) 以字母开头, 不会是时间标签
+		if (Line.Len() > 1 && FChar::IsAlpha(Line[1]))
+		{
+			ReadMetadataLine(Line);
+			continue;
+		}
+
+		FDreamLyricTime Time;
+		int32 TagStart = 0;
+		int32 TagLength = 0;
+		if (!FDreamLyricTimestampScanner::FindTag(Line, TEXT('['), TEXT(']'), Time, TagStart, TagLength))
 		{
 			continue;
 		}
 
-		if (TrimmedLine.StartsWith(TEXT("[")) && TrimmedLine.Contains(TEXT("]")))
+		if (bDetectParseMethod && !bHasWordTags && !bHasESLyricTags)
 		{
-			ValidLines.Add(TrimmedLine);
+			const FStringView Rest = Line.RightChop(TagStart + TagLength);
+			FDreamLyricTime WordTime;
+			int32 WordTagStart = 0;
+			int32 WordTagLength = 0;
+
+			if (FDreamLyricTimestampScanner::FindTag(Rest, TEXT('<'), TEXT('>'), WordTime, WordTagStart, WordTagLength))
+			{
+				bHasESLyricTags = true;
+			}
+			// 紧跟在行标签后的时间标签是重复行 ([00:12.00][00:45.00]...), 不是逐字
+			else if (FDreamLyricTimestampScanner::FindTag(Rest, TEXT('['), TEXT(']'), WordTime, WordTagStart, WordTagLength) && WordTagStart > 0)
+			{
+				bHasWordTags = true;
+			}
+		}
+
+		if (!TimedLines.IsEmpty() && Time.Milliseconds < TimedLines.Last().TimeMs)
+		{
+			bSorted = false;
+		}
+
+		// 与前面某行时间相同的是同一组的翻译 / 音译行 (可能整块写在原文之后), 不算乱序
+		// 时间集合只在第一次时间倒退时建立, 有序文件不需要
+		if (Time < SourceOrder.LastStartTime && SeenTimes.IsEmpty())
+		{
+			SeenTimes.Reserve(Lines.Num());
+			for (const FLrcTimedLine& TimedLine : TimedLines)
+			{
+				SeenTimes.Add(TimedLine.TimeMs);
+			}
 		}
+
+		if (SeenTimes.IsEmpty())
+		{
+			SourceOrder.Add(Time);
+		}
+		else
+		{
+			bool bAlreadySeen = false;
+			SeenTimes.Add(Time.Milliseconds, &bAlreadySeen);
+			if (!bAlreadySeen || Time >= SourceOrder.LastStartTime)
+			{
+				SourceOrder.Add(Time);
+			}
+		}
+
+		// 行视图从时间标签开始, 后续处理无需再次搜索标签
+		TimedLines.Add({Time.Milliseconds, TimedLines.Num(), Line.RightChop(TagStart)});
 	}
 
-	// Group lines by timestamp
-	TMap<FString, TArray<FString>> LinesByTimestamp;
-	for (const FString& Line : ValidLines)
+	// 大多数文件已按时间排列, 只有乱序时才需要排序
+	if (!bSorted)
 	{
-		FString Timestamp = ExtractTimestampFromLine(Line);
-		if (!Timestamp.IsEmpty())
+		Algo::Sort(TimedLines, [](const FLrcTimedLine& A, const FLrcTimedLine& B)
 		{
-			LinesByTimestamp.FindOrAdd(Timestamp).Add(Line);
-		}
+			return A.TimeMs != B.TimeMs ? A.TimeMs < B.TimeMs : A.Order < B.Order;
+		});
 	}
 
-	// Process each group using the GroupProcessor
-	for (auto& Pair : LinesByTimestamp)
+	if (bDetectParseMethod)
 	{
-		FDreamMusicLyric Lyric = CreateLyricFromLine(Pair.Value[0]);
-		GroupProcessor.ProcessGroup(Pair.Value, Lyric);
-		ParsedLyrics.Add(Lyric);
+		ParseMethod = bHasESLyricTags ? EDreamMusicPlayerLrcLyricType::ESLyric
+			: bHasWordTags ? EDreamMusicPlayerLrcLyricType::WordByWord
+			: EDreamMusicPlayerLrcLyricType::LineByLine;
+		GroupProcessor.ParseMethod = ParseMethod;
 	}
 
-	// Sort by timestamp
-	ParsedLyrics.Sort([](const FDreamMusicLyric& A, const FDreamMusicLyric& B)
+	ParsedLyrics.Reserve(TimedLines.Num() / GroupProcessor.GetExpectedLineCount() + 1);
+
+	// Walk runs of equal time, each run is one lyric group in file order
+	TArray<FStringView, TInlineAllocator<4>> GroupLines;
+	for (int32 GroupBegin = 0; GroupBegin < TimedLines.Num();)
 	{
-		return A.StartTimestamp.ToMilliseconds() < B.StartTimestamp.ToMilliseconds();
-	});
+		const int32 GroupTimeMs = TimedLines[GroupBegin].TimeMs;
+
+		GroupLines.Reset();
+		int32 GroupEnd = GroupBegin;
+		for (; GroupEnd < TimedLines.Num() && TimedLines[GroupEnd].TimeMs == GroupTimeMs; GroupEnd++)
+		{
+			GroupLines.Add(TimedLines[GroupEnd].Line);
+		}
+
+		// offset 对所有时间做相同的平移, 不影响分组与顺序
+		const FDreamLyricTime StartTime(FMath::Max(GroupTimeMs - OffsetMs, 0));
+		FDreamMusicLyric& Lyric = ParsedLyrics.AddDefaulted_GetRef();
+		Lyric.StartTimestamp = FDreamMusicLyricTimestamp(StartTime);
+		// Set default end time
+		Lyric.EndTimestamp = FDreamMusicLyricTimestamp(StartTime + 3000);
+
+		GroupProcessor.ProcessGroup(GroupLines, Lyric);
+
+		if (OffsetMs != 0)
+		{
+			ApplyOffset(Lyric.WordTimings, OffsetMs);
+			ApplyOffset(Lyric.RomanizationWordTimings, OffsetMs);
+		}
+
+		GroupBegin = GroupEnd;
+	}
+
+	// Groups are emitted in time order, no sort needed
 
 	// **FIX: Calculate proper end timestamps for LRC lyrics**
 	UpdateEndTimestampsBasedOnWordTimings();
@@ -91,81 +212,36 @@ void FDreamMusicPlayerLyricFileParser_LRC::UpdateEndTimestampsBasedOnWordTimings
 			{
 				// For last lyric, add default duration
 				int32 DefaultDurationMs = 3000;
-				int32 EndMs = CurrentLyric.StartTimestamp.ToMilliseconds() + DefaultDurationMs;
-				CurrentLyric.EndTimestamp = FDreamMusicLyricTimestamp(
-					EndMs / 3600000,
-					(EndMs / 60000) % 60,
-					(EndMs / 1000) % 60,
-					EndMs % 1000);
+				CurrentLyric.EndTimestamp = FDreamMusicLyricTimestamp(CurrentLyric.StartTimestamp.ToTime() + DefaultDurationMs);
 			}
 		}
 	}
 }
 
-FDreamMusicLyric FDreamMusicPlayerLyricFileParser_LRC::CreateLyricFromLine(const FString& Line)
+bool FDreamMusicPlayerLyricFileParser_LRC::ReadMetadataLine(FStringView Line)
 {
-	FDreamMusicLyric Lyric;
-
-	FRegexPattern Pattern(TEXT("\\[(\\d{2}):(\\d{2})[.:](\\d{2,3})\\](.*)"));
-	FRegexMatcher Matcher(Pattern, Line);
-
-	if (Matcher.FindNext())
+	int32 ColonIndex = INDEX_NONE;
+	int32 CloseIndex = INDEX_NONE;
+	if (!Line.StartsWith(TEXT('[')) || !Line.FindChar(TEXT(':'), ColonIndex) || !Line.FindLastChar(TEXT(']'), CloseIndex) || CloseIndex < ColonIndex)
 	{
-		int32 Minutes = FCString::Atoi(*Matcher.GetCaptureGroup(1));
-		int32 Seconds = FCString::Atoi(*Matcher.GetCaptureGroup(2));
-		FString MillisecondsStr = Matcher.GetCaptureGroup(3);
-
-		int32 Milliseconds = (MillisecondsStr.Len() == 2) ? FCString::Atoi(*MillisecondsStr) * 10 : FCString::Atoi(*MillisecondsStr);
-		Lyric.StartTimestamp = FDreamMusicLyricTimestamp(Minutes, Seconds, Milliseconds);
-		
-		// Set default end time
-		int32 EndMs = Lyric.StartTimestamp.ToMilliseconds() + 3000;
-		Lyric.EndTimestamp = FDreamMusicLyricTimestamp(
-			EndMs / 3600000,
-			(EndMs / 60000) % 60,
-			(EndMs / 1000) % 60,
-			EndMs % 1000);
+		return false;
 	}
 
-	return Lyric;
-}
-
-FString FDreamMusicPlayerLyricFileParser_LRC::ExtractTimestampFromLine(const FString& Line)
-{
-	FRegexPattern Pattern(TEXT("\\[(\\d{2}):(\\d{2})[.:](\\d{2,3})\\]"));
-	FRegexMatcher Matcher(Pattern, Line);
-
-	if (Matcher.FindNext())
+	const FStringView Identifier = Line.Mid(1, ColonIndex - 1).TrimStartAndEnd();
+	const FStringView Value = Line.Mid(ColonIndex + 1, CloseIndex - ColonIndex - 1).TrimStartAndEnd();
+	if (Identifier.IsEmpty())
 	{
-		return FString::Printf(TEXT("%s:%s.%s"),
-							   *Matcher.GetCaptureGroup(1),
-							   *Matcher.GetCaptureGroup(2),
-							   *Matcher.GetCaptureGroup(3));
+		return false;
 	}
 
-	return FString();
-}
+	FString Key(Identifier);
+	Key.ToLowerInline();
 
-bool FDreamMusicPlayerLyricFileParser_LRC::IsMetadataLine(const FString& Line) const
-{
-	if (Line.StartsWith(TEXT("[")) && Line.EndsWith(TEXT("]")) && Line.Contains(TEXT(":")))
+	if (Key == TEXT("offset"))
 	{
-		FString BeforeColon;
-		FString AfterColon;
-		if (Line.Split(TEXT(":"), &BeforeColon, &AfterColon))
-		{
-			if (BeforeColon.Len() == 3 && BeforeColon.StartsWith(TEXT("[")))
-			{
-				FString Identifier = BeforeColon.Mid(1);
-				if (Identifier == TEXT("ar") || Identifier == TEXT("ti") ||
-					Identifier == TEXT("al") || Identifier == TEXT("by") ||
-					Identifier == TEXT("offset") || Identifier == TEXT("tool") ||
-					Identifier == TEXT("re") || Identifier == TEXT("ve"))
-				{
-					return true;
-				}
-			}
-		}
+		OffsetMs = FCString::Atoi(*FString(Value));
 	}
-	return false;
-}
\ No newline at end of file
+
+	MetaData.Add(MoveTemp(Key), FString(Value));
+	return true;
+}
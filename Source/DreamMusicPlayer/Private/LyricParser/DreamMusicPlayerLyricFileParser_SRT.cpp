@@ -1,7 +1,9 @@
 ﻿#include "LyricParser/DreamMusicPlayerLyricFileParser.h"
+#include "LyricParser/DreamLyricTimestampScanner.h"
 #include "DreamMusicPlayerCommon.h"
 #include "DreamMusicPlayerLog.h"
 #include "Engine/Engine.h"
+#include "String/ParseLines.h"
 
 void FDreamMusicPlayerLyricFileParser_SRT::Parse()
 {
@@ -11,119 +13,101 @@ void FDreamMusicPlayerLyricFileParser_SRT::Parse()
 		return;
 	}
 
-	FString Line;
-	FDreamMusicLyric Lyric;
-	int State = 0; // 0: number, 1: timestamp, 2: content
+	ParseLines(Lines);
+	FinishParse();
+}
 
-	for (const FString& SourceLine : Lines)
+void FDreamMusicPlayerLyricFileParser_SRT::ParseLines(TConstArrayView<FStringView> InLines)
+{
+	for (const FStringView SourceLine : InLines)
 	{
-		Line = SourceLine.TrimStartAndEnd();
+		const FStringView Line = SourceLine.TrimStartAndEnd();
 
 		if (Line.IsEmpty())
 		{
-			if (Lyric.StartTimestamp.ToMilliseconds() != 0 || Lyric.EndTimestamp.ToMilliseconds() != 0)
-			{
-				ProcessText(Lyric);
-				ParsedLyrics.Add(Lyric);
-				Lyric = FDreamMusicLyric();
-			}
-
-			State = 0;
+			FlushCue();
+			CueState = 0;
 			continue;
 		}
 
-		if (State == 0)
+		if (CueState == 0)
 		{
 			// 跳过行号
-			State = 1;
+			CueState = 1;
 		}
-		else if (State == 1)
+		else if (CueState == 1)
 		{
-			FRegexPattern Pattern(TEXT("((\\d{2}:\\d{2}:\\d{2},\\d{3})\\s*-->\\s*(\\d{2}:\\d{2}:\\d{2},\\d{3}))"));
-			FRegexMatcher Matcher(Pattern, Line);
-			if (Matcher.FindNext())
-			{
-				ParseSRTTimestamp(Line, Lyric);
-			}
-			State = 2;
+			ParseSRTTimestamp(Line, PendingCue);
+			CueState = 2;
 		}
-		else if (State == 2)
+		else if (CueState == 2)
 		{
-			if (!Lyric.Content.IsEmpty())
-			{
-				Lyric.Content += TEXT("\n"); // 保留多行内容，用换行符连接
-			}
-			Lyric.Content += Line;
+			// 保留多行内容, 在 AssignTextLines 中按 LineType 分配
+			PendingTextLines.Add(Line);
 		}
 	}
 
-	if (Lyric.StartTimestamp.ToMilliseconds() != 0 || Lyric.EndTimestamp.ToMilliseconds() != 0)
+	// 字幕块跨越两批输入时, 复制尚未输出的文本行, 本批次的行视图在返回后失效
+	if (!PendingTextLines.IsEmpty())
 	{
-		ProcessText(Lyric);
-		ParsedLyrics.Add(Lyric);
+		TArray<FString, TInlineAllocator<4>> OwnedLines;
+		OwnedLines.Reserve(PendingTextLines.Num());
+		for (const FStringView TextLine : PendingTextLines)
+		{
+			OwnedLines.Emplace(TextLine);
+		}
+
+		PendingTextStorage = MoveTemp(OwnedLines);
+		for (int32 i = 0; i < PendingTextStorage.Num(); i++)
+		{
+			PendingTextLines[i] = PendingTextStorage[i];
+		}
 	}
 }
 
-bool FDreamMusicPlayerLyricFileParser_SRT::ParseSRTTimestamp(const FString& TimestampLine, FDreamMusicLyric& OutLyric)
+void FDreamMusicPlayerLyricFileParser_SRT::FinishParse()
 {
-	// SRT format: "00:00:48,710 --> 00:00:58,770"
-	FString StartTime, EndTime;
+	FlushCue();
+	CueState = 0;
+}
 
-	if (!TimestampLine.Split(TEXT(" --> "), &StartTime, &EndTime))
+void FDreamMusicPlayerLyricFileParser_SRT::FlushCue()
+{
+	if (PendingCue.StartTimestamp.ToMilliseconds() != 0 || PendingCue.EndTimestamp.ToMilliseconds() != 0)
 	{
-		return false;
+		AssignTextLines(PendingCue, PendingTextLines);
+		SourceOrder.Add(PendingCue.StartTimestamp.ToTime());
+		ParsedLyrics.Add(MoveTemp(PendingCue));
 	}
 
-	StartTime = StartTime.TrimStartAndEnd();
-	EndTime = EndTime.TrimStartAndEnd();
-
-	// Parse start timestamp manually for SRT format
-	OutLyric.StartTimestamp = ParseSRTTime(StartTime);
-
-	// Parse end timestamp manually for SRT format  
-	OutLyric.EndTimestamp = ParseSRTTime(EndTime);
-
-	return true;
+	PendingCue = FDreamMusicLyric();
+	PendingTextLines.Reset();
+	PendingTextStorage.Reset();
 }
 
-FDreamMusicLyricTimestamp FDreamMusicPlayerLyricFileParser_SRT::ParseSRTTime(const FString& TimeString)
+bool FDreamMusicPlayerLyricFileParser_SRT::ParseSRTTimestamp(FStringView TimestampLine, FDreamMusicLyric& OutLyric)
 {
-	FDreamMusicLyricTimestamp Result;
-
-	// SRT format: HH:MM:SS,mmm
-	TArray<FString> TimeParts;
-	TimeString.ParseIntoArray(TimeParts, TEXT(":"));
+	// SRT format: "00:00:48,710 --> 00:00:58,770"
+	FDreamLyricTime StartTime;
+	FDreamLyricTime EndTime;
 
-	if (TimeParts.Num() >= 3)
+	if (!FDreamLyricTimestampScanner::ScanRange(TimestampLine, StartTime, EndTime))
 	{
-		// Parse hours and minutes
-		Result.Hours = FCString::Atoi(*TimeParts[0]);
-		Result.Minute = FCString::Atoi(*TimeParts[1]);
+		return false;
+	}
 
-		// Parse seconds and milliseconds (format: SS,mmm)
-		FString SecondsAndMs = TimeParts[2];
-		FString SecondsStr, MillisecondsStr;
+	OutLyric.StartTimestamp = FDreamMusicLyricTimestamp(StartTime);
+	OutLyric.EndTimestamp = FDreamMusicLyricTimestamp(EndTime);
 
-		if (SecondsAndMs.Split(TEXT(","), &SecondsStr, &MillisecondsStr))
-		{
-			Result.Seconds = FCString::Atoi(*SecondsStr);
-			Result.Millisecond = FCString::Atoi(*MillisecondsStr);
-		}
-		else if (SecondsAndMs.Split(TEXT("."), &SecondsStr, &MillisecondsStr))
-		{
-			// Handle alternate format with dot separator
-			Result.Seconds = FCString::Atoi(*SecondsStr);
-			Result.Millisecond = FCString::Atoi(*MillisecondsStr);
-		}
-		else
-		{
-			// No milliseconds, just seconds
-			Result.Seconds = FCString::Atoi(*SecondsAndMs);
-			Result.Millisecond = 0;
-		}
-	}
+	return true;
+}
 
-	return Result;
+FDreamMusicLyricTimestamp FDreamMusicPlayerLyricFileParser_SRT::ParseSRTTime(FStringView TimeString)
+{
+	// SRT format: HH:MM:SS,mmm (HH:MM:SS.mmm is accepted as well)
+	FDreamLyricTime Time;
+	FDreamLyricTimestampScanner::ScanClock(TimeString.TrimStartAndEnd(), Time);
+	return FDreamMusicLyricTimestamp(Time);
 }
 
 // FString FDreamMusicPlayerLyricFileParser_SRT::CleanSRTContent(const FString& RawContent)
@@ -174,9 +158,19 @@ FDreamMusicLyricTimestamp FDreamMusicPlayerLyricFileParser_SRT::ParseSRTTime(con
 
 void FDreamMusicPlayerLyricFileParser_SRT::ProcessText(FDreamMusicLyric& Lyric)
 {
-	TArray<FString> ProcessLines;
-	Lyric.Content.ParseIntoArrayLines(ProcessLines, false); // false 表示保留空行
+	const FString Content = MoveTemp(Lyric.Content);
 
+	TArray<FStringView, TInlineAllocator<4>> TextLines;
+	UE::String::ParseLines(Content, [&TextLines](FStringView TextLine)
+	{
+		TextLines.Add(TextLine);
+	});
+
+	AssignTextLines(Lyric, TextLines);
+}
+
+void FDreamMusicPlayerLyricFileParser_SRT::AssignTextLines(FDreamMusicLyric& Lyric, TConstArrayView<FStringView> ProcessLines) const
+{
 	// 清空原有内容，准备重新填充
 	Lyric.Content.Empty();
 	Lyric.Romanization.Empty();
@@ -185,68 +179,37 @@ void FDreamMusicPlayerLyricFileParser_SRT::ProcessText(FDreamMusicLyric& Lyric)
 	// 如果只有一行，则直接视为歌词内容（原文）
 	if (ProcessLines.Num() == 1)
 	{
-		Lyric.Content = ProcessLines[0];
+		Lyric.Content = FString(ProcessLines[0]);
 	}
 	else
 	{
-		// 根据歌词行类型处理内容
-		switch (LineType)
+		const FDreamLyricLineLayout& Layout = FDreamLyricLineLayouts::Get(LineType);
+		if (Layout.NumLines > 1)
+		{
+			// 根据歌词行类型处理内容
+			const int32 NumLines = FMath::Min(ProcessLines.Num(), Layout.NumLines);
+			for (int32 i = 0; i < NumLines; i++)
+			{
+				const FStringView TextLine = ProcessLines[i];
+				switch (Layout.Fields[i])
+				{
+				case EDreamLyricField::Content: Lyric.Content = FString(TextLine); break;
+				case EDreamLyricField::Romanization: Lyric.Romanization = FString(TextLine); break;
+				case EDreamLyricField::Translate: Lyric.Translate = FString(TextLine); break;
+				}
+			}
+		}
+		else
 		{
-		case EDreamMusicPlayerLyricParseLineType::Romanization_Lyric_Translation:
-			if (ProcessLines.IsValidIndex(0)) Lyric.Romanization = ProcessLines[0];
-			if (ProcessLines.IsValidIndex(1)) Lyric.Content = ProcessLines[1];
-			if (ProcessLines.IsValidIndex(2)) Lyric.Translate = ProcessLines[2];
-			break;
-
-		case EDreamMusicPlayerLyricParseLineType::Romanization_Translation_Lyric:
-			if (ProcessLines.IsValidIndex(0)) Lyric.Romanization = ProcessLines[0];
-			if (ProcessLines.IsValidIndex(1)) Lyric.Translate = ProcessLines[1];
-			if (ProcessLines.IsValidIndex(2)) Lyric.Content = ProcessLines[2];
-			break;
-
-		case EDreamMusicPlayerLyricParseLineType::Translation_Romanization_Lyric:
-			if (ProcessLines.IsValidIndex(0)) Lyric.Translate = ProcessLines[0];
-			if (ProcessLines.IsValidIndex(1)) Lyric.Romanization = ProcessLines[1];
-			if (ProcessLines.IsValidIndex(2)) Lyric.Content = ProcessLines[2];
-			break;
-
-		case EDreamMusicPlayerLyricParseLineType::Translation_Lyric_Romanization:
-			if (ProcessLines.IsValidIndex(0)) Lyric.Translate = ProcessLines[0];
-			if (ProcessLines.IsValidIndex(1)) Lyric.Content = ProcessLines[1];
-			if (ProcessLines.IsValidIndex(2)) Lyric.Romanization = ProcessLines[2];
-			break;
-
-		case EDreamMusicPlayerLyricParseLineType::Lyric_Romanization_Translation:
-			if (ProcessLines.IsValidIndex(0)) Lyric.Content = ProcessLines[0];
-			if (ProcessLines.IsValidIndex(1)) Lyric.Romanization = ProcessLines[1];
-			if (ProcessLines.IsValidIndex(2)) Lyric.Translate = ProcessLines[2];
-			break;
-
-		case EDreamMusicPlayerLyricParseLineType::Romanization_Lyric:
-			if (ProcessLines.IsValidIndex(0)) Lyric.Romanization = ProcessLines[0];
-			if (ProcessLines.IsValidIndex(1)) Lyric.Content = ProcessLines[1];
-			break;
-
-		case EDreamMusicPlayerLyricParseLineType::Lyric_Romanization:
-			if (ProcessLines.IsValidIndex(0)) Lyric.Content = ProcessLines[0];
-			if (ProcessLines.IsValidIndex(1)) Lyric.Romanization = ProcessLines[1];
-			break;
-
-		case EDreamMusicPlayerLyricParseLineType::Translation_Lyric:
-			if (ProcessLines.IsValidIndex(0)) Lyric.Translate = ProcessLines[0];
-			if (ProcessLines.IsValidIndex(1)) Lyric.Content = ProcessLines[1];
-			break;
-
-		case EDreamMusicPlayerLyricParseLineType::Lyric_Translation:
-			if (ProcessLines.IsValidIndex(0)) Lyric.Content = ProcessLines[0];
-			if (ProcessLines.IsValidIndex(1)) Lyric.Translate = ProcessLines[1];
-			break;
-
-		case EDreamMusicPlayerLyricParseLineType::Lyric_Only:
-		default:
 			// 默认情况下，将所有行合并为 Content（用换行符连接）
-			Lyric.Content = FString::Join(ProcessLines, TEXT("\n"));
-			break;
+			for (const FStringView TextLine : ProcessLines)
+			{
+				if (!Lyric.Content.IsEmpty())
+				{
+					Lyric.Content += TEXT("\n");
+				}
+				Lyric.Content.Append(TextLine.GetData(), TextLine.Len());
+			}
 		}
 	}
 
@@ -0,0 +1,43 @@
+﻿// Copyright © Dream Moon Studio . Dream Moon All rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/CancellableAsyncAction.h"
+#include "LyricParser/DreamLyricBatchParser.h"
+#include "DreamAsyncAction_ParseLyricBatch.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FParseLyricBatchCompleted, const TArray<FDreamLyricBatchResult>&, Results, const FDreamLyricBatchStats&, Stats);
+
+UCLASS()
+class DREAMMUSICPLAYER_API UDreamAsyncAction_ParseLyricBatch : public UCancellableAsyncAction
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintAssignable)
+	FParseLyricBatchCompleted OnCompleted;
+
+	/**
+	 * Parse many lyric files on worker threads
+	 * @param WorldContextObject Keeps the action alive through its game instance while the batch runs
+	 * @param Requests Lyric files and their parse settings
+	 * @param bValidate Fill validation errors of every result
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dream Music Player", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UDreamAsyncAction_ParseLyricBatch* ParseLyricBatch(UObject* WorldContextObject, const TArray<FDreamLyricBatchRequest>& Requests, bool bValidate = false);
+
+	virtual void Activate() override;
+	virtual void Cancel() override;
+	virtual void SetReadyToDestroy() override;
+
+private:
+	// 没有 GameInstance (编辑器工具) 时改为加入根集
+	bool bRooted = false;
+
+	TArray<FDreamLyricBatchRequest> PendingRequests;
+	bool bValidateResults = false;
+
+	// 后台任务可能在 Cancel 之后仍在读取
+	TSharedPtr<std::atomic<bool>, ESPMode::ThreadSafe> CancelFlag;
+};
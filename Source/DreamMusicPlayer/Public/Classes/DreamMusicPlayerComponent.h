@@ -148,9 +148,11 @@ public:
 	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "State")
 	float CurrentMusicPercent = 0.f;
 
-	// Current Music Timestamp
-	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "State")
-	FDreamMusicLyricTimestamp CurrentTimestamp;
+	// Current Music Time (Native Packed Clock)
+	FDreamLyricTime CurrentTime;
+
+	// Music End Time (Native Packed Clock), Computed Once Per Track
+	FDreamLyricTime CurrentMusicEndTime;
 
 
 #pragma endregion State
@@ -289,6 +291,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Functions")
 	FDreamMusicDataStruct GetLastMusicData(FDreamMusicDataStruct InData);
 
+	/**
+	 * Get Current Music Timestamp
+	 * @return Blueprint View Of CurrentTime, Built On Request Instead Of Every Tick
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions")
+	FDreamMusicLyricTimestamp GetCurrentTimestamp() const { return FDreamMusicLyricTimestamp(CurrentTime); }
+
 	UFUNCTION(BlueprintPure, Category = "Functions|Expansion", Meta = (DeterminesOutputType="InExpansionClass", DynamicOutputParam="OutExpansion"))
 	void GetExpansionByClass(TSubclassOf<UDreamMusicPlayerExpansion> InExpansionClass, UDreamMusicPlayerExpansion*& OutExpansion) const;
 	
@@ -22,15 +22,16 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "Dream Music Player Expansion")
 	UDreamMusicPlayerComponent* MusicPlayerComponent;
 
-	UPROPERTY(BlueprintReadOnly, Category = "Dream Music Player Expansion")
-	FDreamMusicLyricTimestamp CurrentTimestamp;
+	// Packed Current Time, Use This In Native Code
+	FDreamLyricTime CurrentTime;
 
 	UPROPERTY(BlueprintReadOnly, Category = "Dream Music Player Expansion")
 	FDreamMusicDataStruct CurrentMusicData;
 
 public:
 	virtual void Initialize(UDreamMusicPlayerComponent* InComponent);
-	virtual void Tick(const FDreamMusicLyricTimestamp& InTimestamp, float InDeltaTime);
+	// Native Subclasses Override This, BP_Tick Only Runs When A Blueprint Implements It
+	virtual void Tick(FDreamLyricTime InTime, float InDeltaTime);
 	virtual void ChangeMusic(const FDreamMusicDataStruct& InData);
 	virtual void MusicSetPercent(float InPercent);
 	virtual void MusicStart();
@@ -41,6 +42,10 @@ public:
 	virtual void UnbindDelegates();
 	virtual void Deinitialize();
 
+	// Blueprint View Of CurrentTime, Built On Request Instead Of Every Tick
+	UFUNCTION(BlueprintPure, Category = "Dream Music Player Expansion")
+	FDreamMusicLyricTimestamp GetCurrentTimestamp() const { return FDreamMusicLyricTimestamp(CurrentTime); }
+
 protected:
 	UFUNCTION(BlueprintNativeEvent, DisplayName = "On Initialize")
 	void BP_Initialize(UDreamMusicPlayerComponent* InComponent);
@@ -74,4 +79,8 @@ protected:
 
 	UFUNCTION(BlueprintImplementableEvent, DisplayName = "On Unbind Delegates")
 	void BP_UnbindDelegates();
+
+private:
+	// BP_Tick Is Implemented By A Blueprint Class, Resolved Once In Initialize
+	bool bBlueprintTick = false;
 };
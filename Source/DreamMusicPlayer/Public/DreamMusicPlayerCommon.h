@@ -91,6 +91,49 @@ enum class EDreamMusicPlayerLyricParseLineType: uint8
 	Lyric_Only UMETA(DisplayName = "Lyric-Only"),
 };
 
+/**
+ * Packed lyric time (milliseconds)
+ * Native timebase used by the parsers, lyric data, event defines and the player clock.
+ * FDreamMusicLyricTimestamp is only the Blueprint-facing view of this value.
+ */
+struct FDreamLyricTime
+{
+	int32 Milliseconds = 0;
+
+	constexpr FDreamLyricTime() = default;
+
+	constexpr explicit FDreamLyricTime(int32 InMilliseconds) : Milliseconds(InMilliseconds)
+	{
+	}
+
+	static constexpr FDreamLyricTime FromParts(int32 InHours, int32 InMinute, int32 InSeconds, int32 InMillisecond)
+	{
+		return FDreamLyricTime(InHours * 3600000 + InMinute * 60000 + InSeconds * 1000 + InMillisecond);
+	}
+
+	static FDreamLyricTime FromSeconds(double InSeconds)
+	{
+		return FDreamLyricTime(FMath::RoundToInt32(InSeconds * 1000.0));
+	}
+
+	float ToSeconds() const { return Milliseconds / 1000.0f; }
+
+	bool IsApproximatelyEqual(FDreamLyricTime Target, int32 ToleranceMilliseconds) const
+	{
+		return FMath::Abs(Milliseconds - Target.Milliseconds) <= ToleranceMilliseconds;
+	}
+
+	constexpr bool operator==(FDreamLyricTime Target) const { return Milliseconds == Target.Milliseconds; }
+	constexpr bool operator!=(FDreamLyricTime Target) const { return Milliseconds != Target.Milliseconds; }
+	constexpr bool operator<(FDreamLyricTime Target) const { return Milliseconds < Target.Milliseconds; }
+	constexpr bool operator<=(FDreamLyricTime Target) const { return Milliseconds <= Target.Milliseconds; }
+	constexpr bool operator>(FDreamLyricTime Target) const { return Milliseconds > Target.Milliseconds; }
+	constexpr bool operator>=(FDreamLyricTime Target) const { return Milliseconds >= Target.Milliseconds; }
+
+	constexpr FDreamLyricTime operator+(int32 InMilliseconds) const { return FDreamLyricTime(Milliseconds + InMilliseconds); }
+	constexpr int32 operator-(FDreamLyricTime Target) const { return Milliseconds - Target.Milliseconds; }
+};
+
 USTRUCT(BlueprintType)
 struct DREAMMUSICPLAYER_API FDreamMusicLyricTimestamp
 {
@@ -113,6 +156,19 @@ public:
 	{
 	}
 
+	explicit FDreamMusicLyricTimestamp(FDreamLyricTime InTime)
+		: Hours(InTime.Milliseconds / 3600000),
+		  Minute((InTime.Milliseconds / 60000) % 60),
+		  Seconds((InTime.Milliseconds / 1000) % 60),
+		  Millisecond(InTime.Milliseconds % 1000)
+	{
+	}
+
+	static FDreamMusicLyricTimestamp FromMilliseconds(int32 InMilliseconds)
+	{
+		return FDreamMusicLyricTimestamp(FDreamLyricTime(InMilliseconds));
+	}
+
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int Hours = 0;
@@ -135,64 +191,32 @@ public:
 
 	bool IsApproximatelyEqual(const FDreamMusicLyricTimestamp& Target, int ToleranceMilliseconds) const;
 
-	static FDreamMusicLyricTimestamp Parse(const FString& TimestampStr)
-	{
-		FDreamMusicLyricTimestamp Ts;
-
-		FString TimeString = TimestampStr;
-
-		// Try HH:MM:SS,mmm or HH:MM:SS.mmm (SRT/ASS Format)
-		{
-			FRegexPattern RegexPattern(TEXT("((\\d{1,2}):(\\d{2}):(\\d{2})[,.](\\d{3}))"));
-			FRegexMatcher RegexMatcher(RegexPattern, TimeString);
-
-			if (RegexMatcher.FindNext())
-			{
-				Ts.Hours = UKismetStringLibrary::Conv_StringToInt(RegexMatcher.GetCaptureGroup(0));
-				Ts.Minute = UKismetStringLibrary::Conv_StringToInt(RegexMatcher.GetCaptureGroup(1));
-				Ts.Seconds = UKismetStringLibrary::Conv_StringToInt(RegexMatcher.GetCaptureGroup(2));
-				Ts.Millisecond = UKismetStringLibrary::Conv_StringToInt(RegexMatcher.GetCaptureGroup(3));
-				return Ts;
-			}
-		}
-
-		// Try MM:SS.mmm (LRC Format)
-		{
-			FRegexPattern RegexPattern(TEXT("((\\d{1,2}):(\\d{2}):(\\d{2})[.](\\d{3}))"));
-			FRegexMatcher RegexMatcher(RegexPattern, TimeString);
-			if (RegexMatcher.FindNext())
-			{
-				Ts.Minute = UKismetStringLibrary::Conv_StringToInt(RegexMatcher.GetCaptureGroup(0));
-				Ts.Seconds = UKismetStringLibrary::Conv_StringToInt(RegexMatcher.GetCaptureGroup(1));
-				Ts.Millisecond = UKismetStringLibrary::Conv_StringToInt(RegexMatcher.GetCaptureGroup(2));
-				return Ts;
-			}
-		}
+	/**
+	 * 从字符串中解析第一个时间戳, 支持 SRT (HH:MM:SS,mmm) / ASS (H:MM:SS.cc) / LRC (MM:SS.xx, MM:SS.xxx)
+	 */
+	static FDreamMusicLyricTimestamp Parse(FStringView TimestampStr);
 
-		// Try MM:SS.mm (LRC Format with 2-digit milliseconds)
-		{
-			FRegexPattern RegexPattern(TEXT("((\\d{1,2}):(\\d{2})\\.(\\d{2}))"));
-			FRegexMatcher RegexMatcher(RegexPattern, TimeString);
+	FString ToString() const
+	{
+		return FString::Printf(TEXT("%02d:%02d:%02d.%03d"), Hours, Minute, Seconds, Millisecond);
+	}
 
-			if (RegexMatcher.FindNext())
-			{
-				Ts.Minute = UKismetStringLibrary::Conv_StringToInt(RegexMatcher.GetCaptureGroup(0));
-				Ts.Seconds = UKismetStringLibrary::Conv_StringToInt(RegexMatcher.GetCaptureGroup(1));
-				Ts.Millisecond = UKismetStringLibrary::Conv_StringToInt(RegexMatcher.GetCaptureGroup(2)) * 10; // Convert to 3-digit milliseconds
-			}
-		}
+	const FDreamMusicLyricTimestamp* FromSeconds(float InSeconds);
 
-		return Ts;
+	float ToSeconds() const
+	{
+		return ToTime().ToSeconds();
 	}
 
-	FString ToString() const
+	int ToMilliseconds() const
 	{
-		return FString::Printf(TEXT("%02d:%02d:%02d.%03d"), Hours, Minute, Seconds, Millisecond);
+		return Hours * 3600000 + Minute * 60000 + Seconds * 1000 + Millisecond;
 	}
 
-	inline const FDreamMusicLyricTimestamp* FromSeconds(float InSeconds);
-	inline float ToSeconds() const;
-	inline int ToMilliseconds() const;
+	FDreamLyricTime ToTime() const
+	{
+		return FDreamLyricTime(ToMilliseconds());
+	}
 };
 
 USTRUCT(BlueprintType)
@@ -352,6 +376,37 @@ public:
 	FDreamMusicLyricWord CurrentWord;
 };
 
+// 仅包含索引的逐字进度, 不复制单字文本
+USTRUCT(BlueprintType)
+struct FDreamMusicLyricWordProgress
+{
+	GENERATED_BODY()
+
+public:
+	FDreamMusicLyricWordProgress()
+	{
+	}
+
+	FDreamMusicLyricWordProgress(int32 InCurrentWordIndex, float InLineProgress, bool InIsActive)
+		: CurrentWordIndex(InCurrentWordIndex)
+		  , LineProgress(InLineProgress)
+		  , bIsActive(InIsActive)
+	{
+	}
+
+	// Current word index in the line (-1 if none)
+	UPROPERTY(BlueprintReadOnly)
+	int32 CurrentWordIndex = -1;
+
+	// Progress within the current line (0.0 to 1.0)
+	UPROPERTY(BlueprintReadOnly)
+	float LineProgress = 0.0f;
+
+	// Whether a word is currently being played
+	UPROPERTY(BlueprintReadOnly)
+	bool bIsActive = false;
+};
+
 USTRUCT(BlueprintType)
 struct FDreamMusicInformation
 {
@@ -0,0 +1,28 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+
+// DreamMusicPlayer 资产序列化版本
+struct DREAMMUSICPLAYER_API FDreamMusicPlayerCustomVersion
+{
+	enum Type
+	{
+		BeforeCustomVersionWasAdded = 0,
+
+		// 歌词扩展数据在 Cook 时内嵌解析后的歌词轨道
+		BakedLyricTrack,
+
+		// 烘焙的歌词轨道记录 Cook 时的逐字时间生成设置
+		BakedLyricSynthesisFlag,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	const static FGuid GUID;
+
+private:
+	FDreamMusicPlayerCustomVersion() = delete;
+};
@@ -33,6 +33,18 @@ public:
 	UPROPERTY(EditAnywhere, DisplayName="歌词Content路径", Category="Lyric", Config, meta=(LongPackageName))
 	FDirectoryPath LyricContentPath;
 
+	// 首次解析后写入二进制歌词缓存 (.dlyc), 之后直接加载缓存
+	UPROPERTY(EditAnywhere, DisplayName="启用歌词缓存", Category="Lyric", Config)
+	bool bEnableLyricCache = true;
+
+	// 进程内共享的已解析歌词轨道缓存上限 (MB), 同一歌词文件只解析一次并由所有播放器共享, 0 为关闭
+	UPROPERTY(EditAnywhere, DisplayName="歌词轨道内存缓存 (MB)", Category="Lyric", Config, meta=(ClampMin=0))
+	int32 LyricTrackCacheBudgetMB = 32;
+
+	// 没有逐字时间的歌词行 (逐行 LRC, SRT ...) 在加载时按字符类别估算逐字时间: CJK 一字一音节, 字母约三分之一, 空格与标点为 0
+	UPROPERTY(EditAnywhere, DisplayName="为逐行歌词生成逐字时间", Category="Lyric", Config)
+	bool bSynthesizeWordTimings = false;
+
 	UPROPERTY(EditAnywhere, DisplayName="启用调试模式", Category="Debug", Config)
 	bool bEnableDebugMode = false;
 
@@ -48,15 +48,37 @@ protected:
 	virtual void BP_MusicStart_Implementation() override;
 	virtual void BP_MusicEnd_Implementation() override;
 	virtual void BP_MusicSetPercent_Implementation(float InPercent) override;
-	virtual void BP_Tick_Implementation(const FDreamMusicLyricTimestamp& InTimestamp, float InDeltaTime) override;
+	virtual void Tick(FDreamLyricTime InTime, float InDeltaTime) override;
 
 	/**
 	 * 歌词变更事件处理函数
 	 * 当歌词发生变化时被调用，处理当前歌词和索引相关的逻辑
-	 * @param Lyric 当前歌词信息结构体
 	 * @param Index 当前歌词在列表中的索引位置
 	 */
-	void OnLyricChangedHandle(FDreamMusicLyric Lyric, int Index);
+	void OnLyricChangedHandle(int32 Index);
 
-	TArray<FDreamMusicLyricTimestamp> IgnoreTimestamp;
+	/**
+	 * 将当前音乐的时间事件转换为紧凑时间，避免每帧转换时间戳
+	 */
+	void BuildTimeEventCache();
+
+	/**
+	 * 触发到达 CurrentTime 的时间事件
+	 */
+	void FireTimeEvents();
+
+	/**
+	 * 计算下一个尚未触发的时间事件的触发窗口起点, 在此之前的 Tick 不需要遍历事件
+	 * @param InTime 触发窗口已经结束的事件不再计入
+	 */
+	void UpdateNextTimeEvent(FDreamLyricTime InTime);
+
+	// Packed Time Of Each TimeEventDefines Entry
+	TArray<FDreamLyricTime> TimeEventTimes;
+
+	// Fired State Of Each TimeEventDefines Entry
+	TBitArray<> FiredTimeEvents;
+
+	// Earliest Time Any Unfired Time Event Can Fire
+	FDreamLyricTime NextTimeEventTime;
 };
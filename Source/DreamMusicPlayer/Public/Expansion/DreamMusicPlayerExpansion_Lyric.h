@@ -4,8 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "Classes/DreamMusicPlayerExpansion.h"
+#include <atomic>
 #include "DreamMusicPlayerExpansion_Lyric.generated.h"
 
+struct FDreamLyricTrack;
+enum class EDreamLyricWordChannel : uint8;
+
 /**
  * 
  */
@@ -23,10 +27,38 @@ public:
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMusicPlayerLyricAndIndexDelegate, FDreamMusicLyric, Lyric, int, Index);
 
 	DECLARE_MULTICAST_DELEGATE_TwoParams(FMusicPlayerLyricAndIndexMulticaseDelegate, FDreamMusicLyric, int);
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMusicPlayerLyricIndexDelegate, int32, Index);
+
+	DECLARE_MULTICAST_DELEGATE_OneParam(FMusicPlayerLyricIndexMulticastDelegate, int32);
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMusicPlayerLyricWordDelegate, int32, LineIndex, int32, WordIndex);
+
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FMusicPlayerLyricWordMulticastDelegate, int32, int32);
 public:
 	// Lyric Offset
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings")
 	float LyricOffset = 0.0f;
+
+	// Fill CurrentMusicLyricList for Blueprint, when disabled use GetLyricAtIndex to read single lines
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings")
+	bool bMaterializeLyricList = true;
+
+	// Parse lyric files on a background thread, the lyric list is published on the game thread when done
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings")
+	bool bAsyncLoadLyric = true;
+
+	// Stream SRT / ASS lyric files in chunks, the first lines are published before the whole file is parsed (requires bAsyncLoadLyric)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings", meta=(EditCondition="bAsyncLoadLyric"))
+	bool bStreamLyric = true;
+
+	// Parse the lyric files of the upcoming tracks in the background once the current lyrics are loaded, auto-advance then picks them up from the lyric track cache
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings")
+	bool bPrefetchNextLyric = true;
+
+	// Number of upcoming tracks to prefetch, follows the play order of the player component (no prefetch in Random play mode)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings", meta=(EditCondition="bPrefetchNextLyric", ClampMin=1, ClampMax=8))
+	int32 LyricPrefetchLookahead = 1;
 	
 	// Current Music Lyric List
 	UPROPERTY(BlueprintReadOnly, Category = "State")
@@ -51,6 +83,23 @@ public:
 
 	FMusicPlayerLyricAndIndexMulticaseDelegate OnLyricChangedNative;
 
+	/**
+	 * Lyric Line Index Changed, read the line through GetLyricTrack / GetLyricAtIndex when needed
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Delegates|Lyric")
+	FMusicPlayerLyricIndexDelegate OnLyricIndexChanged;
+
+	// 只传递行索引, 广播时不复制歌词
+	FMusicPlayerLyricIndexMulticastDelegate OnLyricIndexChangedNative;
+
+	/**
+	 * Current Word Of The Current Line Changed, WordIndex is -1 between words
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Delegates|Lyric")
+	FMusicPlayerLyricWordDelegate OnLyricWordChanged;
+
+	FMusicPlayerLyricWordMulticastDelegate OnLyricWordChangedNative;
+
 public:
 	/**
 	 * Get Current Lyric Line Progress (fallback when no word timings available)
@@ -76,6 +125,107 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
 	FDreamMusicLyricProgress GetCurrentRomanizationProgress(const FDreamMusicLyricTimestamp& InTimestamp) const;
 
+	/**
+	 * Get Current Lyric Word Progress Without Copying The Word
+	 * @param InTimestamp Current playback time in seconds
+	 * @param bUseRoma Use romanization word timings
+	 * @return Word index in the current line and line progress
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
+	FDreamMusicLyricWordProgress GetCurrentWordProgressIndex(const FDreamMusicLyricTimestamp& InTimestamp, bool bUseRoma = false) const;
+
+	/**
+	 * Get Current Line Progress Measured In Grapheme Clusters, For Per-Character Highlighting (UDreamLyricTextBlock Character mode)
+	 * The current word is interpolated over its own graphemes, so long and short words advance at their sung speed
+	 * @param InTimestamp Current playback time
+	 * @param bUseRoma Use romanization text and word timings
+	 * @return Highlighted grapheme count divided by the grapheme count of the line
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
+	float GetCurrentLyricGraphemeProgress(const FDreamMusicLyricTimestamp& InTimestamp, bool bUseRoma = false) const;
+
+	/**
+	 * Get Lyric Line Count Of Current Music
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
+	int32 GetLyricCount() const;
+
+	/**
+	 * Get Lyric Line By Index
+	 * @param Index Line Index
+	 * @return Lyric, empty lyric if index is invalid
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
+	FDreamMusicLyric GetLyricAtIndex(int32 Index) const;
+
+	/**
+	 * Get Current Lyric Line Index
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
+	int32 GetCurrentLyricIndex() const { return CurrentLyricIndex; }
+
+	/**
+	 * Get Current Word Index In The Current Line (-1 between words or without word timings)
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
+	int32 GetCurrentLyricWordIndex() const { return CurrentLyricWordIndex; }
+
+	/**
+	 * Get Index Range Of The Lines Around The Current Line, For Scrolling Lyric Views
+	 * @param NumBefore Number of lines before the current line
+	 * @param NumAfter Number of lines after the current line
+	 * @param OutFirstIndex First line index of the window
+	 * @param OutLastIndex Last line index of the window, smaller than OutFirstIndex when there is no line
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
+	void GetLyricWindowRange(int32 NumBefore, int32 NumAfter, int32& OutFirstIndex, int32& OutLastIndex) const;
+
+	/**
+	 * Get Line Progress Of Every Line In The Window Around The Current Line
+	 * @param InTimestamp Current playback time
+	 * @param OutFirstIndex Line index of the first progress entry
+	 * @param OutLineProgress Progress of each line (0 before the line, 1 after the line)
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
+	void GetLyricWindowProgress(const FDreamMusicLyricTimestamp& InTimestamp, int32 NumBefore, int32 NumAfter, int32& OutFirstIndex, TArray<float>& OutLineProgress) const;
+
+	/**
+	 * Get Window Of CurrentMusicLyricList Around The Current Line (native, no copy), empty when bMaterializeLyricList is disabled
+	 */
+	TConstArrayView<FDreamMusicLyric> GetLyricListWindow(int32 NumBefore, int32 NumAfter) const;
+
+	/**
+	 * Calculate Line Progress Of Consecutive Lines In One Pass (native, no allocation)
+	 * @param InTime Current playback time
+	 * @param FirstIndex Line index of OutLineProgress[0]
+	 * @param OutLineProgress One entry per line, lines outside the track are set to 0
+	 */
+	void CalculateLyricWindowProgress(FDreamLyricTime InTime, int32 FirstIndex, TArrayView<float> OutLineProgress) const;
+
+	/**
+	 * Is Lyric List Of Current Music Still Loading
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
+	bool IsLyricLoadPending() const { return bLyricLoadPending; }
+
+	/**
+	 * Get Lyric Track Of Current Music (native)
+	 */
+	TSharedPtr<const FDreamLyricTrack> GetLyricTrack() const { return CurrentLyricTrack; }
+
+	/**
+	 * Get Indices Of All Lyric Lines Shown At The Timestamp, Including Overlapping Lines (duets, background vocals)
+	 * @param InTimestamp Playback time
+	 * @return Line indices in ascending order
+	 */
+	UFUNCTION(BlueprintPure, Category = "Functions|Lyric")
+	TArray<int32> GetActiveLyricIndices(const FDreamMusicLyricTimestamp& InTimestamp) const;
+
+	/**
+	 * Get Indices Of All Lyric Lines Shown At The Time (native, no copy), valid while the current track is alive
+	 */
+	TConstArrayView<int32> GetActiveLyricLines(FDreamLyricTime InTime) const;
+
 	/**
 	 * Play Music Time From Lyric Timestamp
 	 * @param InLyric Lyric
@@ -96,37 +246,104 @@ protected:
 	 * @param bUseRoma Array of word timings
 	 * @return Progress information
 	 */
-	FDreamMusicLyricProgress CalculateWordProgress(FDreamMusicLyricTimestamp InCurrentTime, bool bUseRoma = false) const;
+	FDreamMusicLyricProgress CalculateWordProgress(FDreamLyricTime InCurrentTime, bool bUseRoma = false) const;
+
+	/**
+	 * Helper function to calculate word progress, index only
+	 * @param InCurrentTime Current playback time
+	 * @param Channel Word timing channel
+	 * @return Progress information without the word
+	 */
+	FDreamMusicLyricWordProgress CalculateWordProgressIndex(FDreamLyricTime InCurrentTime, EDreamLyricWordChannel Channel) const;
+
+	/**
+	 * Helper function to calculate line progress in grapheme clusters of the line text
+	 * @param InCurrentTime Current playback time
+	 * @param Channel Word timing channel
+	 * @return Progress in [0, 1]
+	 */
+	float CalculateGraphemeProgress(FDreamLyricTime InCurrentTime, EDreamLyricWordChannel Channel) const;
 
 	/**
 	 * Helper function to calculate line progress
 	 * @param InCurrentTime Current playback time in seconds
 	 * @return Progress information
 	 */
-	FDreamMusicLyricProgress CalculateLineProgress(FDreamMusicLyricTimestamp InCurrentTime) const;
+	FDreamMusicLyricProgress CalculateLineProgress(FDreamLyricTime InCurrentTime) const;
 
 	/**
 	 * Set Current Lyric
-	 * @param InLyric New Lyric
+	 * @param InLineIndex New Lyric Line Index
+	 */
+	void SetCurrentLyric(int32 InLineIndex);
+
+	/**
+	 * Publish Loaded Lyric Track, Must Be Called On Game Thread
+	 * @param InTrack Loaded Track, null is treated as empty track
+	 * @param bFinal False for partial tracks published while a lyric file is still streaming
+	 */
+	void ApplyLyricTrack(TSharedPtr<const FDreamLyricTrack> InTrack, bool bFinal = true);
+
+	/**
+	 * Parse Lyric Files Of The Upcoming Tracks On Background Threads, Results Go To The Lyric Track Cache
+	 * Switching To A Track Still Being Prefetched Waits For The Prefetch Instead Of Parsing Again
+	 */
+	void PrefetchUpcomingLyrics();
+
+	/**
+	 * Update Line / Word State For CurrentTime And Schedule The Next Boundary
 	 */
-	void SetCurrentLyric(FDreamMusicLyric InLyric);
+	void UpdateLyricBoundary();
+
+	/**
+	 * Force The Next Tick To Re-evaluate (track replaced, seek)
+	 */
+	void InvalidateLyricBoundary()
+	{
+		LyricBoundaryWindowStart = FDreamLyricTime();
+		NextLyricBoundaryTime = FDreamLyricTime();
+	}
+
+	// Lyric Load Pending (background parse in flight), ticks are ignored until the first track is published
+	bool bLyricLoadPending = false;
+
+	// Incremented per load request, stale background results are dropped
+	uint32 LyricLoadSerial = 0;
+
+	// Set when a newer load request replaces a streaming load still in flight
+	TSharedPtr<std::atomic<bool>, ESPMode::ThreadSafe> LyricStreamCancelFlag;
+
+	// Current Music Lyric Track
+	TSharedPtr<const FDreamLyricTrack> CurrentLyricTrack;
+
+	// Current Lyric Line Index In Track
+	int32 CurrentLyricIndex = INDEX_NONE;
+
+	// Lookup Cursor, Last Line Found For The Playback Time (may differ from CurrentLyricIndex when a line is skipped)
+	int32 LyricLineCursor = INDEX_NONE;
+
+	// Current Word Index In The Current Line (Lyric channel)
+	int32 CurrentLyricWordIndex = INDEX_NONE;
+
+	// Line / word state is constant in [LyricBoundaryWindowStart, NextLyricBoundaryTime), ticks inside skip all work
+	FDreamLyricTime LyricBoundaryWindowStart;
+	FDreamLyricTime NextLyricBoundaryTime;
 
-	mutable int32 CachedCurrentWordIndex = -1;
-	mutable FDreamMusicLyricTimestamp LastCalculationTime;
-	mutable TArray<int32> WordDurationPrefixSum; // 前缀和数组，提升查找性能
-	mutable bool bCacheValid = false;
-	mutable bool bLastUseRoma = false;
+	// Packed Current Lyric Line Range
+	FDreamLyricTime CurrentLyricStartTime;
+	FDreamLyricTime CurrentLyricEndTime;
 
-	void BuildWordDurationCache(bool bUseRoma) const;
+	// 逐字查找游标 (Lyric / Romanization 各一个), 当前行内开始时间小于等于查询时间的最后一个字
+	mutable int32 WordCursors[2] = {INDEX_NONE, INDEX_NONE};
 
 	void ClearLyricProgressCache()
 	{
-		CachedCurrentWordIndex = -1;
-		bCacheValid = false;
-		LastCalculationTime = FDreamMusicLyricTimestamp{};
+		WordCursors[0] = INDEX_NONE;
+		WordCursors[1] = INDEX_NONE;
 	}
 
 protected:
 	virtual void BP_MusicStart_Implementation() override;
-	virtual void BP_Tick_Implementation(const FDreamMusicLyricTimestamp& InTimestamp, float InDeltaTime) override;
+	virtual void BP_MusicSetPercent_Implementation(float InPercent) override;
+	virtual void Tick(FDreamLyricTime InTime, float InDeltaTime) override;
 };
@@ -7,6 +7,8 @@
 #include "Classes/DreamMusicPlayerExpansionData.h"
 #include "DreamMusicPlayerExpansionData_Lyric.generated.h"
 
+struct FDreamLyricTrack;
+
 /**
  * 
  */
@@ -31,4 +33,49 @@ public:
 	// 内容路径请在ProjectSetting -> DreamPlugins -> Musicplayer -> LyricContentPath 中配置
 	UPROPERTY(Category="Lyric", EditAnywhere, BlueprintReadWrite, meta=(GetOptions = "DreamMusicPlayer.DreamMusicPlayerBlueprint.GetLyricFileNames"))
 	FString LyricFileName;
+
+	// Cook 时将解析后的歌词轨道写入资产, 运行时无需访问 LyricContentPath 也无需解析
+	UPROPERTY(Category="Lyric", EditAnywhere, AdvancedDisplay)
+	bool bBakeLyricOnCook = true;
+
+public:
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+
+#if WITH_EDITOR
+	virtual void BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform) override;
+	virtual void ClearAllCachedCookedPlatformData() override;
+#endif
+
+	/**
+	 * @brief 获取 Cook 时烘焙的歌词轨道
+	 * @return 未烘焙 (编辑器或关闭 bBakeLyricOnCook), 或烘焙时的 bSynthesizeWordTimings 与当前设置不同时返回空指针
+	 */
+	TSharedPtr<const FDreamLyricTrack> GetBakedTrack() const;
+
+#if WITH_EDITOR
+	/**
+	 * @brief 按当前设置解析歌词文件, 不读写二进制歌词缓存
+	 */
+	TSharedPtr<const FDreamLyricTrack> BakeLyricTrack() const;
+#endif
+
+private:
+#if WITH_EDITOR
+	/**
+	 * @brief 每次 Cook 只烘焙一次, 之后的保存复用结果
+	 */
+	void CacheCookedTrack();
+#endif
+
+	TSharedPtr<const FDreamLyricTrack> BakedTrack;
+
+	// 烘焙时是否为逐行歌词生成了逐字时间
+	bool bBakedSynthesizeWordTimings = false;
+
+#if WITH_EDITORONLY_DATA
+	TSharedPtr<const FDreamLyricTrack> CookedTrack;
+	bool bCookedSynthesizeWordTimings = false;
+	bool bCookedTrackCached = false;
+#endif
 };
@@ -0,0 +1,145 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "DreamMusicPlayerCommon.h"
+#include <atomic>
+#include "DreamLyricBatchParser.generated.h"
+
+struct FDreamLyricTrack;
+
+// 批量解析中的单个歌词文件及其解析设置
+USTRUCT(BlueprintType)
+struct DREAMMUSICPLAYER_API FDreamLyricBatchRequest
+{
+	GENERATED_BODY()
+
+	FDreamLyricBatchRequest() = default;
+
+	FDreamLyricBatchRequest(const FString& InFilePath, EDreamMusicPlayerLyricParseFileType InFileType, EDreamMusicPlayerLyricParseLineType InLineType,
+	                        EDreamMusicPlayerLrcLyricType InLrcLyricType = EDreamMusicPlayerLrcLyricType::None)
+		: FilePath(InFilePath)
+		  , FileType(InFileType)
+		  , LineType(InLineType)
+		  , LrcLyricType(InLrcLyricType)
+	{
+	}
+
+	// 歌词文件完整路径
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lyric")
+	FString FilePath;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lyric")
+	EDreamMusicPlayerLyricParseFileType FileType = EDreamMusicPlayerLyricParseFileType::LRC;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lyric")
+	EDreamMusicPlayerLyricParseLineType LineType = EDreamMusicPlayerLyricParseLineType::Romanization_Lyric;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lyric")
+	EDreamMusicPlayerLrcLyricType LrcLyricType = EDreamMusicPlayerLrcLyricType::None;
+};
+
+// 单个歌词文件的解析结果
+USTRUCT(BlueprintType)
+struct DREAMMUSICPLAYER_API FDreamLyricBatchResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	FString FilePath;
+
+	// 解析出至少一行歌词
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	bool bSuccess = false;
+
+	// 结果来自二进制缓存
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	bool bLoadedFromCache = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	int32 LineCount = 0;
+
+	// 歌词总时长 (秒)
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	float Duration = 0.0f;
+
+	// 读取与解析耗时 (毫秒)
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	float ParseTimeMs = 0.0f;
+
+	// 仅在开启校验时填充
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	TArray<FString> ValidationErrors;
+
+	// 源文件中开始时间早于前一行的歌词行数 (排序前), 结果来自缓存时为 0
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	int32 NumUnsortedLines = 0;
+
+	// 第一个乱序行在源文件歌词行中的序号, 没有乱序时为 INDEX_NONE
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	int32 FirstUnsortedLine = INDEX_NONE;
+
+	// 第一个乱序行的开始时间 (毫秒)
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	int32 FirstUnsortedTimeMs = 0;
+
+	// 解析后的歌词轨道 (native)
+	TSharedPtr<const FDreamLyricTrack> Track;
+};
+
+// 批量解析统计
+USTRUCT(BlueprintType)
+struct DREAMMUSICPLAYER_API FDreamLyricBatchStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	int32 NumFiles = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	int32 NumSucceeded = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	int32 NumFromCache = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	int32 NumLines = 0;
+
+	// 整批的实际耗时 (毫秒)
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	float WallTimeMs = 0.0f;
+
+	// 各文件耗时之和 (毫秒), 与 WallTimeMs 之比即为并行加速比
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	float TotalParseTimeMs = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	float MaxParseTimeMs = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Lyric")
+	FString SlowestFile;
+};
+
+/**
+ * @brief Parse many lyric files across worker threads
+ *
+ * Each file goes through FDreamLyricParser (and therefore the binary lyric cache) on its own task.
+ * Results keep the order of the requests. Requests for the same file with the same settings are parsed once and
+ * share the result (ParseTimeMs is 0 for the duplicates), so no two tasks write the same cache file.
+ */
+namespace FDreamLyricBatchParser
+{
+	/**
+	 * @brief Parse every request, blocks the calling thread until all files are done
+	 *
+	 * @param Requests Files to parse
+	 * @param OutResults One result per request, same order
+	 * @param OutStats Timing statistics for the whole batch
+	 * @param bValidate Fill FDreamLyricBatchResult::ValidationErrors
+	 * @param CancelFlag Optional flag, files not started yet are skipped once it is set
+	 */
+	DREAMMUSICPLAYER_API void Parse(TConstArrayView<FDreamLyricBatchRequest> Requests,
+	                                TArray<FDreamLyricBatchResult>& OutResults,
+	                                FDreamLyricBatchStats& OutStats,
+	                                bool bValidate = false,
+	                                const std::atomic<bool>* CancelFlag = nullptr);
+}
@@ -0,0 +1,92 @@
+﻿#pragma once
+
+#include "DreamMusicPlayerCommon.h"
+
+struct FDreamLyricTrack;
+
+/**
+ * @brief 二进制歌词缓存的失效键
+ *
+ * 解析设置必须完全一致; 源文件修改时间与大小一致时直接命中,
+ * 否则需要提供源文件内容哈希 (SourceHash != 0) 进行比对.
+ */
+struct FDreamLyricCacheKey
+{
+	FDateTime SourceTimestamp;
+	int64 SourceSize = 0;
+	uint64 SourceHash = 0;
+
+	EDreamMusicPlayerLyricParseFileType FileType = EDreamMusicPlayerLyricParseFileType::LRC;
+	EDreamMusicPlayerLyricParseLineType LineType = EDreamMusicPlayerLyricParseLineType::Lyric_Only;
+	EDreamMusicPlayerLrcLyricType LrcLyricType = EDreamMusicPlayerLrcLyricType::None;
+
+	// 轨道中包含生成的逐字时间
+	bool bSynthesizeWordTimings = false;
+};
+
+/**
+ * @brief 缓存中保存的解析结果
+ */
+struct FDreamLyricCacheData
+{
+	TSharedPtr<const FDreamLyricTrack> Track;
+	TMap<FString, FString> MetaData;
+
+	// 实际使用的 LRC 解析方式 (请求为 None 时为检测结果)
+	EDreamMusicPlayerLrcLyricType ResolvedLrcLyricType = EDreamMusicPlayerLrcLyricType::None;
+};
+
+/**
+ * @brief 版本化的二进制歌词缓存 (.dlyc)
+ *
+ * 文件结构: Magic | Version | 失效键 | ResolvedLrcLyricType | MetaData | FDreamLyricTrack
+ * 缓存位于 Saved/DreamMusicPlayer/LyricCache, 读取时使用内存映射, 不做任何文本解析.
+ * 写入先写到同目录的临时文件再整体替换, 读取方 (可能在其它线程映射同一文件) 只会看到完整的旧文件或新文件.
+ */
+namespace FDreamLyricCache
+{
+	static constexpr uint32 Magic = 0x43594C44; // "DLYC"
+	// 2: LRC [offset:] 应用到时间, None 类型自动识别
+	// 3: 逐行歌词生成逐字时间的设置加入失效键
+	// 4: ASS 同一时间的多行 orig 不再合并
+	static constexpr uint32 Version = 4;
+	static constexpr const TCHAR* Extension = TEXT(".dlyc");
+
+	/**
+	 * @brief 获取源歌词文件对应的缓存文件路径
+	 */
+	DREAMMUSICPLAYER_API FString GetCacheFilePath(const FString& SourceFilePath);
+
+	/**
+	 * @brief 读取缓存, 键不匹配、版本不同或数据损坏时返回 false
+	 */
+	DREAMMUSICPLAYER_API bool Load(const FString& SourceFilePath, const FDreamLyricCacheKey& Key, FDreamLyricCacheData& OutData);
+
+	/**
+	 * @brief 写入缓存 (临时文件 + 替换)
+	 */
+	DREAMMUSICPLAYER_API bool Save(const FString& SourceFilePath, const FDreamLyricCacheKey& Key, const FDreamLyricCacheData& Data);
+
+	/**
+	 * @brief 源文件级的解析锁, 同一源文件同一时间只有一个调用方解析并写入缓存
+	 *
+	 * 预取, 流式加载, 批量解析可能同时请求同一文件. 后到的调用方在构造时等待, 之后再次读取缓存即可命中前一个调用方的结果.
+	 */
+	class DREAMMUSICPLAYER_API FScopedSourceLock
+	{
+	public:
+		explicit FScopedSourceLock(const FString& SourceFilePath);
+		~FScopedSourceLock();
+
+		UE_NONCOPYABLE(FScopedSourceLock);
+
+		/**
+		 * @brief 构造时是否有其它调用方正在处理同一文件
+		 */
+		bool WasContended() const { return bContended; }
+
+	private:
+		FString CacheFilePath;
+		bool bContended = false;
+	};
+}
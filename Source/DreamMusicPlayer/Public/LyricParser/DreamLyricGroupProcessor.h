@@ -2,6 +2,56 @@
 
 #include "DreamMusicPlayerCommon.h"
 
+/**
+ * @brief Lyric field a line of a group (LRC) or cue (SRT) is routed to
+ */
+enum class EDreamLyricField : uint8
+{
+	Content,
+	Romanization,
+	Translate,
+};
+
+/**
+ * @brief Line order of one lyric group for an EDreamMusicPlayerLyricParseLineType
+ */
+struct FDreamLyricLineLayout
+{
+	int32 NumLines;
+	EDreamLyricField Fields[3];
+};
+
+namespace FDreamLyricLineLayouts
+{
+	// 按 EDreamMusicPlayerLyricParseLineType 的声明顺序排列
+	inline constexpr FDreamLyricLineLayout Table[] =
+	{
+		{3, {EDreamLyricField::Romanization, EDreamLyricField::Content, EDreamLyricField::Translate}}, // Romanization_Lyric_Translation
+		{3, {EDreamLyricField::Romanization, EDreamLyricField::Translate, EDreamLyricField::Content}}, // Romanization_Translation_Lyric
+		{3, {EDreamLyricField::Translate, EDreamLyricField::Romanization, EDreamLyricField::Content}}, // Translation_Romanization_Lyric
+		{3, {EDreamLyricField::Translate, EDreamLyricField::Content, EDreamLyricField::Romanization}}, // Translation_Lyric_Romanization
+		{3, {EDreamLyricField::Content, EDreamLyricField::Romanization, EDreamLyricField::Translate}}, // Lyric_Romanization_Translation
+		{2, {EDreamLyricField::Romanization, EDreamLyricField::Content, EDreamLyricField::Content}},   // Romanization_Lyric
+		{2, {EDreamLyricField::Content, EDreamLyricField::Romanization, EDreamLyricField::Content}},   // Lyric_Romanization
+		{2, {EDreamLyricField::Translate, EDreamLyricField::Content, EDreamLyricField::Content}},      // Translation_Lyric
+		{2, {EDreamLyricField::Content, EDreamLyricField::Translate, EDreamLyricField::Content}},      // Lyric_Translation
+		{1, {EDreamLyricField::Content, EDreamLyricField::Content, EDreamLyricField::Content}},        // Lyric_Only
+	};
+
+	static_assert(static_cast<int32>(UE_ARRAY_COUNT(Table)) == static_cast<int32>(EDreamMusicPlayerLyricParseLineType::Lyric_Only) + 1,
+		"FDreamLyricLineLayouts::Table must have one entry per EDreamMusicPlayerLyricParseLineType");
+
+	/**
+	 * @brief Get the line layout of a line type, unknown values fall back to Lyric_Only
+	 */
+	constexpr const FDreamLyricLineLayout& Get(EDreamMusicPlayerLyricParseLineType LineType)
+	{
+		constexpr int32 NumLayouts = static_cast<int32>(UE_ARRAY_COUNT(Table));
+		const int32 Index = static_cast<int32>(LineType);
+		return Table[Index < NumLayouts ? Index : NumLayouts - 1];
+	}
+}
+
 /**
  * @brief Utility structure for processing grouped lyric lines
  * 
@@ -25,10 +75,10 @@ public:
 	/**
 	 * @brief Process a group of lines with the same timestamp
 	 * 
-	 * @param LinesInGroup Array of lines that share the same timestamp
+	 * @param LinesInGroup Views of the lines that share the same timestamp, in file order
 	 * @param OutLyric The output lyric object to populate
 	 */
-	void ProcessGroup(const TArray<FString>& LinesInGroup, FDreamMusicLyric& OutLyric);
+	void ProcessGroup(TConstArrayView<FStringView> LinesInGroup, FDreamMusicLyric& OutLyric);
 
 public:
 	EDreamMusicPlayerLrcLyricType ParseMethod;
@@ -40,56 +90,65 @@ public:
 	int32 GetExpectedLineCount() const;
 
 	/**
-	 * @brief Assign content to lyric fields based on LineType and line order
+	 * @brief Assign content to lyric fields based on the LineType layout and line order
 	 */
-	void AssignContentByLineType(FDreamMusicLyric& Lyric, const TArray<FString>& LinesInGroup, int32 ExpectedLines);
+	void AssignContentByLineType(FDreamMusicLyric& Lyric, TConstArrayView<FStringView> LinesInGroup, int32 ExpectedLines);
 
 	/**
 	 * @brief Process a single line and assign to specific field
 	 */
-	void ProcessLineToField(FDreamMusicLyric& Lyric, const FString& Line, const FString& TargetField);
+	void ProcessLineToField(FDreamMusicLyric& Lyric, FStringView Line, EDreamLyricField TargetField);
 
 	/**
 	 * @brief Extract timestamp-content pairs from a line
+	 *
+	 * @param OutContents Views into Line, only valid while Line is alive
+	 * @param OpenTag Opening delimiter of the timestamp tag ('[' for WordByWord, '<' for ESLyric)
+	 * @param CloseTag Closing delimiter of the timestamp tag
 	 */
-	bool ExtractTimestampContentPairs(const FString& Line, TArray<FDreamMusicLyricTimestamp>& OutTimestamps, TArray<FString>& OutContents, const FString& RegexPattern);
+	bool ExtractTimestampContentPairs(FStringView Line, TArray<FDreamLyricTime>& OutTimestamps, TArray<FStringView>& OutContents, TCHAR OpenTag, TCHAR CloseTag);
 
 	/**
 	 * @brief Build word timings from timestamps and content (DEPRECATED - use BuildWordTimingsFromSegments instead)
 	 */
-	FString BuildWordsFromTimestamps(const TArray<FDreamMusicLyricTimestamp>& Timestamps, const TArray<FString>& Contents, TArray<FDreamMusicLyricWord>& OutWords);
+	FString BuildWordsFromTimestamps(const TArray<FDreamLyricTime>& Timestamps, const TArray<FStringView>& Contents, TArray<FDreamMusicLyricWord>& OutWords);
 
 	/**
 	 * @brief Build word timings from word segments (similar to ASS parsing approach)
 	 */
-	FString BuildWordTimingsFromSegments(const TArray<FDreamMusicLyricTimestamp>& Timestamps, const TArray<FString>& Contents, TArray<FDreamMusicLyricWord>& OutWords);
+	FString BuildWordTimingsFromSegments(const TArray<FDreamLyricTime>& Timestamps, const TArray<FStringView>& Contents, TArray<FDreamMusicLyricWord>& OutWords);
 
 	/**
 	 * @brief Build detailed character-level timings within word segments
 	 */
-	FString BuildDetailedWordTimingsFromSegments(const TArray<FDreamMusicLyricTimestamp>& Timestamps, const TArray<FString>& Contents, TArray<FDreamMusicLyricWord>& OutWords);
+	FString BuildDetailedWordTimingsFromSegments(const TArray<FDreamLyricTime>& Timestamps, const TArray<FStringView>& Contents, TArray<FDreamMusicLyricWord>& OutWords);
 
 	/**
 	 * @brief Calculate end timestamp for a character
 	 */
-	FDreamMusicLyricTimestamp CalculateEndTimestamp(const FDreamMusicLyricTimestamp& StartTimestamp, int32 CharIndex, const FString& WordContent, int32 SegmentIndex, const TArray<FDreamMusicLyricTimestamp>& AllTimestamps);
+	FDreamLyricTime CalculateEndTimestamp(FDreamLyricTime StartTimestamp, int32 CharIndex, FStringView WordContent, int32 SegmentIndex, const TArray<FDreamLyricTime>& AllTimestamps);
 
 	/**
 	 * @brief Create timestamp from total milliseconds
 	 */
-	FDreamMusicLyricTimestamp CreateTimestampFromMs(int32 TotalMs);
+	FDreamMusicLyricTimestamp CreateTimestampFromMs(int32 TotalMs) const;
 
 	/**
 	 * @brief Assign content and word timings to appropriate field
 	 */
-	void AssignToField(FDreamMusicLyric& Lyric, const FString& Content, const TArray<FDreamMusicLyricWord>& Words, const FString& TargetField);
+	void AssignToField(FDreamMusicLyric& Lyric, FString&& Content, TArray<FDreamMusicLyricWord>&& Words, EDreamLyricField TargetField);
 
 	/**
 	 * @brief Extract content from LRC line (removes timestamp)
 	 */
-	FString ExtractContentFromLine(const FString& Line);
+	FString ExtractContentFromLine(FStringView Line);
+
+	void ProcessWordByWordToField(FDreamMusicLyric& Lyric, FStringView Line, EDreamLyricField TargetField);
+	void ProcessESLyricToField(FDreamMusicLyric& Lyric, FStringView Line, EDreamLyricField TargetField);
+	void ProcessLineByLineToField(FDreamMusicLyric& Lyric, FStringView Line, EDreamLyricField TargetField);
 
-	void ProcessWordByWordToField(FDreamMusicLyric& Lyric, const FString& Line, const FString& TargetField);
-	void ProcessESLyricToField(FDreamMusicLyric& Lyric, const FString& Line, const FString& TargetField);
-	void ProcessLineByLineToField(FDreamMusicLyric& Lyric, const FString& Line, const FString& TargetField);
+private:
+	// 逐字解析的临时缓冲, 在同一文件的所有行之间复用
+	TArray<FDreamLyricTime> ScratchTimestamps;
+	TArray<FStringView> ScratchContents;
 };
\ No newline at end of file
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief One karaoke syllable produced by FDreamLyricKaraokeTokenizer
+ *
+ * Text is a span of the clean (tag-free) text, times are cumulative centiseconds from the dialogue start.
+ */
+struct FDreamLyricKaraokeSpan
+{
+	int32 TextOffset = 0;
+	int32 TextLength = 0;
+	int32 StartCentiseconds = 0;
+	int32 EndCentiseconds = 0;
+};
+
+/**
+ * @brief Single-pass tokenizer for ASS dialogue text with override blocks
+ *
+ * Understands the karaoke tags \k, \K, \kf and \ko. Every other override tag (\pos, \fad, \t(...) ...) is skipped
+ * without being parsed. \N and \n become line breaks and \h becomes a space.
+ */
+namespace FDreamLyricKaraokeTokenizer
+{
+	/**
+	 * @brief Strip override blocks from Text and collect karaoke syllables
+	 *
+	 * A syllable runs from its karaoke tag to the next karaoke tag. Syllables without text still advance the time
+	 * but are not emitted.
+	 *
+	 * @param Text Dialogue text
+	 * @param OutCleanText Receives the text without override blocks (appended)
+	 * @param OutSpans Receives the karaoke syllables (appended), offsets are relative to OutCleanText
+	 * @return Number of syllables emitted
+	 */
+	DREAMMUSICPLAYER_API int32 Tokenize(FStringView Text, FString& OutCleanText, TArray<FDreamLyricKaraokeSpan>& OutSpans);
+}
@@ -3,6 +3,8 @@
 #include "DreamMusicPlayerCommon.h"
 
 struct FDreamMusicPlayerLyricFileParserBase;
+struct FDreamLyricTrack;
+struct FDreamLyricCacheKey;
 struct FDreamMusicLyric;
 enum class EDreamMusicPlayerLyricParseLineType : uint8;
 enum class EDreamMusicPlayerLyricParseFileType : uint8;
@@ -11,39 +13,76 @@ enum class EDreamMusicPlayerLyricParseFileType : uint8;
 struct DREAMMUSICPLAYER_API FDreamLyricParser
 {
 	FDreamLyricParser() = delete;
-	FDreamLyricParser(FString InFilePath, EDreamMusicPlayerLyricParseFileType InFileType, EDreamMusicPlayerLyricParseLineType InLineType, EDreamMusicPlayerLrcLyricType InLrcParseMethod = EDreamMusicPlayerLrcLyricType::None);
+	/**
+	 * @param bInAllowCache 为 false 时不读写二进制歌词缓存 (例如 Cook 烘焙), 为 true 时由 bEnableLyricCache 决定
+	 */
+	FDreamLyricParser(FString InFilePath, EDreamMusicPlayerLyricParseFileType InFileType, EDreamMusicPlayerLyricParseLineType InLineType, EDreamMusicPlayerLrcLyricType InLrcParseMethod = EDreamMusicPlayerLrcLyricType::None, bool bInAllowCache = true);
+
+	// CachedFileLines 与 Parser 引用本对象的 CachedFileContent, 复制或移动后会指向原对象, 因此禁止
+	FDreamLyricParser(const FDreamLyricParser&) = delete;
+	FDreamLyricParser& operator=(const FDreamLyricParser&) = delete;
+	FDreamLyricParser(FDreamLyricParser&&) = delete;
+	FDreamLyricParser& operator=(FDreamLyricParser&&) = delete;
 
 public:
 	FString FilePath;
+	// 解码后的文件内容, 文件只读取 (或映射) 一次
 	FString CachedFileContent;
-	TArray<FString> CachedFileLines;
+	// 指向 CachedFileContent 的行视图, 解析器直接使用这些视图
+	TArray<FStringView> CachedFileLines;
 	TMap<FString, FString> MetaData;
 	TArray<FDreamMusicLyric> Lyrics;
 	EDreamMusicPlayerLyricParseFileType FileType;
 	EDreamMusicPlayerLyricParseLineType LineType;
 	EDreamMusicPlayerLrcLyricType LrcParseMethod = EDreamMusicPlayerLrcLyricType::LineByLine;
 	TSharedPtr<FDreamMusicPlayerLyricFileParserBase> Parser;
+	// 解析结果 (或从二进制缓存加载的结果)
+	TSharedPtr<const FDreamLyricTrack> Track;
+	// 源文件内容哈希, 仅在读取源文件后有效
+	uint64 SourceHash = 0;
+	bool bLoadedFromCache = false;
+	bool bAllowCache = true;
+	// 排序前源文件中开始时间早于前一行的歌词行数, 仅在解析源文件时填充 (缓存结果总是 0)
+	int32 NumUnsortedSourceLines = 0;
+	// 第一个乱序行在源文件歌词行中的序号与开始时间, 没有乱序时为 INDEX_NONE
+	int32 FirstUnsortedSourceLine = INDEX_NONE;
+	FDreamLyricTime FirstUnsortedSourceTime;
 
 public:
 	void BeginDecodeFile();
 	void InitializeParser();
 
+	/**
+	 * 读取 (优先内存映射) 并解码文件, 填充 CachedFileContent 与 CachedFileLines
+	 */
+	bool LoadFileContent();
+
+	/**
+	 * 尝试从二进制缓存加载, 命中时填充 Track 与 MetaData
+	 */
+	bool TryLoadFromCache(const FDreamLyricCacheKey& Key);
+
+	/**
+	 * 将当前解析结果写入二进制缓存
+	 */
+	void SaveToCache(const FDreamLyricCacheKey& Key) const;
+
 	void ClearCachedLines();
 	void ClearLyrics();
 
-	TArray<FDreamMusicLyric> GetLyrics();
+	const TArray<FDreamMusicLyric>& GetLyrics();
+	TSharedPtr<const FDreamLyricTrack> GetTrack() const { return Track; }
 
 	void SortLyricsByTimestamp();
 	bool IsValidLyricFile() const;
 	FString GetFileExtension() const;
 
 	EDreamMusicPlayerLyricParseFileType DetectFileType() const;
-	EDreamMusicPlayerLrcLyricType DetectLRCSubtype() const;
 
-	void ExtractMetadata();
+	// 元数据 (LRC 的 [ti:] [ar:] [al:] [offset:] ...), 解析或从缓存加载时填充
 	FString GetMetadata(const FString& Key) const;
 
-	int32 GetLyricCount() const { return Lyrics.Num(); }
+	int32 GetLyricCount() const;
 	float GetTotalDuration() const;
 
 	bool ValidateTimestamps() const;
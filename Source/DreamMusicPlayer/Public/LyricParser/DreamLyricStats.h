@@ -0,0 +1,48 @@
+﻿#pragma once
+
+#include "DreamMusicPlayerCommon.h"
+#include "HAL/LowLevelMemTracker.h"
+
+// 歌词数据的 LLM 标签 (-llm 启动参数下可见)
+LLM_DECLARE_TAG_API(DreamMusicPlayer_Lyrics, DREAMMUSICPLAYER_API);
+
+/**
+ * @brief Process-wide counters of the lyric pipeline
+ *
+ * Every remaining deep copy of lyric data (FDreamMusicLyric built from a track for Blueprint, streaming snapshots)
+ * is recorded here, together with every track that was built or loaded and every source file read.
+ * With bMaterializeLyricList disabled, loading a lyric file should report no copied lines.
+ *
+ * Console: DreamMusicPlayer.Lyric.Stats / DreamMusicPlayer.Lyric.ResetStats
+ */
+namespace FDreamLyricStats
+{
+	struct FSnapshot
+	{
+		// FDreamMusicLyric 深拷贝的行数与字节数
+		int64 NumLinesCopied = 0;
+		int64 BytesCopied = 0;
+
+		// 构建 (或从缓存、烘焙数据加载) 的轨道
+		int64 NumTracks = 0;
+		int64 TrackBytes = 0;
+
+		// 读取的源文件
+		int64 NumFilesRead = 0;
+		int64 FileBytesRead = 0;
+
+		DREAMMUSICPLAYER_API FString ToString() const;
+	};
+
+	DREAMMUSICPLAYER_API void RecordLinesCopied(int64 NumLines, int64 Bytes);
+	DREAMMUSICPLAYER_API void RecordTrack(int64 Bytes);
+	DREAMMUSICPLAYER_API void RecordFileRead(int64 Bytes);
+
+	DREAMMUSICPLAYER_API FSnapshot GetSnapshot();
+	DREAMMUSICPLAYER_API void Reset();
+
+	/**
+	 * @brief Heap size owned by one lyric line (strings and word timings)
+	 */
+	DREAMMUSICPLAYER_API SIZE_T GetAllocatedSize(const FDreamMusicLyric& Lyric);
+}
@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "DreamMusicPlayerCommon.h"
+#include <atomic>
+
+struct FDreamLyricTrack;
+struct FDreamMusicPlayerLyricFileParserBase;
+
+/**
+ * @brief Incremental lyric loader for large SRT / ASS files
+ *
+ * The file is read in chunks through IAsyncReadFileHandle, the next chunk is already in flight while the current one
+ * is parsed. Only complete lines are decoded and fed to the format parser (FDreamMusicPlayerLyricFileParserBase::ParseLines).
+ * Snapshots of the lyrics parsed so far are published as immutable tracks, so playback can show the first lines
+ * before the rest of the file is processed.
+ */
+class DREAMMUSICPLAYER_API FDreamLyricStreamParser
+{
+public:
+	/**
+	 * Called for every published track, bFinal is true for the last call (exactly once, Track may be null on failure).
+	 * Runs on the thread that called Run.
+	 */
+	using FOnTrackPublished = TFunction<void(TSharedPtr<const FDreamLyricTrack> Track, bool bFinal)>;
+
+	// 每次读取的字节数
+	static constexpr int64 DefaultChunkSize = 64 * 1024;
+
+	// 第一次发布所需的歌词行数, 之后每当行数翻倍时发布一次
+	static constexpr int32 FirstPublishLineCount = 8;
+
+	FDreamLyricStreamParser(FString InFilePath, EDreamMusicPlayerLyricParseFileType InFileType, EDreamMusicPlayerLyricParseLineType InLineType, int64 InChunkSize = DefaultChunkSize);
+	~FDreamLyricStreamParser();
+
+	/**
+	 * @brief Only parsers that implement ParseLines can be streamed (LRC needs the whole file to group lines)
+	 */
+	static bool SupportsFileType(EDreamMusicPlayerLyricParseFileType FileType);
+
+	/**
+	 * @brief Load and parse the file, blocks until done. Run it on a worker thread.
+	 *
+	 * A valid binary cache entry is published directly as the final track.
+	 *
+	 * @param OnTrackPublished Receives partial and final tracks
+	 * @param CancelFlag Optional, stops after the chunk being parsed
+	 * @return True if the final track contains lyrics
+	 */
+	bool Run(const FOnTrackPublished& OnTrackPublished, const std::atomic<bool>* CancelFlag = nullptr);
+
+private:
+	// 解码一段完整的 UTF-8 行并交给解析器
+	void FeedUTF8(const uint8* Bytes, int32 NumBytes);
+	void FeedText(FStringView Text);
+
+	// 构建当前已解析歌词的快照
+	TSharedPtr<const FDreamLyricTrack> BuildSnapshot() const;
+
+	// 解析结束后取走全部歌词构建最终轨道
+	TSharedPtr<const FDreamLyricTrack> BuildFinalTrack();
+
+	FString FilePath;
+	EDreamMusicPlayerLyricParseFileType FileType;
+	EDreamMusicPlayerLyricParseLineType LineType;
+	int64 ChunkSize;
+
+	TUniquePtr<FDreamMusicPlayerLyricFileParserBase> Parser;
+	TArray<FStringView> ChunkLines;
+};
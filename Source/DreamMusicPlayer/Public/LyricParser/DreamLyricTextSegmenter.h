@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+class IBreakIterator;
+
+/**
+ * @brief 歌词文本的字素簇 / 分词边界计算
+ *
+ * 使用 ICU 的字素簇与分词迭代器, 代理对, emoji 序列与组合字符不会被拆开. 边界以相对文本开头的结束偏移表示,
+ * 第 i 段为 [Ends[i - 1], Ends[i]), 第 0 段从 0 开始, 最后一个结束偏移等于文本长度.
+ *
+ * 迭代器创建成本较高, 批量处理时复用同一个实例. 非线程安全.
+ */
+class DREAMMUSICPLAYER_API FDreamLyricTextSegmenter
+{
+public:
+	FDreamLyricTextSegmenter();
+
+	/**
+	 * @brief 追加 Text 中每个字素簇的结束偏移
+	 * @return 追加的数量
+	 */
+	int32 AppendGraphemeEnds(FStringView Text, TArray<int32>& OutEnds);
+
+	/**
+	 * @brief 追加 Text 中每个分词片段 (单词, 空白, 标点, CJK 字/词) 的结束偏移
+	 * @return 追加的数量
+	 */
+	int32 AppendWordBreakEnds(FStringView Text, TArray<int32>& OutEnds);
+
+private:
+	static int32 AppendBoundaries(IBreakIterator& Iterator, FStringView Text, TArray<int32>& OutEnds);
+
+	TSharedRef<IBreakIterator> GraphemeIterator;
+	TSharedRef<IBreakIterator> WordIterator;
+};
@@ -0,0 +1,97 @@
+﻿#pragma once
+
+#include "DreamMusicPlayerCommon.h"
+
+/**
+ * @brief Allocation-free timestamp scanner shared by every lyric format
+ *
+ * Works directly on TStringView and understands:
+ * - LRC line tags        [mm:ss.xx] [mm:ss.xxx] [mm:ss:xx]
+ * - ESLyric word tags    <mm:ss.xxx>
+ * - SRT clock            HH:MM:SS,mmm
+ * - ASS clock            H:MM:SS.cc
+ *
+ * Fractions of 1, 2 or 3 digits are normalised to milliseconds (tenths, centiseconds, milliseconds).
+ */
+namespace FDreamLyricTimestampScanner
+{
+	/**
+	 * @brief Scan a clock value at the beginning of the view
+	 *
+	 * @param Text Text that starts with the clock value
+	 * @param OutTime Parsed time
+	 * @return Number of characters consumed, 0 when the view does not start with a clock value
+	 */
+	DREAMMUSICPLAYER_API int32 ScanClock(FStringView Text, FDreamLyricTime& OutTime);
+
+	/**
+	 * @brief Scan a delimited clock tag at the beginning of the view, e.g. [00:48.710] or <00:48.710>
+	 *
+	 * @return Number of characters consumed including both delimiters, 0 when there is no valid tag
+	 */
+	DREAMMUSICPLAYER_API int32 ScanTag(FStringView Text, TCHAR OpenTag, TCHAR CloseTag, FDreamLyricTime& OutTime);
+
+	/**
+	 * @brief Find the first delimited clock tag in the view
+	 *
+	 * @param OutTagStart Index of the opening delimiter
+	 * @param OutTagLength Length of the tag including both delimiters
+	 * @return True if a tag was found
+	 */
+	DREAMMUSICPLAYER_API bool FindTag(FStringView Text, TCHAR OpenTag, TCHAR CloseTag, FDreamLyricTime& OutTime, int32& OutTagStart, int32& OutTagLength);
+
+	/**
+	 * @brief Find the first clock value anywhere in the view
+	 */
+	DREAMMUSICPLAYER_API bool FindClock(FStringView Text, FDreamLyricTime& OutTime);
+
+	/**
+	 * @brief Scan a SRT time range, e.g. "00:00:48,710 --> 00:00:58,770"
+	 */
+	DREAMMUSICPLAYER_API bool ScanRange(FStringView Text, FDreamLyricTime& OutStart, FDreamLyricTime& OutEnd);
+
+	/**
+	 * @brief Walk every "tag + content" segment of a line without allocating
+	 *
+	 * Text before the first tag is skipped. Content runs until the next valid tag or the end of the line.
+	 *
+	 * @param Callback void(FDreamLyricTime Time, FStringView Content)
+	 * @return Number of segments visited
+	 */
+	template <typename CallbackType>
+	int32 ForEachTaggedSegment(FStringView Line, TCHAR OpenTag, TCHAR CloseTag, CallbackType&& Callback)
+	{
+		FDreamLyricTime SegmentTime;
+		int32 TagStart = 0;
+		int32 TagLength = 0;
+
+		if (!FindTag(Line, OpenTag, CloseTag, SegmentTime, TagStart, TagLength))
+		{
+			return 0;
+		}
+
+		int32 Count = 0;
+		FStringView Rest = Line.RightChop(TagStart + TagLength);
+
+		while (true)
+		{
+			FDreamLyricTime NextTime;
+			int32 NextStart = 0;
+			int32 NextLength = 0;
+			const bool bHasNext = FindTag(Rest, OpenTag, CloseTag, NextTime, NextStart, NextLength);
+
+			Callback(SegmentTime, bHasNext ? Rest.Left(NextStart) : Rest);
+			Count++;
+
+			if (!bHasNext)
+			{
+				break;
+			}
+
+			SegmentTime = NextTime;
+			Rest = Rest.RightChop(NextStart + NextLength);
+		}
+
+		return Count;
+	}
+}
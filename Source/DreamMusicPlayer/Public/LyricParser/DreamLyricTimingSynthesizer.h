@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include "DreamMusicPlayerCommon.h"
+
+/**
+ * @brief Load-time estimation of per-grapheme timings for lines without word timings
+ *
+ * Line-only lyrics (LineByLine LRC, SRT, ASS without karaoke tags) only carry a line range. The line duration is
+ * split over the grapheme clusters of the text by weight: CJK characters and kana count as one syllable each,
+ * alphabetic characters as a fraction of one, spaces and punctuation as zero. Zero-weight graphemes are merged
+ * into the previous syllable, so the syllables cover the whole text and can reference it directly.
+ * The grapheme clusters come from the segmentation the track computes once per line (FDreamLyricTextSegmenter).
+ *
+ * Enabled by UDreamMusicPlayerSettings::bSynthesizeWordTimings, FDreamLyricTrack applies it while building.
+ */
+namespace FDreamLyricTimingSynthesizer
+{
+	/**
+	 * @brief One synthesized syllable, the text is a span of the line text
+	 */
+	struct FSyllable
+	{
+		int32 TextOffset = 0;
+		int32 TextLength = 0;
+		FDreamLyricTime StartTime;
+		FDreamLyricTime EndTime;
+	};
+
+	/**
+	 * @brief Is synthesis enabled in the project settings
+	 */
+	DREAMMUSICPLAYER_API bool IsEnabled();
+
+	/**
+	 * @brief Relative duration of a code point, 0 for spaces and punctuation
+	 */
+	DREAMMUSICPLAYER_API float GetCodePointWeight(UTF32CHAR CodePoint);
+
+	/**
+	 * @brief Split [StartTime, EndTime) over the graphemes of Text
+	 *
+	 * @param GraphemeEnds End offset of each grapheme cluster of Text, see FDreamLyricTextSegmenter
+	 * @param OutSyllables Receives the syllables (appended), contiguous in time and covering the whole text
+	 * @return Number of syllables emitted, 0 when the text has no weighted grapheme or the range is empty
+	 */
+	DREAMMUSICPLAYER_API int32 Synthesize(FStringView Text, TConstArrayView<int32> GraphemeEnds, FDreamLyricTime StartTime, FDreamLyricTime EndTime, TArray<FSyllable>& OutSyllables);
+}
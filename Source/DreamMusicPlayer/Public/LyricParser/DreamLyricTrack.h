@@ -0,0 +1,279 @@
+﻿#pragma once
+
+#include "DreamMusicPlayerCommon.h"
+#include "LyricParser/DreamLyricTimingSynthesizer.h"
+
+class FDreamLyricTextSegmenter;
+
+/**
+ * @brief 文本池中的一段文本
+ */
+struct FDreamLyricTextSpan
+{
+	int32 Offset = 0;
+	int32 Length = 0;
+
+	bool IsEmpty() const { return Length == 0; }
+};
+
+/**
+ * @brief 逐字时间所属的文本通道
+ */
+enum class EDreamLyricWordChannel : uint8
+{
+	Lyric = 0,
+	Romanization = 1,
+
+	Num
+};
+
+/**
+ * @brief 不可变的歌词轨道 (Structure-of-Arrays)
+ *
+ * 行/字的起止时间各自连续存放, 所有文本 (原文/翻译/罗马音/逐字) 位于同一个 UTF-16 文本池中, 通过 Span 索引.
+ * 每个通道的逐字表带有逐行偏移表 (NumLines + 1), 行 i 的字范围为 [LineWordOffsets[i], LineWordOffsets[i + 1]).
+ *
+ * 运行时的查找只访问这些连续数组, FDreamMusicLyric 仅在蓝图需要时通过 MaterializeLine 生成.
+ * 开启 bSynthesizeWordTimings 时, 没有逐字时间的行在构建时由 FDreamLyricTimingSynthesizer 生成逐字时间, 文本直接引用行文本.
+ *
+ * 时间轴索引按所有行的起止时间把时间切成若干段, 每段保存该段内同时显示的行 (对唱, 和声等重叠行), 由行时间推导, 不参与序列化.
+ *
+ * 原文与罗马音的字素簇 / 分词边界在构建 (或加载) 时由 FDreamLyricTextSegmenter 一次算出, 供逐字合成, 进度计算与 UMG 排版使用, 同样不参与序列化.
+ */
+struct DREAMMUSICPLAYER_API FDreamLyricTrack
+{
+public:
+	FDreamLyricTrack() = default;
+
+	/**
+	 * @brief 从解析结果构建轨道, 输入需已按开始时间排序
+	 */
+	explicit FDreamLyricTrack(TConstArrayView<FDreamMusicLyric> InLyrics);
+
+	/**
+	 * @brief 按给定顺序从解析结果构建轨道, 用于未排序的解析中间结果, 不复制歌词
+	 */
+	explicit FDreamLyricTrack(TConstArrayView<const FDreamMusicLyric*> InLyrics);
+
+public:
+	int32 NumLines() const { return LineStartTimes.Num(); }
+	bool IsEmpty() const { return LineStartTimes.IsEmpty(); }
+	bool IsValidLine(int32 LineIndex) const { return LineStartTimes.IsValidIndex(LineIndex); }
+
+	FDreamLyricTime GetLineStartTime(int32 LineIndex) const { return LineStartTimes[LineIndex]; }
+	FDreamLyricTime GetLineEndTime(int32 LineIndex) const { return LineEndTimes[LineIndex]; }
+	TConstArrayView<FDreamLyricTime> GetLineStartTimes() const { return LineStartTimes; }
+	TConstArrayView<FDreamLyricTime> GetLineEndTimes() const { return LineEndTimes; }
+
+	bool IsEmptyLine(int32 LineIndex) const { return EmptyLineFlags[LineIndex]; }
+
+	FStringView GetLineContent(int32 LineIndex) const { return GetText(LineContentSpans[LineIndex]); }
+	FStringView GetLineTranslate(int32 LineIndex) const { return GetText(LineTranslateSpans[LineIndex]); }
+	FStringView GetLineRomanization(int32 LineIndex) const { return GetText(LineRomanizationSpans[LineIndex]); }
+
+	/**
+	 * @brief 获取某行在指定通道中的第一个字的全局索引
+	 */
+	int32 GetLineWordBegin(EDreamLyricWordChannel Channel, int32 LineIndex) const { return GetWordTable(Channel).LineWordOffsets[LineIndex]; }
+
+	/**
+	 * @brief 获取某行在指定通道中的字数
+	 */
+	int32 GetLineWordCount(EDreamLyricWordChannel Channel, int32 LineIndex) const
+	{
+		const FWordTable& Table = GetWordTable(Channel);
+		return Table.LineWordOffsets[LineIndex + 1] - Table.LineWordOffsets[LineIndex];
+	}
+
+	/**
+	 * @brief 获取某行所有字的开始时间 (连续内存)
+	 */
+	TConstArrayView<FDreamLyricTime> GetLineWordStartTimes(EDreamLyricWordChannel Channel, int32 LineIndex) const
+	{
+		return TConstArrayView<FDreamLyricTime>(GetWordTable(Channel).StartTimes).Slice(GetLineWordBegin(Channel, LineIndex), GetLineWordCount(Channel, LineIndex));
+	}
+
+	/**
+	 * @brief 获取某行所有字的结束时间 (连续内存)
+	 */
+	TConstArrayView<FDreamLyricTime> GetLineWordEndTimes(EDreamLyricWordChannel Channel, int32 LineIndex) const
+	{
+		return TConstArrayView<FDreamLyricTime>(GetWordTable(Channel).EndTimes).Slice(GetLineWordBegin(Channel, LineIndex), GetLineWordCount(Channel, LineIndex));
+	}
+
+	/**
+	 * @brief 获取某行每个字之前 (行内) 所有字的时长之和, 用于 O(1) 计算行内逐字进度
+	 */
+	TConstArrayView<int32> GetLineWordElapsedBefore(EDreamLyricWordChannel Channel, int32 LineIndex) const
+	{
+		return TConstArrayView<int32>(GetWordTable(Channel).ElapsedBefore).Slice(GetLineWordBegin(Channel, LineIndex), GetLineWordCount(Channel, LineIndex));
+	}
+
+	/**
+	 * @brief 获取字文本, WordIndex 为通道内的全局索引
+	 */
+	FStringView GetWordText(EDreamLyricWordChannel Channel, int32 WordIndex) const { return GetText(GetWordTable(Channel).TextSpans[WordIndex]); }
+
+	int32 NumWords(EDreamLyricWordChannel Channel) const { return GetWordTable(Channel).StartTimes.Num(); }
+
+	/**
+	 * @brief 获取某行在指定通道 (原文/罗马音) 文本中每个字素簇的结束偏移, 相对行文本开头
+	 */
+	TConstArrayView<int32> GetLineGraphemeEnds(EDreamLyricWordChannel Channel, int32 LineIndex) const
+	{
+		const FSegmentTable& Table = GetSegmentTable(Channel);
+		return TConstArrayView<int32>(Table.GraphemeEnds).Slice(Table.LineGraphemeOffsets[LineIndex], Table.LineGraphemeOffsets[LineIndex + 1] - Table.LineGraphemeOffsets[LineIndex]);
+	}
+
+	/**
+	 * @brief 获取某行在指定通道 (原文/罗马音) 文本中每个分词片段的结束偏移, 相对行文本开头
+	 */
+	TConstArrayView<int32> GetLineWordBreakEnds(EDreamLyricWordChannel Channel, int32 LineIndex) const
+	{
+		const FSegmentTable& Table = GetSegmentTable(Channel);
+		return TConstArrayView<int32>(Table.WordBreakEnds).Slice(Table.LineWordBreakOffsets[LineIndex], Table.LineWordBreakOffsets[LineIndex + 1] - Table.LineWordBreakOffsets[LineIndex]);
+	}
+
+	/**
+	 * @brief 获取字在所属行文本中的范围 [OutBegin, OutEnd), WordInLine 为行内索引
+	 * @return 字文本不是行文本的一部分时返回 false
+	 */
+	bool GetLineWordTextRange(EDreamLyricWordChannel Channel, int32 LineIndex, int32 WordInLine, int32& OutBegin, int32& OutEnd) const;
+
+	/**
+	 * @brief 二分查找开始时间小于等于 Time 的最后一行
+	 * @return 行索引, 没有则返回 INDEX_NONE
+	 */
+	int32 FindLineIndex(FDreamLyricTime Time) const;
+
+	/**
+	 * @brief 从上一次的结果 (游标) 开始查找开始时间小于等于 Time 的最后一行
+	 *
+	 * 正常播放时游标每帧最多前进几行, 为均摊 O(1); 向前跳转较远时在游标之后二分, 向后跳转或游标无效时退回 FindLineIndex
+	 * @return 行索引, 没有则返回 INDEX_NONE
+	 */
+	int32 AdvanceLineIndex(FDreamLyricTime Time, int32 CursorIndex) const;
+
+	/**
+	 * @brief 获取 Time 时刻所有正在显示的行 ([Start, End) 包含 Time), 按行索引升序
+	 *
+	 * O(log n) 定位时间段, 返回的视图直接引用轨道内的时间轴索引, 在轨道释放前有效
+	 */
+	TConstArrayView<int32> GetActiveLines(FDreamLyricTime Time) const;
+
+	/**
+	 * @brief 生成蓝图使用的歌词行
+	 */
+	FDreamMusicLyric MaterializeLine(int32 LineIndex) const;
+
+	/**
+	 * @brief 生成蓝图使用的单字, WordIndex 为通道内的全局索引
+	 */
+	FDreamMusicLyricWord MaterializeWord(EDreamLyricWordChannel Channel, int32 WordIndex) const;
+
+	/**
+	 * @brief 生成完整的蓝图歌词列表
+	 */
+	void MaterializeLines(TArray<FDreamMusicLyric>& OutLyrics) const;
+
+	/**
+	 * @brief 轨道占用的堆内存
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * @brief 序列化全部连续数组, 用于二进制歌词缓存
+	 */
+	void Serialize(FArchive& Ar);
+
+private:
+	struct FWordTable
+	{
+		TArray<FDreamLyricTime> StartTimes;
+		TArray<FDreamLyricTime> EndTimes;
+		TArray<FDreamLyricTextSpan> TextSpans;
+		TArray<int32> LineWordOffsets;
+
+		// 行内该字之前所有字的时长之和, 由起止时间推导, 不参与序列化
+		TArray<int32> ElapsedBefore;
+
+		SIZE_T GetAllocatedSize() const
+		{
+			return StartTimes.GetAllocatedSize() + EndTimes.GetAllocatedSize() + TextSpans.GetAllocatedSize() + LineWordOffsets.GetAllocatedSize()
+				+ ElapsedBefore.GetAllocatedSize();
+		}
+
+		void BuildElapsedBefore();
+	};
+
+	// 行文本的字素簇 / 分词边界, 行 i 的边界为 [LineXxxOffsets[i], LineXxxOffsets[i + 1]), 不参与序列化
+	struct FSegmentTable
+	{
+		TArray<int32> GraphemeEnds;
+		TArray<int32> LineGraphemeOffsets;
+		TArray<int32> WordBreakEnds;
+		TArray<int32> LineWordBreakOffsets;
+
+		SIZE_T GetAllocatedSize() const
+		{
+			return GraphemeEnds.GetAllocatedSize() + LineGraphemeOffsets.GetAllocatedSize() + WordBreakEnds.GetAllocatedSize() + LineWordBreakOffsets.GetAllocatedSize();
+		}
+
+		void Reset(int32 LineCount, int32 TextLength);
+	};
+
+	const FWordTable& GetWordTable(EDreamLyricWordChannel Channel) const { return WordTables[static_cast<int32>(Channel)]; }
+
+	const FSegmentTable& GetSegmentTable(EDreamLyricWordChannel Channel) const { return SegmentTables[static_cast<int32>(Channel)]; }
+
+	const FDreamLyricTextSpan& GetLineTextSpan(EDreamLyricWordChannel Channel, int32 LineIndex) const
+	{
+		return Channel == EDreamLyricWordChannel::Lyric ? LineContentSpans[LineIndex] : LineRomanizationSpans[LineIndex];
+	}
+
+	FStringView GetText(const FDreamLyricTextSpan& Span) const { return FStringView(TextPool.GetData() + Span.Offset, Span.Length); }
+
+	template <typename LyricAccessorType>
+	void Build(int32 LineCount, LyricAccessorType&& GetLyric);
+
+	FDreamLyricTextSpan AppendText(FStringView Text);
+
+	/**
+	 * @param SyllableScratch 不为空且 Words 为空时, 为该行生成逐字时间
+	 */
+	void AppendWords(EDreamLyricWordChannel Channel, const TArray<FDreamMusicLyricWord>& Words, TArray<FDreamLyricTimingSynthesizer::FSyllable>* SyllableScratch);
+
+	void AppendSegments(EDreamLyricWordChannel Channel, int32 LineIndex, FDreamLyricTextSegmenter& Segmenter);
+
+	void BuildSegments();
+
+	void MaterializeWords(EDreamLyricWordChannel Channel, int32 LineIndex, TArray<FDreamMusicLyricWord>& OutWords) const;
+
+	void BuildTimeline();
+
+private:
+	// 行时间
+	TArray<FDreamLyricTime> LineStartTimes;
+	TArray<FDreamLyricTime> LineEndTimes;
+
+	// 行文本
+	TArray<FDreamLyricTextSpan> LineContentSpans;
+	TArray<FDreamLyricTextSpan> LineTranslateSpans;
+	TArray<FDreamLyricTextSpan> LineRomanizationSpans;
+
+	TBitArray<> EmptyLineFlags;
+
+	// 逐字表 (Lyric / Romanization)
+	FWordTable WordTables[static_cast<int32>(EDreamLyricWordChannel::Num)];
+
+	// 字素簇 / 分词边界 (Lyric / Romanization)
+	FSegmentTable SegmentTables[static_cast<int32>(EDreamLyricWordChannel::Num)];
+
+	// 文本池
+	TArray<TCHAR> TextPool;
+
+	// 时间轴索引: 段 i 为 [TimelineTimes[i], TimelineTimes[i + 1]), 活动行为 TimelineLines[TimelineLineOffsets[i], TimelineLineOffsets[i + 1])
+	TArray<FDreamLyricTime> TimelineTimes;
+	TArray<int32> TimelineLineOffsets;
+	TArray<int32> TimelineLines;
+};
@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include "DreamMusicPlayerCommon.h"
+#include "Containers/LruCache.h"
+
+struct FDreamLyricTrack;
+
+/**
+ * @brief 内存歌词轨道缓存的键: 文件路径 + 修改时间 + 大小 + 解析设置
+ */
+struct FDreamLyricTrackCacheKey
+{
+	FString FilePath;
+	FDateTime SourceTimestamp;
+	int64 SourceSize = 0;
+
+	EDreamMusicPlayerLyricParseFileType FileType = EDreamMusicPlayerLyricParseFileType::LRC;
+	EDreamMusicPlayerLyricParseLineType LineType = EDreamMusicPlayerLyricParseLineType::Lyric_Only;
+	EDreamMusicPlayerLrcLyricType LrcLyricType = EDreamMusicPlayerLrcLyricType::None;
+	bool bSynthesizeWordTimings = false;
+
+	bool operator==(const FDreamLyricTrackCacheKey& Other) const
+	{
+		return SourceTimestamp == Other.SourceTimestamp && SourceSize == Other.SourceSize && FileType == Other.FileType
+			&& LineType == Other.LineType && LrcLyricType == Other.LrcLyricType && bSynthesizeWordTimings == Other.bSynthesizeWordTimings
+			&& FilePath == Other.FilePath;
+	}
+
+	friend uint32 GetTypeHash(const FDreamLyricTrackCacheKey& Key)
+	{
+		uint32 Hash = GetTypeHash(Key.FilePath);
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.SourceTimestamp));
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.SourceSize));
+		Hash = HashCombineFast(Hash, static_cast<uint32>(Key.FileType) | static_cast<uint32>(Key.LineType) << 8 | static_cast<uint32>(Key.LrcLyricType) << 16
+			| static_cast<uint32>(Key.bSynthesizeWordTimings) << 24);
+		return Hash;
+	}
+};
+
+/**
+ * @brief Process-wide LRU cache of parsed lyric tracks
+ *
+ * Hands out the same immutable FDreamLyricTrack to every player that requests a file with the same settings, so loop
+ * restarts, PlayLastMusic and several components playing one song neither re-parse nor duplicate the track.
+ * The cache is bounded by UDreamMusicPlayerSettings::LyricTrackCacheBudgetMB; evicting an entry only drops the
+ * cache's reference, players keep their track alive. Thread safe.
+ *
+ * Console: DreamMusicPlayer.Lyric.TrackCache / DreamMusicPlayer.Lyric.ClearTrackCache
+ */
+class DREAMMUSICPLAYER_API FDreamLyricTrackCache
+{
+public:
+	static FDreamLyricTrackCache& Get();
+
+	/**
+	 * @brief 读取文件的修改时间与大小构建缓存键
+	 * @return 文件不存在时返回 false, 此时 OutKey 仍包含路径与解析设置
+	 */
+	static bool MakeKey(const FString& FilePath,
+	                    EDreamMusicPlayerLyricParseFileType FileType,
+	                    EDreamMusicPlayerLyricParseLineType LineType,
+	                    EDreamMusicPlayerLrcLyricType LrcLyricType,
+	                    FDreamLyricTrackCacheKey& OutKey);
+
+	/**
+	 * @brief 查找并标记为最近使用
+	 */
+	TSharedPtr<const FDreamLyricTrack> Find(const FDreamLyricTrackCacheKey& Key);
+
+	/**
+	 * @brief 加入缓存
+	 * @return 缓存中的轨道; 其他线程已加入同一键时返回已有的轨道, 调用方应使用返回值
+	 */
+	TSharedPtr<const FDreamLyricTrack> Add(const FDreamLyricTrackCacheKey& Key, TSharedPtr<const FDreamLyricTrack> Track);
+
+	/**
+	 * @brief 查找, 未命中时在当前线程解析并加入缓存
+	 */
+	TSharedPtr<const FDreamLyricTrack> FindOrLoad(const FString& FilePath,
+	                                              EDreamMusicPlayerLyricParseFileType FileType,
+	                                              EDreamMusicPlayerLyricParseLineType LineType,
+	                                              EDreamMusicPlayerLrcLyricType LrcLyricType);
+
+	void Empty();
+
+	/**
+	 * @brief 预算为 0 时缓存关闭, 加入的轨道不会被保留
+	 */
+	static bool IsEnabled() { return GetBudgetBytes() > 0; }
+
+	int32 Num() const;
+	int64 GetUsedBytes() const;
+
+	FString GetStatsString() const;
+
+private:
+	FDreamLyricTrackCache();
+
+	static int64 GetBudgetBytes();
+
+	// 调用方需持有 Lock
+	void EvictToBudget(int64 BudgetBytes, int64 IncomingBytes);
+
+	struct FEntry
+	{
+		TSharedPtr<const FDreamLyricTrack> Track;
+		int64 Bytes = 0;
+	};
+
+	mutable FCriticalSection Lock;
+	TLruCache<FDreamLyricTrackCacheKey, FEntry> Entries;
+	int64 UsedBytes = 0;
+
+	int64 NumHits = 0;
+	int64 NumMisses = 0;
+	int64 NumEvictions = 0;
+};
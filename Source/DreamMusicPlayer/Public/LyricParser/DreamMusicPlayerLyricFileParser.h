@@ -1,8 +1,54 @@
 ﻿#pragma once
 
 #include "DreamLyricGroupProcessor.h"
+#include "DreamLyricKaraokeTokenizer.h"
 #include "DreamMusicPlayerCommon.h"
 
+/**
+ * @brief 歌词行在源文件中的顺序检查
+ * 
+ * 解析器按源文件顺序记录每一行歌词的开始时间, 排序之后轨道总是有序的, 乱序只能在这里发现
+ */
+struct FDreamLyricSourceOrder
+{
+	// 开始时间早于源文件中前一行的歌词行数
+	int32 NumUnsortedLines = 0;
+
+	// 第一个乱序行在源文件歌词行中的序号 (从 0 开始), 没有乱序时为 INDEX_NONE
+	int32 FirstUnsortedLine = INDEX_NONE;
+
+	// 第一个乱序行的开始时间
+	FDreamLyricTime FirstUnsortedTime;
+
+	// 已记录的歌词行数
+	int32 NumLines = 0;
+
+	FDreamLyricTime LastStartTime;
+
+	void Add(FDreamLyricTime StartTime)
+	{
+		if (NumLines > 0 && StartTime < LastStartTime)
+		{
+			MarkUnsorted(StartTime);
+		}
+		else
+		{
+			LastStartTime = StartTime;
+		}
+		NumLines++;
+	}
+
+	// 记录一行乱序的歌词, 不更新 LastStartTime, 之后的行仍与之前最晚的行比较
+	void MarkUnsorted(FDreamLyricTime StartTime)
+	{
+		if (NumUnsortedLines++ == 0)
+		{
+			FirstUnsortedLine = NumLines;
+			FirstUnsortedTime = StartTime;
+		}
+	}
+};
+
 /**
  * @brief 歌词文件解析器基类
  * 
@@ -23,12 +69,13 @@ public:
 	 * @brief 构造函数
 	 * 
 	 * 使用指定的文件内容、行数据和行类型初始化解析器
+	 * 解析器不复制文件内容, 内容与行视图由调用方 (FDreamLyricParser) 持有, 需在解析期间保持有效
 	 * 
-	 * @param InFileContent 完整的歌词文件内容字符串
-	 * @param InLines 按行分割的歌词文件内容数组
+	 * @param InFileContent 完整的歌词文件内容
+	 * @param InLines 指向文件内容的行视图
 	 * @param InLineType 歌词行的解析类型枚举值
 	 */
-	FDreamMusicPlayerLyricFileParserBase(const FString& InFileContent, const TArray<FString>& InLines, EDreamMusicPlayerLyricParseLineType InLineType)
+	FDreamMusicPlayerLyricFileParserBase(FStringView InFileContent, TConstArrayView<FStringView> InLines, EDreamMusicPlayerLyricParseLineType InLineType)
 		: FileContent(InFileContent), Lines(InLines), LineType(InLineType)
 	{
 	}
@@ -42,10 +89,10 @@ public:
 
 protected:
 	// 完整的歌词文件内容
-	FString FileContent;
+	FStringView FileContent;
 
-	// 按行分割的歌词内容数组
-	TArray<FString> Lines;
+	// 按行分割的歌词内容视图
+	TConstArrayView<FStringView> Lines;
 
 	// 解析后的歌词数据数组
 	TArray<FDreamMusicLyric> ParsedLyrics;
@@ -53,6 +100,9 @@ protected:
 	// 歌词行解析类型
 	EDreamMusicPlayerLyricParseLineType LineType;
 
+	// 排序前的源文件顺序
+	FDreamLyricSourceOrder SourceOrder;
+
 public:
 	/**
 	 * @brief 执行歌词解析的纯虚函数
@@ -70,6 +120,31 @@ public:
 	 */
 	virtual void ProcessText(FDreamMusicLyric& Lyric);
 
+	/**
+	 * @brief 是否支持流式解析
+	 * 
+	 * 支持时可以多次调用 ParseLines 逐块输入, 最后调用 FinishParse
+	 */
+	virtual bool SupportsStreaming() const { return false; }
+
+	/**
+	 * @brief 流式解析一批完整的行
+	 * 
+	 * 行视图只在调用期间有效, 跨批次的状态由解析器自行持有
+	 * 
+	 * @param InLines 本批次的行视图
+	 */
+	virtual void ParseLines(TConstArrayView<FStringView> InLines)
+	{
+	}
+
+	/**
+	 * @brief 结束流式解析, 输出缓冲中剩余的歌词
+	 */
+	virtual void FinishParse()
+	{
+	}
+
 	/**
 	 * @brief 获取解析后的歌词数据
 	 * 
@@ -77,12 +152,28 @@ public:
 	 */
 	const TArray<FDreamMusicLyric>& GetParsedLyrics() const { return ParsedLyrics; }
 
+	/**
+	 * @brief 取走解析后的歌词数据, 解析器随后为空
+	 * 
+	 * @return TArray<FDreamMusicLyric> 解析后的歌词数组, 以移动方式返回
+	 */
+	TArray<FDreamMusicLyric> TakeParsedLyrics() { return MoveTemp(ParsedLyrics); }
+
+	/**
+	 * @brief 获取源文件中歌词行的顺序检查结果
+	 */
+	const FDreamLyricSourceOrder& GetSourceOrder() const { return SourceOrder; }
+
 	/**
 	 * @brief 清空已解析的数据
 	 * 
 	 * 重置解析结果，清空已存储的歌词数据
 	 */
-	virtual void ClearParsedData() { ParsedLyrics.Empty(); }
+	virtual void ClearParsedData()
+	{
+		ParsedLyrics.Empty();
+		SourceOrder = FDreamLyricSourceOrder();
+	}
 };
 
 
@@ -93,7 +184,7 @@ public:
 struct DREAMMUSICPLAYER_API FDreamMusicPlayerLyricFileParser_SRT : public FDreamMusicPlayerLyricFileParserBase
 {
 public:
-	FDreamMusicPlayerLyricFileParser_SRT(const FString& InFileContent, const TArray<FString>& InLines, EDreamMusicPlayerLyricParseLineType InLineType)
+	FDreamMusicPlayerLyricFileParser_SRT(FStringView InFileContent, TConstArrayView<FStringView> InLines, EDreamMusicPlayerLyricParseLineType InLineType)
 		: FDreamMusicPlayerLyricFileParserBase(InFileContent, InLines, InLineType)
 	{
 	}
@@ -102,12 +193,32 @@ public:
 	virtual void Parse() override;
 	virtual void ProcessText(FDreamMusicLyric& Lyric) override;
 
+	virtual bool SupportsStreaming() const override { return true; }
+	virtual void ParseLines(TConstArrayView<FStringView> InLines) override;
+	virtual void FinishParse() override;
+
 protected:
+	// Output the pending cue, if any
+	void FlushCue();
+
+	// 0: number, 1: timestamp, 2: content
+	int32 CueState = 0;
+
+	// Cue being read, kept across ParseLines calls
+	FDreamMusicLyric PendingCue;
+	TArray<FStringView, TInlineAllocator<4>> PendingTextLines;
+
+	// Owns PendingTextLines when a cue spans two ParseLines calls
+	TArray<FString, TInlineAllocator<4>> PendingTextStorage;
+
 	// Parse SRT timestamp line (e.g., "00:00:48,710 --> 00:00:58,770")
-	bool ParseSRTTimestamp(const FString& TimestampLine, FDreamMusicLyric& OutLyric);
+	bool ParseSRTTimestamp(FStringView TimestampLine, FDreamMusicLyric& OutLyric);
 
 	// Parse individual SRT time format (HH:MM:SS,mmm)
-	FDreamMusicLyricTimestamp ParseSRTTime(const FString& TimeString);
+	FDreamMusicLyricTimestamp ParseSRTTime(FStringView TimeString);
+
+	// Assign the text lines of one cue to Content/Romanization/Translate by LineType
+	void AssignTextLines(FDreamMusicLyric& Lyric, TConstArrayView<FStringView> TextLines) const;
 
 	// // Clean SRT content from formatting tags
 	// FString CleanSRTContent(const FString& RawContent);
@@ -120,7 +231,7 @@ protected:
 struct DREAMMUSICPLAYER_API FDreamMusicPlayerLyricFileParser_LRC : public FDreamMusicPlayerLyricFileParserBase
 {
 public:
-	FDreamMusicPlayerLyricFileParser_LRC(const FString& InFileContent, const TArray<FString>& InLines, EDreamMusicPlayerLrcLyricType InParseMethod, EDreamMusicPlayerLyricParseLineType InLineType)
+	FDreamMusicPlayerLyricFileParser_LRC(FStringView InFileContent, TConstArrayView<FStringView> InLines, EDreamMusicPlayerLrcLyricType InParseMethod, EDreamMusicPlayerLyricParseLineType InLineType)
 		: FDreamMusicPlayerLyricFileParserBase(InFileContent, InLines, InLineType),
 		  ParseMethod(InParseMethod),
 		  GroupProcessor(InParseMethod, InLineType)
@@ -131,6 +242,12 @@ protected:
 	EDreamMusicPlayerLrcLyricType ParseMethod;
 	FDreamLyricGroupProcessor GroupProcessor;
 
+	// 元数据标签, 键为小写标签名
+	TMap<FString, FString> MetaData;
+
+	// [offset:] 标签的值 (毫秒), 正值使歌词提前
+	int32 OffsetMs = 0;
+
 public:
 	virtual void Parse() override;
 
@@ -139,11 +256,28 @@ public:
 	{
 	}
 
+	/**
+	 * @brief 实际使用的 LRC 类型
+	 * 
+	 * 构造时传入 None 时, 在解析歌词行的同一次扫描中根据逐字标签判断
+	 */
+	EDreamMusicPlayerLrcLyricType GetResolvedParseMethod() const { return ParseMethod; }
+
+	/**
+	 * @brief 取走解析时收集的元数据 ([ti:] [ar:] [al:] [offset:] ...)
+	 */
+	TMap<FString, FString> TakeMetaData() { return MoveTemp(MetaData); }
+
+	int32 GetOffsetMs() const { return OffsetMs; }
+
 protected:
 	// Core functions
-	FDreamMusicLyric CreateLyricFromLine(const FString& Line);
-	FString ExtractTimestampFromLine(const FString& Line);
-	bool IsMetadataLine(const FString& Line) const;
+	/**
+	 * @brief 读取 [tag:value] 形式的元数据行, [offset:] 同时写入 OffsetMs
+	 * 
+	 * @return 是否为元数据行
+	 */
+	bool ReadMetadataLine(FStringView Line);
 	
 	// **NEW METHOD: Fix end timestamps based on word timings**
 	void UpdateEndTimestampsBasedOnWordTimings();
@@ -156,17 +290,64 @@ protected:
 struct DREAMMUSICPLAYER_API FDreamMusicPlayerLyricFileParser_ASS : public FDreamMusicPlayerLyricFileParserBase
 {
 public:
-	FDreamMusicPlayerLyricFileParser_ASS(const FString& InFileContent, const TArray<FString>& InLines, EDreamMusicPlayerLyricParseLineType InLineType)
+	FDreamMusicPlayerLyricFileParser_ASS(FStringView InFileContent, TConstArrayView<FStringView> InLines, EDreamMusicPlayerLyricParseLineType InLineType)
 		: FDreamMusicPlayerLyricFileParserBase(InFileContent, InLines, InLineType)
 	{
 	}
 
 public:
 	virtual void Parse() override;
-	virtual void ProcessText(FDreamMusicLyric& Lyric) override;
+
+	virtual bool SupportsStreaming() const override { return true; }
+	virtual void ParseLines(TConstArrayView<FStringView> InLines) override;
 
 protected:
-	FDreamMusicLyricTimestamp ParseASSTimestamp(const FString& TimestampStr);
-	void ProcessKaraokeTags(FDreamMusicLyric& Lyric);
-	void ProcessRomanizationKaraokeTags(FDreamMusicLyric& Lyric);
+	/**
+	 * [Events] 段 Format: 行描述的字段位置, 未出现 Format: 时使用 ASS v4+ 的默认顺序
+	 * Format: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text
+	 */
+	struct FEventFormat
+	{
+		int32 NumFields = 10;
+		int32 StartIndex = 1;
+		int32 EndIndex = 2;
+		int32 StyleIndex = 3;
+		int32 TextIndex = 9;
+
+		bool IsValid() const;
+
+		// 解析 "Format:" 之后的字段列表, 失败时保持默认值
+		void ParseFormatLine(FStringView FormatLine);
+	};
+
+	/**
+	 * 查找开始时间相同且 Field 尚未填写的歌词行, 没有时新建一行
+	 * 对唱时同一时间有多行 orig, 每行 orig 各自成行, ts / roma 依次填入同一时间中还没有对应内容的行
+	 */
+	FDreamMusicLyric& FindOrAddLyric(FDreamLyricTime StartTime, FDreamLyricTime EndTime, EDreamLyricField Field);
+
+	// 解析状态, 在 ParseLines 调用之间保持
+	bool bIsEvent = false;
+	FEventFormat EventFormat;
+
+	// 同一开始时间的一行歌词, FilledFields 按 EDreamLyricField 记录已填写的 orig / roma / ts
+	struct FLyricSlot
+	{
+		int32 LyricIndex;
+		uint8 FilledFields;
+	};
+
+	// 开始时间 (毫秒) -> 该时间的歌词行, 按源文件顺序
+	TMap<int32, TArray<FLyricSlot, TInlineAllocator<1>>> LyricSlotsByStartTime;
+
+	FDreamMusicLyricTimestamp ParseASSTimestamp(FStringView TimestampStr);
+
+	// Parse karaoke tags of Text into Content / WordTimings
+	void ProcessKaraokeTags(FDreamMusicLyric& Lyric, FStringView Text);
+
+	// Parse karaoke tags of Text into Romanization / RomanizationWordTimings
+	void ProcessRomanizationKaraokeTags(FDreamMusicLyric& Lyric, FStringView Text);
+
+	// 卡拉OK音节缓冲, 在所有 Dialogue 之间复用
+	TArray<FDreamLyricKaraokeSpan> KaraokeSpans;
 };
@@ -8,6 +8,7 @@ struct FDreamMusicPlayerLyricFileParserBase;
 namespace FDreamMusicPlayerLyricTools
 {
 	DREAMMUSICPLAYER_API FDreamMusicLyric GetLyricAtTimestamp(FDreamMusicLyricTimestamp Timestamp, const TArray<FDreamMusicLyric>& Lyrics);
+	DREAMMUSICPLAYER_API int32 GetLyricIndexAtTime(FDreamLyricTime Time, const TArray<FDreamMusicLyric>& Lyrics);
 	DREAMMUSICPLAYER_API FString GetLyricFilePath(FString FileName);
 	DREAMMUSICPLAYER_API TArray<FString> GetLyricFileNames();
 }
\ No newline at end of file
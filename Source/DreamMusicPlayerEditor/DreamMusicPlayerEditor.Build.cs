@@ -19,7 +19,11 @@ public class DreamMusicPlayerEditor : ModuleRules
                 "CoreUObject",
                 "Engine",
                 "Slate",
-                "SlateCore"
+                "SlateCore",
+                "DeveloperSettings",
+                "AssetRegistry",
+                "Json",
+                "DreamMusicPlayer"
             }
         );
     }
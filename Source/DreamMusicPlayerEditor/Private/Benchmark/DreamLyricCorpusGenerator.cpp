@@ -0,0 +1,287 @@
+﻿#include "Benchmark/DreamLyricCorpusGenerator.h"
+
+#include "LyricParser/DreamLyricGroupProcessor.h"
+
+namespace
+{
+	const TCHAR* const LyricWords[] = {
+		TEXT("風"), TEXT("触れる"), TEXT("ホシの"), TEXT("願い"), TEXT("見上げ"), TEXT("地に"), TEXT("縛られて"), TEXT("いる"),
+		TEXT("夜空"), TEXT("遠く"), TEXT("光"), TEXT("君の"), TEXT("声"), TEXT("夢"), TEXT("歌う"), TEXT("星")
+	};
+
+	const TCHAR* const RomanizationWords[] = {
+		TEXT("kaze "), TEXT("fureru "), TEXT("hoshi no "), TEXT("negai "), TEXT("miage "), TEXT("chi ni "), TEXT("shibararete "), TEXT("iru "),
+		TEXT("yozora "), TEXT("tooku "), TEXT("hikari "), TEXT("kimi no "), TEXT("koe "), TEXT("yume "), TEXT("utau "), TEXT("hoshi ")
+	};
+
+	const TCHAR* const TranslationWords[] = {
+		TEXT("wind"), TEXT("touching"), TEXT("the star's"), TEXT("wish"), TEXT("looking up"), TEXT("to the ground"), TEXT("bound"), TEXT("still"),
+		TEXT("night sky"), TEXT("far away"), TEXT("light"), TEXT("your"), TEXT("voice"), TEXT("dream"), TEXT("singing"), TEXT("star")
+	};
+
+	static_assert(UE_ARRAY_COUNT(LyricWords) == UE_ARRAY_COUNT(RomanizationWords) && UE_ARRAY_COUNT(LyricWords) == UE_ARRAY_COUNT(TranslationWords),
+		"Word tables must have the same size");
+
+	constexpr int32 NumDictionaryWords = static_cast<int32>(UE_ARRAY_COUNT(LyricWords));
+
+	// LRC 分钟最多 3 位, 行数较多时压缩行间隔
+	constexpr int32 MaxLrcTimeMs = 999 * 60 * 1000;
+
+	struct FLineTiming
+	{
+		int32 StartMs;
+		int32 EndMs;
+	};
+
+	int32 GetLinePeriodMs(const FDreamLyricCorpusGenerator::FOptions& Options)
+	{
+		return FMath::Clamp(MaxLrcTimeMs / FMath::Max(Options.NumLines, 1), 100, 4000);
+	}
+
+	FLineTiming GetLineTiming(int32 LineIndex, int32 LinePeriodMs)
+	{
+		const int32 StartMs = LineIndex * LinePeriodMs;
+		return {StartMs, StartMs + LinePeriodMs * 7 / 8};
+	}
+
+	int32 GetWordStartMs(const FLineTiming& Timing, int32 WordIndex, int32 NumWords)
+	{
+		return Timing.StartMs + (Timing.EndMs - Timing.StartMs) * WordIndex / FMath::Max(NumWords, 1);
+	}
+
+	const TCHAR* GetWord(EDreamLyricField Field, int32 WordIndex)
+	{
+		switch (Field)
+		{
+		case EDreamLyricField::Romanization: return RomanizationWords[WordIndex];
+		case EDreamLyricField::Translate: return TranslationWords[WordIndex];
+		case EDreamLyricField::Content:
+		default: return LyricWords[WordIndex];
+		}
+	}
+
+	/** 同一行的原文/罗马音/翻译使用相同的词序, 方便对照 */
+	void PickWords(FRandomStream& Random, int32 NumWords, TArray<int32>& OutWords)
+	{
+		OutWords.Reset(NumWords);
+		for (int32 i = 0; i < NumWords; i++)
+		{
+			OutWords.Add(Random.RandHelper(NumDictionaryWords));
+		}
+	}
+
+	void AppendLrcTime(FString& Out, TCHAR OpenTag, TCHAR CloseTag, int32 TimeMs)
+	{
+		Out.Appendf(TEXT("%c%02d:%02d.%02d%c"), OpenTag, TimeMs / 60000, TimeMs / 1000 % 60, TimeMs / 10 % 100, CloseTag);
+	}
+
+	void AppendSrtTime(FString& Out, int32 TimeMs)
+	{
+		Out.Appendf(TEXT("%02d:%02d:%02d,%03d"), TimeMs / 3600000, TimeMs / 60000 % 60, TimeMs / 1000 % 60, TimeMs % 1000);
+	}
+
+	void AppendAssTime(FString& Out, int32 TimeMs)
+	{
+		Out.Appendf(TEXT("%d:%02d:%02d.%02d"), TimeMs / 3600000, TimeMs / 60000 % 60, TimeMs / 1000 % 60, TimeMs / 10 % 100);
+	}
+
+	void AppendPlainText(FString& Out, EDreamLyricField Field, TConstArrayView<int32> Words)
+	{
+		for (int32 i = 0; i < Words.Num(); i++)
+		{
+			if (Field == EDreamLyricField::Translate && i > 0)
+			{
+				Out.AppendChar(TEXT(' '));
+			}
+			Out.Append(GetWord(Field, Words[i]));
+		}
+	}
+
+	FString GetFieldStyle(EDreamLyricField Field)
+	{
+		switch (Field)
+		{
+		case EDreamLyricField::Romanization: return TEXT("roma");
+		case EDreamLyricField::Translate: return TEXT("ts");
+		case EDreamLyricField::Content:
+		default: return TEXT("orig");
+		}
+	}
+}
+
+namespace FDreamLyricCorpusGenerator
+{
+	FString GenerateLRC(EDreamMusicPlayerLrcLyricType LrcType, EDreamMusicPlayerLyricParseLineType LineType, const FOptions& Options)
+	{
+		const FDreamLyricLineLayout& Layout = FDreamLyricLineLayouts::Get(LineType);
+		const int32 LinePeriodMs = GetLinePeriodMs(Options);
+		const int32 NumWords = FMath::Max(Options.WordsPerLine, 1);
+
+		FRandomStream Random(Options.Seed);
+		TArray<int32> Words;
+
+		FString Out;
+		Out.Reserve(Options.NumLines * Layout.NumLines * NumWords * 20);
+		Out += TEXT("[ti:DreamMusicPlayer Benchmark]\n[ar:Synthetic]\n[al:Corpus]\n[by:DreamLyricCorpusGenerator]\n");
+
+		for (int32 LineIndex = 0; LineIndex < Options.NumLines; LineIndex++)
+		{
+			const FLineTiming Timing = GetLineTiming(LineIndex, LinePeriodMs);
+			PickWords(Random, NumWords, Words);
+
+			for (int32 i = 0; i < Layout.NumLines; i++)
+			{
+				const EDreamLyricField Field = Layout.Fields[i];
+				AppendLrcTime(Out, TEXT('['), TEXT(']'), Timing.StartMs);
+
+				// 翻译行没有逐字时间
+				if (LrcType == EDreamMusicPlayerLrcLyricType::WordByWord && Field != EDreamLyricField::Translate)
+				{
+					for (int32 WordIndex = 0; WordIndex < NumWords; WordIndex++)
+					{
+						if (WordIndex > 0)
+						{
+							AppendLrcTime(Out, TEXT('['), TEXT(']'), GetWordStartMs(Timing, WordIndex, NumWords));
+						}
+						Out.Append(GetWord(Field, Words[WordIndex]));
+					}
+					AppendLrcTime(Out, TEXT('['), TEXT(']'), Timing.EndMs);
+				}
+				else if (LrcType == EDreamMusicPlayerLrcLyricType::ESLyric && Field != EDreamLyricField::Translate)
+				{
+					for (int32 WordIndex = 0; WordIndex < NumWords; WordIndex++)
+					{
+						AppendLrcTime(Out, TEXT('<'), TEXT('>'), GetWordStartMs(Timing, WordIndex, NumWords));
+						Out.Append(GetWord(Field, Words[WordIndex]));
+					}
+					AppendLrcTime(Out, TEXT('<'), TEXT('>'), Timing.EndMs);
+				}
+				else
+				{
+					AppendPlainText(Out, Field, Words);
+				}
+
+				Out.AppendChar(TEXT('\n'));
+			}
+		}
+
+		return Out;
+	}
+
+	FString GenerateSRT(EDreamMusicPlayerLyricParseLineType LineType, const FOptions& Options)
+	{
+		const FDreamLyricLineLayout& Layout = FDreamLyricLineLayouts::Get(LineType);
+		const int32 LinePeriodMs = GetLinePeriodMs(Options);
+		const int32 NumWords = FMath::Max(Options.WordsPerLine, 1);
+
+		FRandomStream Random(Options.Seed);
+		TArray<int32> Words;
+
+		FString Out;
+		Out.Reserve(Options.NumLines * (Layout.NumLines * NumWords * 10 + 40));
+
+		for (int32 LineIndex = 0; LineIndex < Options.NumLines; LineIndex++)
+		{
+			const FLineTiming Timing = GetLineTiming(LineIndex, LinePeriodMs);
+			PickWords(Random, NumWords, Words);
+
+			Out.Appendf(TEXT("%d\n"), LineIndex + 1);
+			AppendSrtTime(Out, Timing.StartMs);
+			Out += TEXT(" --> ");
+			AppendSrtTime(Out, Timing.EndMs);
+			Out.AppendChar(TEXT('\n'));
+
+			for (int32 i = 0; i < Layout.NumLines; i++)
+			{
+				AppendPlainText(Out, Layout.Fields[i], Words);
+				Out.AppendChar(TEXT('\n'));
+			}
+
+			Out.AppendChar(TEXT('\n'));
+		}
+
+		return Out;
+	}
+
+	FString GenerateASS(EDreamMusicPlayerLyricParseLineType LineType, const FOptions& Options)
+	{
+		const FDreamLyricLineLayout& Layout = FDreamLyricLineLayouts::Get(LineType);
+		const int32 LinePeriodMs = GetLinePeriodMs(Options);
+		const int32 NumWords = FMath::Max(Options.WordsPerLine, 1);
+
+		FRandomStream Random(Options.Seed);
+		TArray<int32> Words;
+
+		const int32 NumVoices = Options.bDuet ? 2 : 1;
+
+		FString Out;
+		Out.Reserve(Options.NumLines * NumVoices * Layout.NumLines * (NumWords * 20 + 60));
+		Out += TEXT("[Script Info]\nTitle: DreamMusicPlayer Benchmark\nScriptType: v4.00+\n\n");
+		Out += TEXT("[V4+ Styles]\nFormat: Name, Fontname, Fontsize, PrimaryColour\n");
+		Out += TEXT("Style: orig,Arial,48,&H00FFFFFF\nStyle: ts,Arial,32,&H00FFFFFF\nStyle: roma,Arial,32,&H00FFFFFF\n\n");
+		Out += TEXT("[Events]\nFormat: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n");
+
+		for (int32 LineIndex = 0; LineIndex < Options.NumLines; LineIndex++)
+		{
+			const FLineTiming Timing = GetLineTiming(LineIndex, LinePeriodMs);
+
+			// 对唱的两位歌手开始时间相同, 各自的 orig / roma / ts 连续写出
+			for (int32 Voice = 0; Voice < NumVoices; Voice++)
+			{
+				PickWords(Random, NumWords, Words);
+
+				for (int32 i = 0; i < Layout.NumLines; i++)
+				{
+					const EDreamLyricField Field = Layout.Fields[i];
+
+					Out += TEXT("Dialogue: 0,");
+					AppendAssTime(Out, Timing.StartMs);
+					Out.AppendChar(TEXT(','));
+					AppendAssTime(Out, Timing.EndMs);
+					Out.Appendf(TEXT(",%s,,0,0,0,,"), *GetFieldStyle(Field));
+
+					if (Field == EDreamLyricField::Translate)
+					{
+						AppendPlainText(Out, Field, Words);
+					}
+					else
+					{
+						for (int32 WordIndex = 0; WordIndex < NumWords; WordIndex++)
+						{
+							const int32 DurationCs = (GetWordStartMs(Timing, WordIndex + 1, NumWords) - GetWordStartMs(Timing, WordIndex, NumWords)) / 10;
+							Out.Appendf(TEXT("{\\kf%d}"), DurationCs);
+							Out.Append(GetWord(Field, Words[WordIndex]));
+						}
+					}
+
+					Out.AppendChar(TEXT('\n'));
+				}
+			}
+		}
+
+		return Out;
+	}
+
+	FString Generate(EDreamMusicPlayerLyricParseFileType FileType, EDreamMusicPlayerLrcLyricType LrcType,
+	                 EDreamMusicPlayerLyricParseLineType LineType, const FOptions& Options)
+	{
+		switch (FileType)
+		{
+		case EDreamMusicPlayerLyricParseFileType::SRT: return GenerateSRT(LineType, Options);
+		case EDreamMusicPlayerLyricParseFileType::ASS: return GenerateASS(LineType, Options);
+		case EDreamMusicPlayerLyricParseFileType::LRC:
+		default: return GenerateLRC(LrcType, LineType, Options);
+		}
+	}
+
+	const TCHAR* GetFileExtension(EDreamMusicPlayerLyricParseFileType FileType)
+	{
+		switch (FileType)
+		{
+		case EDreamMusicPlayerLyricParseFileType::SRT: return TEXT("srt");
+		case EDreamMusicPlayerLyricParseFileType::ASS: return TEXT("ass");
+		case EDreamMusicPlayerLyricParseFileType::LRC:
+		default: return TEXT("lrc");
+		}
+	}
+}
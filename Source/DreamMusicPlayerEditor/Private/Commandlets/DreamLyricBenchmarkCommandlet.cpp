@@ -0,0 +1,485 @@
+﻿#include "Commandlets/DreamLyricBenchmarkCommandlet.h"
+
+#include "Benchmark/DreamLyricCorpusGenerator.h"
+#include "LyricParser/DreamLyricParser.h"
+#include "LyricParser/DreamLyricTrack.h"
+#include "DreamMusicPlayerSettings.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDreamLyricBenchmark, Log, All);
+
+namespace
+{
+	/** 单个线程在计数作用域内的分配统计 */
+	struct FAllocationCounts
+	{
+		int64 NumAllocs = 0;
+		int64 AllocatedBytes = 0;
+		int64 LiveBytes = 0;
+		int64 PeakLiveBytes = 0;
+
+		// 作用域内分配且尚未释放的内存, 释放作用域之前分配的内存不计入
+		TMap<void*, int64> LiveAllocations;
+	};
+
+	/**
+	 * GMalloc 代理, 只统计开启了计数作用域的线程 (FScopedAllocationCounting)
+	 * 任务线程等其它线程的分配直接转发, 不影响单次解析的统计
+	 */
+	class FDreamCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FDreamCountingMalloc(FMalloc* InInner) : Inner(InInner)
+		{
+		}
+
+		static inline thread_local FAllocationCounts* ThreadCounts = nullptr;
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			void* Ptr = Inner->Malloc(Count, Alignment);
+			OnAlloc(Ptr, Count);
+			return Ptr;
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			void* Ptr = Inner->TryMalloc(Count, Alignment);
+			OnAlloc(Ptr, Count);
+			return Ptr;
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			void* Ptr = Inner->Realloc(Original, Count, Alignment);
+			OnRealloc(Original, Ptr, Count);
+			return Ptr;
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			void* Ptr = Inner->TryRealloc(Original, Count, Alignment);
+			OnRealloc(Original, Ptr, Count);
+			return Ptr;
+		}
+
+		virtual void Free(void* Original) override
+		{
+			OnFree(Original);
+			Inner->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	private:
+		void OnAlloc(void* Ptr, SIZE_T Count)
+		{
+			FAllocationCounts* Counts = ThreadCounts;
+			if (!Counts || !Ptr)
+			{
+				return;
+			}
+
+			// LiveAllocations 自身的分配不计入
+			ThreadCounts = nullptr;
+
+			SIZE_T AllocationSize = 0;
+			const int64 Size = static_cast<int64>(Inner->GetAllocationSize(Ptr, AllocationSize) ? AllocationSize : Count);
+			Counts->NumAllocs++;
+			Counts->AllocatedBytes += Size;
+			Counts->LiveBytes += Size;
+			Counts->PeakLiveBytes = FMath::Max(Counts->PeakLiveBytes, Counts->LiveBytes);
+			Counts->LiveAllocations.Add(Ptr, Size);
+
+			ThreadCounts = Counts;
+		}
+
+		void OnFree(void* Ptr)
+		{
+			FAllocationCounts* Counts = ThreadCounts;
+			if (!Counts || !Ptr)
+			{
+				return;
+			}
+
+			ThreadCounts = nullptr;
+
+			int64 Size = 0;
+			if (Counts->LiveAllocations.RemoveAndCopyValue(Ptr, Size))
+			{
+				Counts->LiveBytes -= Size;
+			}
+
+			ThreadCounts = Counts;
+		}
+
+		void OnRealloc(void* Original, void* Ptr, SIZE_T Count)
+		{
+			// TryRealloc 失败时原内存仍然有效
+			if (Original && (Ptr || Count == 0))
+			{
+				OnFree(Original);
+			}
+			OnAlloc(Ptr, Count);
+		}
+
+		FMalloc* Inner;
+	};
+
+	/**
+	 * 作用域内把 GMalloc 换成计数代理并统计当前线程的分配
+	 * 只包住计数的那一次解析, 计时的解析直接使用原分配器, 不付代理的虚调用与线程局部检查
+	 * 代理是静态对象, 作用域结束后其它线程仍读到旧指针时调用也是安全的
+	 */
+	struct FScopedAllocationCounting
+	{
+		explicit FScopedAllocationCounting(FAllocationCounts& Counts)
+			: PreviousMalloc(GMalloc)
+		{
+			static FDreamCountingMalloc Counter(GMalloc);
+			GMalloc = &Counter;
+			FDreamCountingMalloc::ThreadCounts = &Counts;
+		}
+
+		~FScopedAllocationCounting()
+		{
+			FDreamCountingMalloc::ThreadCounts = nullptr;
+			GMalloc = PreviousMalloc;
+		}
+
+		UE_NONCOPYABLE(FScopedAllocationCounting);
+
+	private:
+		FMalloc* PreviousMalloc;
+	};
+
+	struct FBenchmarkCase
+	{
+		FString Name;
+		EDreamMusicPlayerLyricParseFileType FileType;
+		EDreamMusicPlayerLrcLyricType LrcType;
+		EDreamMusicPlayerLyricParseLineType LineType;
+
+		// ASS 对唱: 同一时间两行 orig, 轨道行数应为 -Lines 的两倍
+		bool bDuet = false;
+	};
+
+	struct FBenchmarkResult
+	{
+		FString Name;
+		int64 FileBytes = 0;
+		int32 NumLines = 0;
+		double MedianMs = 0.0;
+		double BestMs = 0.0;
+		double LinesPerSec = 0.0;
+		double BytesPerSec = 0.0;
+		int64 NumAllocs = 0;
+		int64 AllocatedBytes = 0;
+		int64 PeakHeapBytes = 0;
+		int64 TrackBytes = 0;
+	};
+
+	const TCHAR* CsvHeader = TEXT("Name,FileBytes,Lines,MedianMs,BestMs,LinesPerSec,BytesPerSec,Allocs,AllocBytes,PeakHeapBytes,TrackBytes");
+
+	FString GetLineTypeName(EDreamMusicPlayerLyricParseLineType LineType)
+	{
+		return StaticEnum<EDreamMusicPlayerLyricParseLineType>()->GetNameStringByValue(static_cast<int64>(LineType));
+	}
+
+	FString GetLrcTypeName(EDreamMusicPlayerLrcLyricType LrcType)
+	{
+		return StaticEnum<EDreamMusicPlayerLrcLyricType>()->GetNameStringByValue(static_cast<int64>(LrcType));
+	}
+
+	TArray<FString> ParseList(const FString& Value)
+	{
+		TArray<FString> Items;
+		Value.ParseIntoArray(Items, TEXT(","));
+		for (FString& Item : Items)
+		{
+			Item.TrimStartAndEndInline();
+		}
+		return Items;
+	}
+
+	TArray<FBenchmarkCase> BuildCases(const TArray<FString>& Formats, const TArray<FString>& LineTypeFilter)
+	{
+		const bool bAllLineTypes = LineTypeFilter.IsEmpty() || LineTypeFilter.Contains(TEXT("All"));
+
+		TArray<EDreamMusicPlayerLyricParseLineType> LineTypes;
+		for (int32 Value = 0; Value <= static_cast<int32>(EDreamMusicPlayerLyricParseLineType::Lyric_Only); Value++)
+		{
+			const EDreamMusicPlayerLyricParseLineType LineType = static_cast<EDreamMusicPlayerLyricParseLineType>(Value);
+			if (bAllLineTypes || LineTypeFilter.Contains(GetLineTypeName(LineType)))
+			{
+				LineTypes.Add(LineType);
+			}
+		}
+
+		TArray<FBenchmarkCase> Cases;
+		for (const EDreamMusicPlayerLyricParseLineType LineType : LineTypes)
+		{
+			if (Formats.Contains(TEXT("LRC")))
+			{
+				for (const EDreamMusicPlayerLrcLyricType LrcType : {EDreamMusicPlayerLrcLyricType::LineByLine, EDreamMusicPlayerLrcLyricType::WordByWord, EDreamMusicPlayerLrcLyricType::ESLyric})
+				{
+					Cases.Add({FString::Printf(TEXT("LRC_%s_%s"), *GetLrcTypeName(LrcType), *GetLineTypeName(LineType)), EDreamMusicPlayerLyricParseFileType::LRC, LrcType, LineType});
+				}
+			}
+
+			if (Formats.Contains(TEXT("SRT")))
+			{
+				Cases.Add({FString::Printf(TEXT("SRT_%s"), *GetLineTypeName(LineType)), EDreamMusicPlayerLyricParseFileType::SRT, EDreamMusicPlayerLrcLyricType::None, LineType});
+			}
+
+			if (Formats.Contains(TEXT("ASS")))
+			{
+				Cases.Add({FString::Printf(TEXT("ASS_%s"), *GetLineTypeName(LineType)), EDreamMusicPlayerLyricParseFileType::ASS, EDreamMusicPlayerLrcLyricType::None, LineType});
+				Cases.Add({FString::Printf(TEXT("ASS_Duet_%s"), *GetLineTypeName(LineType)), EDreamMusicPlayerLyricParseFileType::ASS, EDreamMusicPlayerLrcLyricType::None, LineType, true});
+			}
+		}
+
+		return Cases;
+	}
+
+	FBenchmarkResult RunCase(const FBenchmarkCase& Case, const FString& FilePath, int32 Iterations)
+	{
+		FBenchmarkResult Result;
+		Result.Name = Case.Name;
+		Result.FileBytes = IFileManager::Get().FileSize(*FilePath);
+
+		// 预热一次, 让文件进入系统缓存
+		{
+			FDreamLyricParser WarmUp(FilePath, Case.FileType, Case.LineType, Case.LrcType);
+			Result.NumLines = WarmUp.GetLyricCount();
+		}
+
+		TArray<double> Times;
+		Times.Reserve(Iterations);
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			{
+				FDreamLyricParser Parser(FilePath, Case.FileType, Case.LineType, Case.LrcType);
+			}
+			Times.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+		}
+
+		Times.Sort();
+		Result.BestMs = Times[0];
+		Result.MedianMs = Times[Times.Num() / 2];
+
+		const double MedianSeconds = FMath::Max(Result.MedianMs / 1000.0, UE_DOUBLE_SMALL_NUMBER);
+		Result.LinesPerSec = Result.NumLines / MedianSeconds;
+		Result.BytesPerSec = Result.FileBytes / MedianSeconds;
+
+		// 单独测量一次分配, 计数的开销不计入上面的耗时. 解析在当前线程完成, 只统计当前线程
+		{
+			TUniquePtr<FDreamLyricParser> Parser;
+			FAllocationCounts Counts;
+			{
+				FScopedAllocationCounting ScopedCounting(Counts);
+				Parser = MakeUnique<FDreamLyricParser>(FilePath, Case.FileType, Case.LineType, Case.LrcType);
+			}
+
+			Result.NumAllocs = Counts.NumAllocs;
+			Result.AllocatedBytes = Counts.AllocatedBytes;
+			Result.PeakHeapBytes = Counts.PeakLiveBytes;
+
+			if (const TSharedPtr<const FDreamLyricTrack> Track = Parser->GetTrack())
+			{
+				Result.TrackBytes = static_cast<int64>(Track->GetAllocatedSize());
+			}
+		}
+
+		return Result;
+	}
+
+	FString ToCsvRow(const FBenchmarkResult& Result)
+	{
+		return FString::Printf(TEXT("%s,%lld,%d,%.3f,%.3f,%.0f,%.0f,%lld,%lld,%lld,%lld"),
+		                       *Result.Name, Result.FileBytes, Result.NumLines, Result.MedianMs, Result.BestMs, Result.LinesPerSec, Result.BytesPerSec,
+		                       Result.NumAllocs, Result.AllocatedBytes, Result.PeakHeapBytes, Result.TrackBytes);
+	}
+
+	/** 读取 -Csv 写出的基线, Name -> LinesPerSec */
+	bool LoadBaseline(const FString& Path, TMap<FString, double>& OutLinesPerSec)
+	{
+		TArray<FString> Rows;
+		if (!FFileHelper::LoadFileToStringArray(Rows, *Path) || Rows.IsEmpty())
+		{
+			return false;
+		}
+
+		TArray<FString> Columns;
+		Rows[0].ParseIntoArray(Columns, TEXT(","));
+		const int32 NameColumn = Columns.IndexOfByKey(TEXT("Name"));
+		const int32 LinesPerSecColumn = Columns.IndexOfByKey(TEXT("LinesPerSec"));
+		if (NameColumn == INDEX_NONE || LinesPerSecColumn == INDEX_NONE)
+		{
+			return false;
+		}
+
+		for (int32 RowIndex = 1; RowIndex < Rows.Num(); RowIndex++)
+		{
+			Rows[RowIndex].ParseIntoArray(Columns, TEXT(","));
+			if (Columns.IsValidIndex(NameColumn) && Columns.IsValidIndex(LinesPerSecColumn))
+			{
+				OutLinesPerSec.Add(Columns[NameColumn], FCString::Atod(*Columns[LinesPerSecColumn]));
+			}
+		}
+
+		return true;
+	}
+}
+
+UDreamLyricBenchmarkCommandlet::UDreamLyricBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UDreamLyricBenchmarkCommandlet::Main(const FString& Params)
+{
+	FDreamLyricCorpusGenerator::FOptions Options;
+	FParse::Value(*Params, TEXT("Lines="), Options.NumLines);
+	FParse::Value(*Params, TEXT("Words="), Options.WordsPerLine);
+	Options.NumLines = FMath::Max(Options.NumLines, 1);
+	Options.WordsPerLine = FMath::Max(Options.WordsPerLine, 1);
+
+	int32 Iterations = 5;
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	Iterations = FMath::Max(Iterations, 1);
+
+	FString FormatsParam = TEXT("LRC,SRT,ASS");
+	FParse::Value(*Params, TEXT("Formats="), FormatsParam, false);
+
+	FString LineTypesParam = TEXT("All");
+	FParse::Value(*Params, TEXT("LineTypes="), LineTypesParam, false);
+
+	FString CsvPath;
+	FParse::Value(*Params, TEXT("Csv="), CsvPath);
+
+	FString BaselinePath;
+	FParse::Value(*Params, TEXT("Baseline="), BaselinePath);
+
+	double Tolerance = 0.15;
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+
+	const TArray<FBenchmarkCase> Cases = BuildCases(ParseList(FormatsParam.ToUpper()), ParseList(LineTypesParam));
+	if (Cases.IsEmpty())
+	{
+		UE_LOG(LogDreamLyricBenchmark, Error, TEXT("No benchmark case matches -Formats=%s -LineTypes=%s"), *FormatsParam, *LineTypesParam);
+		return 1;
+	}
+
+	// 基准测试的是解析本身, 关闭二进制缓存
+	UDreamMusicPlayerSettings* Settings = GetMutableDefault<UDreamMusicPlayerSettings>();
+	const bool bPreviousEnableLyricCache = Settings->bEnableLyricCache;
+	Settings->bEnableLyricCache = false;
+	ON_SCOPE_EXIT
+	{
+		Settings->bEnableLyricCache = bPreviousEnableLyricCache;
+	};
+
+	const FString CorpusDir = FPaths::ProjectSavedDir() / TEXT("DreamMusicPlayer") / TEXT("Benchmark");
+	IFileManager::Get().MakeDirectory(*CorpusDir, true);
+
+	UE_LOG(LogDreamLyricBenchmark, Display, TEXT("Lyric benchmark: %d cases, %d lines x %d words, %d iterations, corpus: %s"),
+	       Cases.Num(), Options.NumLines, Options.WordsPerLine, Iterations, *CorpusDir);
+
+	TArray<FBenchmarkResult> Results;
+	Results.Reserve(Cases.Num());
+
+	int32 NumFailed = 0;
+	for (const FBenchmarkCase& Case : Cases)
+	{
+		const FString FilePath = CorpusDir / FString::Printf(TEXT("%s.%s"), *Case.Name, FDreamLyricCorpusGenerator::GetFileExtension(Case.FileType));
+		FDreamLyricCorpusGenerator::FOptions CaseOptions = Options;
+		CaseOptions.bDuet = Case.bDuet;
+		const FString Content = FDreamLyricCorpusGenerator::Generate(Case.FileType, Case.LrcType, Case.LineType, CaseOptions);
+		if (!FFileHelper::SaveStringToFile(Content, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+		{
+			UE_LOG(LogDreamLyricBenchmark, Error, TEXT("Failed to write corpus file %s"), *FilePath);
+			NumFailed++;
+			continue;
+		}
+
+		const FBenchmarkResult& Result = Results.Add_GetRef(RunCase(Case, FilePath, Iterations));
+		if (Result.NumLines == 0)
+		{
+			UE_LOG(LogDreamLyricBenchmark, Error, TEXT("%s: no lyrics parsed"), *Case.Name);
+			NumFailed++;
+		}
+		else if (Case.bDuet && Result.NumLines != Options.NumLines * 2)
+		{
+			UE_LOG(LogDreamLyricBenchmark, Error, TEXT("%s: %d lines parsed, expected %d (duet lines merged)"), *Case.Name, Result.NumLines, Options.NumLines * 2);
+			NumFailed++;
+		}
+
+		UE_LOG(LogDreamLyricBenchmark, Display, TEXT("%-52s %6d lines %8.2f ms %10.0f lines/s %7.2f MB/s %8lld allocs %8.1f KB peak %8.1f KB track"),
+		       *Result.Name, Result.NumLines, Result.MedianMs, Result.LinesPerSec, Result.BytesPerSec / (1024.0 * 1024.0),
+		       Result.NumAllocs, Result.PeakHeapBytes / 1024.0, Result.TrackBytes / 1024.0);
+	}
+
+	UE_LOG(LogDreamLyricBenchmark, Display, TEXT("Process peak used physical memory: %.1f MB"),
+	       FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0));
+
+	if (!CsvPath.IsEmpty())
+	{
+		TArray<FString> Rows;
+		Rows.Add(CsvHeader);
+		for (const FBenchmarkResult& Result : Results)
+		{
+			Rows.Add(ToCsvRow(Result));
+		}
+
+		if (FFileHelper::SaveStringArrayToFile(Rows, *CsvPath))
+		{
+			UE_LOG(LogDreamLyricBenchmark, Display, TEXT("Results written to %s"), *CsvPath);
+		}
+		else
+		{
+			UE_LOG(LogDreamLyricBenchmark, Error, TEXT("Failed to write %s"), *CsvPath);
+			NumFailed++;
+		}
+	}
+
+	if (!BaselinePath.IsEmpty())
+	{
+		TMap<FString, double> BaselineLinesPerSec;
+		if (!LoadBaseline(BaselinePath, BaselineLinesPerSec))
+		{
+			UE_LOG(LogDreamLyricBenchmark, Error, TEXT("Failed to read baseline %s"), *BaselinePath);
+			return 1;
+		}
+
+		for (const FBenchmarkResult& Result : Results)
+		{
+			const double* Baseline = BaselineLinesPerSec.Find(Result.Name);
+			if (Baseline && Result.LinesPerSec < *Baseline * (1.0 - Tolerance))
+			{
+				UE_LOG(LogDreamLyricBenchmark, Error, TEXT("%s regressed: %.0f lines/s, baseline %.0f lines/s"), *Result.Name, Result.LinesPerSec, *Baseline);
+				NumFailed++;
+			}
+		}
+	}
+
+	return NumFailed > 0 ? 1 : 0;
+}
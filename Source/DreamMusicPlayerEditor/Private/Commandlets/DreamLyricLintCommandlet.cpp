@@ -0,0 +1,414 @@
+﻿#include "Commandlets/DreamLyricLintCommandlet.h"
+
+#include "Classes/DreamMusicData.h"
+#include "ExpansionData/DreamMusicPlayerExpansionData_Lyric.h"
+#include "LyricParser/DreamLyricBatchParser.h"
+#include "LyricParser/DreamLyricTrack.h"
+#include "LyricParser/DreamMusicPlayerLyricTools.h"
+#include "DreamMusicPlayerSettings.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDreamLyricLint, Log, All);
+
+namespace
+{
+	enum class ELintIssueType : uint8
+	{
+		Parse,
+		Validation,
+		Ordering,
+		Overlap,
+		EmptyLine,
+		Num
+	};
+
+	const TCHAR* const IssueTypeNames[] = {TEXT("Parse"), TEXT("Validation"), TEXT("Ordering"), TEXT("Overlap"), TEXT("EmptyLine")};
+	static_assert(UE_ARRAY_COUNT(IssueTypeNames) == static_cast<int32>(ELintIssueType::Num), "IssueTypeNames must match ELintIssueType");
+
+	bool IsError(ELintIssueType Type)
+	{
+		return Type == ELintIssueType::Parse || Type == ELintIssueType::Validation || Type == ELintIssueType::Ordering;
+	}
+
+	struct FLintIssue
+	{
+		ELintIssueType Type;
+		int32 LineIndex;
+		int32 TimeMs;
+		FString Message;
+	};
+
+	struct FLintFile
+	{
+		FDreamLyricBatchRequest Request;
+		TArray<FString> Assets;
+
+		int32 IssueCounts[static_cast<int32>(ELintIssueType::Num)] = {};
+		TArray<FLintIssue> Issues;
+
+		int32 NumErrors() const
+		{
+			int32 Count = 0;
+			for (int32 TypeIndex = 0; TypeIndex < static_cast<int32>(ELintIssueType::Num); TypeIndex++)
+			{
+				Count += IsError(static_cast<ELintIssueType>(TypeIndex)) ? IssueCounts[TypeIndex] : 0;
+			}
+			return Count;
+		}
+
+		int32 NumWarnings() const
+		{
+			int32 Count = 0;
+			for (int32 TypeIndex = 0; TypeIndex < static_cast<int32>(ELintIssueType::Num); TypeIndex++)
+			{
+				Count += IsError(static_cast<ELintIssueType>(TypeIndex)) ? 0 : IssueCounts[TypeIndex];
+			}
+			return Count;
+		}
+	};
+
+	struct FLintContext
+	{
+		FLintFile& File;
+		int32 MaxIssues;
+
+		void Add(ELintIssueType Type, int32 LineIndex, FDreamLyricTime Time, FString&& Message) const
+		{
+			File.IssueCounts[static_cast<int32>(Type)]++;
+			if (File.Issues.Num() < MaxIssues)
+			{
+				File.Issues.Add({Type, LineIndex, Time.Milliseconds, MoveTemp(Message)});
+			}
+		}
+	};
+
+	EDreamMusicPlayerLyricParseFileType GetFileTypeFromExtension(const FString& FilePath)
+	{
+		const FString Extension = FPaths::GetExtension(FilePath).ToLower();
+		if (Extension == TEXT("srt"))
+		{
+			return EDreamMusicPlayerLyricParseFileType::SRT;
+		}
+		if (Extension == TEXT("ass") || Extension == TEXT("ssa"))
+		{
+			return EDreamMusicPlayerLyricParseFileType::ASS;
+		}
+		return EDreamMusicPlayerLyricParseFileType::LRC;
+	}
+
+	void LintWords(const FLintContext& Context, const FDreamLyricTrack& Track, EDreamLyricWordChannel Channel, int32 LineIndex)
+	{
+		const TConstArrayView<FDreamLyricTime> WordStartTimes = Track.GetLineWordStartTimes(Channel, LineIndex);
+		const TConstArrayView<FDreamLyricTime> WordEndTimes = Track.GetLineWordEndTimes(Channel, LineIndex);
+		const TCHAR* ChannelName = Channel == EDreamLyricWordChannel::Lyric ? TEXT("lyric") : TEXT("romanization");
+
+		for (int32 WordIndex = 0; WordIndex < WordStartTimes.Num(); WordIndex++)
+		{
+			if (WordEndTimes[WordIndex] < WordStartTimes[WordIndex])
+			{
+				Context.Add(ELintIssueType::Ordering, LineIndex, WordStartTimes[WordIndex],
+				            FString::Printf(TEXT("%s word %d ends %d ms before it starts"), ChannelName, WordIndex, WordStartTimes[WordIndex] - WordEndTimes[WordIndex]));
+			}
+
+			if (WordIndex > 0 && WordStartTimes[WordIndex] < WordStartTimes[WordIndex - 1])
+			{
+				Context.Add(ELintIssueType::Ordering, LineIndex, WordStartTimes[WordIndex],
+				            FString::Printf(TEXT("%s word %d starts %d ms before the previous word"), ChannelName, WordIndex, WordStartTimes[WordIndex - 1] - WordStartTimes[WordIndex]));
+			}
+		}
+	}
+
+	void LintTrack(const FLintContext& Context, const FDreamLyricTrack& Track)
+	{
+		const TConstArrayView<FDreamLyricTime> StartTimes = Track.GetLineStartTimes();
+		const TConstArrayView<FDreamLyricTime> EndTimes = Track.GetLineEndTimes();
+
+		for (int32 LineIndex = 0; LineIndex < Track.NumLines(); LineIndex++)
+		{
+			const FDreamLyricTime Start = StartTimes[LineIndex];
+			const FDreamLyricTime End = EndTimes[LineIndex];
+			const bool bHasEnd = End.Milliseconds > 0;
+
+			if (bHasEnd && End < Start)
+			{
+				Context.Add(ELintIssueType::Ordering, LineIndex, Start, FString::Printf(TEXT("line ends %d ms before it starts"), Start - End));
+			}
+
+			if (LineIndex + 1 < Track.NumLines())
+			{
+				// 轨道已按开始时间排序, 源文件中的乱序由解析器报告
+				const FDreamLyricTime NextStart = StartTimes[LineIndex + 1];
+				if (bHasEnd && NextStart < End)
+				{
+					Context.Add(ELintIssueType::Overlap, LineIndex, Start, FString::Printf(TEXT("line overlaps the next line by %d ms"), End - NextStart));
+				}
+			}
+
+			if (!Track.IsEmptyLine(LineIndex) && Track.GetLineContent(LineIndex).TrimStartAndEnd().IsEmpty()
+				&& Track.GetLineRomanization(LineIndex).TrimStartAndEnd().IsEmpty() && Track.GetLineTranslate(LineIndex).TrimStartAndEnd().IsEmpty())
+			{
+				Context.Add(ELintIssueType::EmptyLine, LineIndex, Start, TEXT("line has no text"));
+			}
+
+			LintWords(Context, Track, EDreamLyricWordChannel::Lyric, LineIndex);
+			LintWords(Context, Track, EDreamLyricWordChannel::Romanization, LineIndex);
+		}
+	}
+
+	/** 收集所有 UDreamMusicData 引用的歌词文件, 同一文件同一设置只解析一次 */
+	void CollectAssetFiles(TArray<FLintFile>& OutFiles, int32& OutNumAssets)
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.SearchAllAssets(true);
+
+		TArray<FAssetData> Assets;
+		AssetRegistry.GetAssetsByClass(UDreamMusicData::StaticClass()->GetClassPathName(), Assets, true);
+
+		for (const FAssetData& Asset : Assets)
+		{
+			const UDreamMusicData* MusicData = Cast<UDreamMusicData>(Asset.GetAsset());
+			const UDreamMusicPlayerExpansionData_Lyric* LyricData = MusicData ? MusicData->Data.GetExpansionData<UDreamMusicPlayerExpansionData_Lyric>() : nullptr;
+			if (!LyricData || LyricData->LyricFileName.IsEmpty())
+			{
+				continue;
+			}
+
+			OutNumAssets++;
+
+			const FDreamLyricBatchRequest Request(FPaths::ConvertRelativePathToFull(FDreamMusicPlayerLyricTools::GetLyricFilePath(LyricData->LyricFileName)),
+			                                      LyricData->LyricParseFileType, LyricData->LyricParseLineType, LyricData->LrcLyricType);
+
+			FLintFile* Existing = OutFiles.FindByPredicate([&Request](const FLintFile& File)
+			{
+				return File.Request.FilePath == Request.FilePath && File.Request.FileType == Request.FileType
+					&& File.Request.LineType == Request.LineType && File.Request.LrcLyricType == Request.LrcLyricType;
+			});
+
+			FLintFile& File = Existing ? *Existing : OutFiles.AddDefaulted_GetRef();
+			File.Request = Request;
+			File.Assets.Add(Asset.GetObjectPathString());
+		}
+	}
+
+	/** LyricContentPath 下未被任何资产引用的歌词文件, 使用扩展数据的默认设置 */
+	void CollectUnreferencedFiles(TArray<FLintFile>& InOutFiles)
+	{
+		FString LyricDir;
+		FPackageName::TryConvertGameRelativePackagePathToLocalPath(GetDefault<UDreamMusicPlayerSettings>()->LyricContentPath.Path, LyricDir);
+		LyricDir = FPaths::ConvertRelativePathToFull(LyricDir);
+
+		TArray<FString> FilePaths;
+		for (const TCHAR* Pattern : {TEXT("*.lrc"), TEXT("*.srt"), TEXT("*.ass"), TEXT("*.ssa")})
+		{
+			IFileManager::Get().FindFilesRecursive(FilePaths, *LyricDir, Pattern, true, false, false);
+		}
+
+		TSet<FString> ReferencedPaths;
+		for (const FLintFile& File : InOutFiles)
+		{
+			ReferencedPaths.Add(File.Request.FilePath);
+		}
+
+		const UDreamMusicPlayerExpansionData_Lyric* Defaults = GetDefault<UDreamMusicPlayerExpansionData_Lyric>();
+		for (const FString& FilePath : FilePaths)
+		{
+			const FString FullPath = FPaths::ConvertRelativePathToFull(FilePath);
+			if (!ReferencedPaths.Contains(FullPath))
+			{
+				FLintFile& File = InOutFiles.AddDefaulted_GetRef();
+				File.Request = FDreamLyricBatchRequest(FullPath, GetFileTypeFromExtension(FullPath), Defaults->LyricParseLineType, EDreamMusicPlayerLrcLyricType::None);
+			}
+		}
+	}
+
+	template <typename EnumType>
+	FString GetEnumName(EnumType Value)
+	{
+		return StaticEnum<EnumType>()->GetNameStringByValue(static_cast<int64>(Value));
+	}
+
+	void WriteReport(const FString& ReportPath, const TArray<FLintFile>& Files, const TArray<FDreamLyricBatchResult>& Results,
+	                 const FDreamLyricBatchStats& Stats, int32 NumAssets, int32 NumErrors, int32 NumWarnings)
+	{
+		FString Json;
+		const TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Json);
+
+		Writer->WriteObjectStart();
+
+		Writer->WriteObjectStart(TEXT("Summary"));
+		Writer->WriteValue(TEXT("NumFiles"), Files.Num());
+		Writer->WriteValue(TEXT("NumAssets"), NumAssets);
+		Writer->WriteValue(TEXT("NumLines"), Stats.NumLines);
+		Writer->WriteValue(TEXT("NumErrors"), NumErrors);
+		Writer->WriteValue(TEXT("NumWarnings"), NumWarnings);
+		Writer->WriteValue(TEXT("WallTimeMs"), Stats.WallTimeMs);
+		Writer->WriteValue(TEXT("TotalParseTimeMs"), Stats.TotalParseTimeMs);
+		Writer->WriteValue(TEXT("SlowestFile"), Stats.SlowestFile);
+		Writer->WriteObjectEnd();
+
+		Writer->WriteArrayStart(TEXT("Files"));
+		for (int32 FileIndex = 0; FileIndex < Files.Num(); FileIndex++)
+		{
+			const FLintFile& File = Files[FileIndex];
+			const FDreamLyricBatchResult& Result = Results[FileIndex];
+
+			Writer->WriteObjectStart();
+			Writer->WriteValue(TEXT("File"), File.Request.FilePath);
+			Writer->WriteValue(TEXT("Assets"), File.Assets);
+			Writer->WriteValue(TEXT("FileType"), GetEnumName(File.Request.FileType));
+			Writer->WriteValue(TEXT("LineType"), GetEnumName(File.Request.LineType));
+			Writer->WriteValue(TEXT("LrcLyricType"), GetEnumName(File.Request.LrcLyricType));
+			Writer->WriteValue(TEXT("Success"), Result.bSuccess);
+			Writer->WriteValue(TEXT("Lines"), Result.LineCount);
+			Writer->WriteValue(TEXT("Duration"), Result.Duration);
+			Writer->WriteValue(TEXT("ParseTimeMs"), Result.ParseTimeMs);
+			Writer->WriteValue(TEXT("NumErrors"), File.NumErrors());
+			Writer->WriteValue(TEXT("NumWarnings"), File.NumWarnings());
+
+			Writer->WriteObjectStart(TEXT("IssueCounts"));
+			for (int32 TypeIndex = 0; TypeIndex < static_cast<int32>(ELintIssueType::Num); TypeIndex++)
+			{
+				Writer->WriteValue(IssueTypeNames[TypeIndex], File.IssueCounts[TypeIndex]);
+			}
+			Writer->WriteObjectEnd();
+
+			Writer->WriteArrayStart(TEXT("Issues"));
+			for (const FLintIssue& Issue : File.Issues)
+			{
+				Writer->WriteObjectStart();
+				Writer->WriteValue(TEXT("Type"), IssueTypeNames[static_cast<int32>(Issue.Type)]);
+				Writer->WriteValue(TEXT("Severity"), IsError(Issue.Type) ? TEXT("Error") : TEXT("Warning"));
+				Writer->WriteValue(TEXT("Line"), Issue.LineIndex);
+				Writer->WriteValue(TEXT("TimeMs"), Issue.TimeMs);
+				Writer->WriteValue(TEXT("Message"), Issue.Message);
+				Writer->WriteObjectEnd();
+			}
+			Writer->WriteArrayEnd();
+
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteArrayEnd();
+
+		Writer->WriteObjectEnd();
+		Writer->Close();
+
+		if (FFileHelper::SaveStringToFile(Json, *ReportPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+		{
+			UE_LOG(LogDreamLyricLint, Display, TEXT("Report written to %s"), *ReportPath);
+		}
+		else
+		{
+			UE_LOG(LogDreamLyricLint, Error, TEXT("Failed to write report %s"), *ReportPath);
+		}
+	}
+}
+
+UDreamLyricLintCommandlet::UDreamLyricLintCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UDreamLyricLintCommandlet::Main(const FString& Params)
+{
+	FString ReportPath = FPaths::ProjectSavedDir() / TEXT("DreamMusicPlayer") / TEXT("LyricLint.json");
+	FParse::Value(*Params, TEXT("Report="), ReportPath);
+
+	int32 MaxIssuesPerFile = 100;
+	FParse::Value(*Params, TEXT("MaxIssuesPerFile="), MaxIssuesPerFile);
+
+	const bool bUseCache = FParse::Param(*Params, TEXT("UseCache"));
+	const bool bWarningsAsErrors = FParse::Param(*Params, TEXT("WarningsAsErrors"));
+
+	// 默认直接解析源文件, 不信任可能过期的缓存
+	UDreamMusicPlayerSettings* Settings = GetMutableDefault<UDreamMusicPlayerSettings>();
+	const bool bPreviousEnableLyricCache = Settings->bEnableLyricCache;
+	Settings->bEnableLyricCache = bUseCache && bPreviousEnableLyricCache;
+	ON_SCOPE_EXIT
+	{
+		Settings->bEnableLyricCache = bPreviousEnableLyricCache;
+	};
+
+	TArray<FLintFile> Files;
+	int32 NumAssets = 0;
+	CollectAssetFiles(Files, NumAssets);
+	CollectUnreferencedFiles(Files);
+
+	UE_LOG(LogDreamLyricLint, Display, TEXT("Linting %d lyric files (%d music data assets)"), Files.Num(), NumAssets);
+
+	TArray<FDreamLyricBatchRequest> Requests;
+	Requests.Reserve(Files.Num());
+	for (const FLintFile& File : Files)
+	{
+		Requests.Add(File.Request);
+	}
+
+	TArray<FDreamLyricBatchResult> Results;
+	FDreamLyricBatchStats Stats;
+	FDreamLyricBatchParser::Parse(Requests, Results, Stats, true);
+
+	// 轨道只读, 每个文件的检查互不影响
+	ParallelFor(Files.Num(), [&Files, &Results, MaxIssuesPerFile](int32 FileIndex)
+	{
+		const FDreamLyricBatchResult& Result = Results[FileIndex];
+		const FLintContext Context{Files[FileIndex], MaxIssuesPerFile};
+
+		if (!Result.bSuccess)
+		{
+			Context.Add(ELintIssueType::Parse, INDEX_NONE, FDreamLyricTime(), TEXT("no lyrics parsed"));
+		}
+
+		for (const FString& Error : Result.ValidationErrors)
+		{
+			Context.Add(ELintIssueType::Validation, INDEX_NONE, FDreamLyricTime(), CopyTemp(Error));
+		}
+
+		// 行号为轨道中的序号, 源文件乱序只有源文件中的序号, 因此写在消息里
+		if (Result.NumUnsortedLines > 0)
+		{
+			Context.Add(ELintIssueType::Ordering, INDEX_NONE, FDreamLyricTime(Result.FirstUnsortedTimeMs),
+			            FString::Printf(TEXT("%d lines start before the previous line in the source file, first is lyric line %d in file order"),
+			                            Result.NumUnsortedLines, Result.FirstUnsortedLine));
+		}
+
+		if (Result.Track.IsValid())
+		{
+			LintTrack(Context, *Result.Track);
+		}
+	});
+
+	int32 NumErrors = 0;
+	int32 NumWarnings = 0;
+	for (const FLintFile& File : Files)
+	{
+		NumErrors += File.NumErrors();
+		NumWarnings += File.NumWarnings();
+
+		if (File.NumErrors() > 0)
+		{
+			UE_LOG(LogDreamLyricLint, Error, TEXT("%s: %d errors, %d warnings"), *File.Request.FilePath, File.NumErrors(), File.NumWarnings());
+		}
+		else if (File.NumWarnings() > 0)
+		{
+			UE_LOG(LogDreamLyricLint, Warning, TEXT("%s: %d warnings"), *File.Request.FilePath, File.NumWarnings());
+		}
+	}
+
+	WriteReport(ReportPath, Files, Results, Stats, NumAssets, NumErrors, NumWarnings);
+
+	UE_LOG(LogDreamLyricLint, Display, TEXT("Lyric lint: %d files, %d errors, %d warnings, wall %.2f ms, total parse %.2f ms"),
+	       Files.Num(), NumErrors, NumWarnings, Stats.WallTimeMs, Stats.TotalParseTimeMs);
+
+	return NumErrors > 0 || (bWarningsAsErrors && NumWarnings > 0) ? 1 : 0;
+}
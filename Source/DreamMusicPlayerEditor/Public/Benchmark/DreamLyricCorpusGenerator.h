@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "DreamMusicPlayerCommon.h"
+
+/**
+ * @brief Synthetic lyric files for parser benchmarks
+ *
+ * Output is deterministic for a given seed. Every group / cue / dialogue follows the line order of the requested
+ * EDreamMusicPlayerLyricParseLineType, lyric and romanization lines carry word timings where the format allows it.
+ */
+namespace FDreamLyricCorpusGenerator
+{
+	struct FOptions
+	{
+		// 歌词行数 (LRC 组数 / SRT 字幕块数 / ASS 时间点数)
+		int32 NumLines = 2000;
+
+		// 每行的字数
+		int32 WordsPerLine = 8;
+
+		int32 Seed = 0x444D50;
+
+		// ASS: 每个时间点两位歌手各有一组 orig / roma / ts (对唱), 解析结果应为 NumLines * 2 行
+		bool bDuet = false;
+	};
+
+	/**
+	 * @brief Generate a LRC file, LrcType None is treated as LineByLine
+	 */
+	DREAMMUSICPLAYEREDITOR_API FString GenerateLRC(EDreamMusicPlayerLrcLyricType LrcType, EDreamMusicPlayerLyricParseLineType LineType, const FOptions& Options);
+
+	DREAMMUSICPLAYEREDITOR_API FString GenerateSRT(EDreamMusicPlayerLyricParseLineType LineType, const FOptions& Options);
+
+	/**
+	 * @brief Generate an ASS file with {\kf} karaoke tags on orig and roma dialogues
+	 *
+	 * With Options.bDuet every start time has two voices, each one a full orig / roma / ts set in line type order
+	 */
+	DREAMMUSICPLAYEREDITOR_API FString GenerateASS(EDreamMusicPlayerLyricParseLineType LineType, const FOptions& Options);
+
+	DREAMMUSICPLAYEREDITOR_API FString Generate(EDreamMusicPlayerLyricParseFileType FileType, EDreamMusicPlayerLrcLyricType LrcType,
+	                                            EDreamMusicPlayerLyricParseLineType LineType, const FOptions& Options);
+
+	/**
+	 * @brief File extension of a lyric file type, without the dot
+	 */
+	DREAMMUSICPLAYEREDITOR_API const TCHAR* GetFileExtension(EDreamMusicPlayerLyricParseFileType FileType);
+}
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DreamLyricBenchmarkCommandlet.generated.h"
+
+/**
+ * @brief Lyric parser throughput benchmark
+ *
+ * Generates synthetic LRC (LineByLine / WordByWord / ESLyric), SRT, ASS karaoke and ASS duet files for every line type,
+ * parses each one through FDreamLyricParser with the binary cache disabled and reports lines/sec, bytes/sec,
+ * peak heap usage and heap allocation count. Allocations are counted on the parsing thread only, within one parse.
+ * A duet file has two orig dialogues per start time, the case fails unless both come out as separate lines.
+ *
+ * UnrealEditor-Cmd <Project> -run=DreamLyricBenchmark -unattended -nullrhi
+ *   -Lines=2000          lines per file
+ *   -Words=8             words per line
+ *   -Iterations=5        parses per file, the median is reported
+ *   -Formats=LRC,SRT,ASS file types to run
+ *   -LineTypes=All       All, or a comma separated list of line type names (Lyric_Only, ...)
+ *   -Csv=<path>          write the results as CSV
+ *   -Baseline=<path>     compare against a CSV written by -Csv, fails when a case is slower than the tolerance
+ *   -Tolerance=0.15      allowed lines/sec regression against the baseline
+ */
+UCLASS()
+class DREAMMUSICPLAYEREDITOR_API UDreamLyricBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDreamLyricBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DreamLyricLintCommandlet.generated.h"
+
+/**
+ * @brief Validates every lyric file of the project and writes a JSON report
+ *
+ * Lyric files come from the lyric expansion data of every UDreamMusicData asset (parsed with the asset's settings)
+ * and from every lyric file under LyricContentPath that no asset references (parsed with the expansion data defaults).
+ * Files are parsed and validated in parallel through FDreamLyricBatchParser, then every track is checked for
+ * ordering errors, overlapping lines and empty lines. Lines out of order in the source file are reported by the
+ * parser before it sorts the track.
+ *
+ * UnrealEditor-Cmd <Project> -run=DreamLyricLint -unattended -nullrhi
+ *   -Report=<path>          JSON report, defaults to Saved/DreamMusicPlayer/LyricLint.json
+ *   -MaxIssuesPerFile=100   issues listed per file, counts are always complete
+ *   -UseCache               allow the binary lyric cache, parse times then include cache hits and
+ *                           source order is not checked for cached files
+ *   -WarningsAsErrors       overlaps and empty lines fail the run as well
+ *
+ * Returns 1 when any file has an error.
+ */
+UCLASS()
+class DREAMMUSICPLAYEREDITOR_API UDreamLyricLintCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDreamLyricLintCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -6,6 +6,8 @@
 #include "Effect/DreamLyricScaleEffect.h"
 #include "Effect/DreamLyricBlurEffect.h"
 #include "Effect/DreamLyricGlowEffect.h"
+#include "Expansion/DreamMusicPlayerExpansion_Lyric.h"
+#include "LyricParser/DreamLyricTrack.h"
 
 #define LOCTEXT_NAMESPACE "DreamLyricTextBlock"
 
@@ -113,6 +115,24 @@ void UDreamLyricTextBlock::SetLyricText(FText InText)
 	}
 }
 
+void UDreamLyricTextBlock::SetLyricLine(const UDreamMusicPlayerExpansion_Lyric* LyricExpansion, int32 LineIndex, bool bUseRoma)
+{
+	const TSharedPtr<const FDreamLyricTrack> Track = LyricExpansion ? LyricExpansion->GetLyricTrack() : nullptr;
+	if (!Track.IsValid() || !Track->IsValidLine(LineIndex))
+	{
+		SetLyricText(FText::GetEmpty());
+		return;
+	}
+
+	const EDreamLyricWordChannel Channel = bUseRoma ? EDreamLyricWordChannel::Romanization : EDreamLyricWordChannel::Lyric;
+	Text = FText::FromStringView(bUseRoma ? Track->GetLineRomanization(LineIndex) : Track->GetLineContent(LineIndex));
+
+	if (MyLyricBlock.IsValid())
+	{
+		MyLyricBlock->SetText(Text, Track->GetLineGraphemeEnds(Channel, LineIndex), Track->GetLineWordBreakEnds(Channel, LineIndex));
+	}
+}
+
 void UDreamLyricTextBlock::SetDisplayMode(EDreamLyricDisplayMode InMode)
 {
 	DisplayMode = InMode;
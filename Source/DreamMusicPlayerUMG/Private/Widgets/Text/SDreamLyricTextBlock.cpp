@@ -7,6 +7,7 @@
 #include "Effect/DreamLyricScaleEffect.h"
 #include "Effect/DreamLyricBlurEffect.h"
 #include "Effect/DreamLyricGlowEffect.h"
+#include "LyricParser/DreamLyricTextSegmenter.h"
 
 BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
@@ -136,6 +137,27 @@ void SDreamLyricTextBlock::SetText(const FText& InText)
 	Invalidate(EInvalidateWidgetReason::Layout);
 }
 
+void SDreamLyricTextBlock::SetText(const FText& InText, TConstArrayView<int32> InGraphemeEnds, TConstArrayView<int32> InWordBreakEnds)
+{
+	SegmentedText = InText.ToString();
+
+	const int32 TextLength = SegmentedText.Len();
+	const bool bValidSegments = !InGraphemeEnds.IsEmpty() && InGraphemeEnds.Last() == TextLength
+		&& !InWordBreakEnds.IsEmpty() && InWordBreakEnds.Last() == TextLength;
+
+	if (bValidSegments)
+	{
+		GraphemeEnds = InGraphemeEnds;
+		WordBreakEnds = InWordBreakEnds;
+	}
+	else
+	{
+		SegmentedText.Reset();
+	}
+
+	SetText(InText);
+}
+
 void SDreamLyricTextBlock::SetDisplayMode(EDreamLyricDisplayMode InMode)
 {
 	if (DisplayMode != InMode)
@@ -166,6 +188,11 @@ void SDreamLyricTextBlock::RebuildLayout() const
 	const FSlateFontInfo& CurrentFont = Font.Get();
 	const float MaxWidth = WrapWidth.Get();
 
+	if (DisplayMode != EDreamLyricDisplayMode::Line)
+	{
+		UpdateSegments(TextString);
+	}
+
 	TSharedRef<FSlateFontMeasure> FontMeasure =
 		FSlateApplication::Get().GetRenderer()->GetFontMeasureService();
 
@@ -188,6 +215,23 @@ void SDreamLyricTextBlock::RebuildLayout() const
 	bNeedsRebuild = false;
 }
 
+void SDreamLyricTextBlock::UpdateSegments(const FString& TextString) const
+{
+	if (SegmentedText.Equals(TextString, ESearchCase::CaseSensitive) && !GraphemeEnds.IsEmpty())
+	{
+		return;
+	}
+
+	// 只在文本变化时运行, 迭代器随函数释放, 不会比 ICU 活得更久
+	FDreamLyricTextSegmenter Segmenter;
+
+	GraphemeEnds.Reset();
+	WordBreakEnds.Reset();
+	Segmenter.AppendGraphemeEnds(TextString, GraphemeEnds);
+	Segmenter.AppendWordBreakEnds(TextString, WordBreakEnds);
+	SegmentedText = TextString;
+}
+
 void SDreamLyricTextBlock::BuildCharacterLayout(
 	const FString& TextString,
 	const FSlateFontInfo& CurrentFont,
@@ -203,11 +247,15 @@ void SDreamLyricTextBlock::BuildCharacterLayout(
 	int32 GlobalIndex = 0;
 	int32 LineIndex = 0;
 
-	for (int32 i = 0; i < TextString.Len(); ++i)
+	// 按字素簇切分, 代理对, emoji 与组合字符作为一个单元
+	int32 GraphemeBegin = 0;
+	for (const int32 GraphemeEnd : GraphemeEnds)
 	{
-		TCHAR Char = TextString[i];
+		const TCHAR Char = TextString[GraphemeBegin];
+		FString CharStr = TextString.Mid(GraphemeBegin, GraphemeEnd - GraphemeBegin);
+		GraphemeBegin = GraphemeEnd;
 
-		if (Char == '\n')
+		if (Char == '\n' || Char == '\r')
 		{
 			MaxLineWidth = FMath::Max(MaxLineWidth, CurrentX);
 			CurrentX = 0.0f;
@@ -217,7 +265,6 @@ void SDreamLyricTextBlock::BuildCharacterLayout(
 			continue;
 		}
 
-		FString CharStr = TextString.Mid(i, 1);
 		FVector2D CharSize = FontMeasure->Measure(FText::FromString(CharStr), CurrentFont);
 
 		if (CurrentX + CharSize.X > MaxWidth && CurrentX > 0.0f)
@@ -229,12 +276,12 @@ void SDreamLyricTextBlock::BuildCharacterLayout(
 		}
 
 		FDreamLyricDisplayUnit Unit;
-		Unit.Content = CharStr;
+		Unit.Content = MoveTemp(CharStr);
 		Unit.Position = FVector2D(CurrentX, CurrentY);
 		Unit.Size = CharSize;
 		Unit.GlobalIndex = GlobalIndex;
 		Unit.LineIndex = LineIndex;
-		Unit.bIsSpace = (Char == ' ');
+		Unit.bIsSpace = FChar::IsWhitespace(Char);
 
 		DisplayUnits.Add(Unit);
 
@@ -257,37 +304,43 @@ void SDreamLyricTextBlock::BuildWordLayout(
 
 	TArray<FString> Words;
 	TArray<bool> IsNewLine;
-	FString CurrentWord;
 
-	for (int32 i = 0; i < TextString.Len(); ++i)
+	// 按 ICU 分词片段切分, CJK 文本没有空格也能按词换行
+	int32 SegmentBegin = 0;
+	for (const int32 SegmentEnd : WordBreakEnds)
 	{
-		TCHAR Char = TextString[i];
+		const FStringView Segment = FStringView(TextString).Mid(SegmentBegin, SegmentEnd - SegmentBegin);
+		SegmentBegin = SegmentEnd;
 
-		if (Char == ' ' || Char == '\n')
+		bool bIsWhitespace = true;
+		for (const TCHAR Char : Segment)
 		{
-			if (!CurrentWord.IsEmpty())
+			bIsWhitespace &= FChar::IsWhitespace(Char);
+		}
+
+		if (!bIsWhitespace)
+		{
+			Words.Add(FString(Segment));
+			IsNewLine.Add(false);
+			continue;
+		}
+
+		// 空白片段: 空格逐个保留为单元, 换行标记在前一个词上
+		for (const TCHAR Char : Segment)
+		{
+			if (Char == '\n')
 			{
-				Words.Add(CurrentWord);
-				IsNewLine.Add(Char == '\n');
-				CurrentWord.Empty();
+				if (!IsNewLine.IsEmpty())
+				{
+					IsNewLine.Last() = true;
+				}
 			}
-
-			if (Char == ' ')
+			else if (Char == ' ')
 			{
 				Words.Add(TEXT(" "));
 				IsNewLine.Add(false);
 			}
 		}
-		else
-		{
-			CurrentWord.AppendChar(Char);
-		}
-	}
-
-	if (!CurrentWord.IsEmpty())
-	{
-		Words.Add(CurrentWord);
-		IsNewLine.Add(false);
 	}
 
 	float CurrentX = 0.0f;
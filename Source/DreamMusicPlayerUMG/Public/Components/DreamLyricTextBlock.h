@@ -14,6 +14,7 @@ class FDreamLyricColorEffect;
 class FDreamLyricScaleEffect;
 class FDreamLyricBlurEffect;
 class FDreamLyricGlowEffect;
+class UDreamMusicPlayerExpansion_Lyric;
 
 /**
  * 重构版 UMG 歌词控件 - 支持模块化效果系统
@@ -133,6 +134,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Lyric")
 	void SetLyricText(FText InText);
 
+	/**
+	 * 显示歌词轨道中的一行, 直接使用轨道加载时计算好的字素簇 / 分词边界, 不再重新分段
+	 * 与 UDreamMusicPlayerExpansion_Lyric::GetCurrentLyricGraphemeProgress 搭配使用时, 逐字符高亮跟随逐字时间
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Lyric")
+	void SetLyricLine(const UDreamMusicPlayerExpansion_Lyric* LyricExpansion, int32 LineIndex, bool bUseRoma = false);
+
 	UFUNCTION(BlueprintCallable, Category = "Lyric")
 	void SetDisplayMode(EDreamLyricDisplayMode InMode);
 
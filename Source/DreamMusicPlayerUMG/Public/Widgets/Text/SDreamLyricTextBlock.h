@@ -63,6 +63,12 @@ public:
 	/** 设置文本 */
 	void SetText(const FText& InText);
 
+	/**
+	 * 设置文本及预先计算的字素簇 / 分词边界 (FDreamLyricTrack::GetLineGraphemeEnds / GetLineWordBreakEnds), 不再重新分段
+	 * 边界与文本不匹配时忽略, 按普通 SetText 处理
+	 */
+	void SetText(const FText& InText, TConstArrayView<int32> InGraphemeEnds, TConstArrayView<int32> InWordBreakEnds);
+
 	/** 设置显示模式 */
 	void SetDisplayMode(EDreamLyricDisplayMode InMode);
 
@@ -74,6 +80,9 @@ private:
 	/** 重建布局 */
 	void RebuildLayout() const;
 
+	/** 文本变化时重新计算字素簇 / 分词边界, 字体与换行宽度变化导致的重建不重新分段 */
+	void UpdateSegments(const FString& TextString) const;
+
 	/** 按字符模式构建布局 */
 	void BuildCharacterLayout(const FString& TextString, const FSlateFontInfo& CurrentFont,
 	                          float MaxWidth, float LineHeight) const;
@@ -121,4 +130,9 @@ private:
 	mutable TArray<FDreamLyricDisplayUnit> DisplayUnits;
 	mutable FVector2D CachedSize;
 	mutable bool bNeedsRebuild;
+
+	// 分段缓存, 与 SegmentedText 对应
+	mutable FString SegmentedText;
+	mutable TArray<int32> GraphemeEnds;
+	mutable TArray<int32> WordBreakEnds;
 };